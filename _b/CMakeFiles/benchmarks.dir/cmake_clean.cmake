@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/benchmarks.dir/bench.c.o"
+  "CMakeFiles/benchmarks.dir/bench.c.o.d"
+  "CMakeFiles/benchmarks.dir/mg.c.o"
+  "CMakeFiles/benchmarks.dir/mg.c.o.d"
+  "benchmarks"
+  "benchmarks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/benchmarks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/unit_tests.dir/mg.c.o"
+  "CMakeFiles/unit_tests.dir/mg.c.o.d"
+  "CMakeFiles/unit_tests.dir/tests.c.o"
+  "CMakeFiles/unit_tests.dir/tests.c.o.d"
+  "unit_tests"
+  "unit_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/unit_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/e2e_tests.dir/tests.c.o"
+  "CMakeFiles/e2e_tests.dir/tests.c.o.d"
+  "e2e_tests"
+  "e2e_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/e2e_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -47,7 +47,7 @@ Include mg.c in your build process, and the rest of this documentation still app
 - `m_Allocator`: Custom memory allocator with function pointers for malloc, realloc, free, and a userdata pointer for context.
 - `m_Buffer`: Generic dynamic buffer for raw data, with item size and capacity.
 - `m_List`: Dynamic array built on m_Buffer, with an optional item comparison function.
-- `m_Dict`: Key-value store using two m_Lists—one for keys, one for values.
+- `m_Dict`: Key-value store using two m_Lists—one for keys, one for values. Linear (scanned) or hashed.
 - `m_StrBuffer`: String buffer for efficient manipulation, built on m_Buffer.
 
 ### Enumerations
@@ -115,6 +115,16 @@ A low-level dynamic buffer for raw data.
 ### Custom comparer
 - `I32 (*m_ItemComparer)(Void* item1, Void* item2)`: For list/dict key find/sort functions.
 
+### Custom hasher
+- `U64 (*m_ItemHasher)(Void* item, I32 itemsize, U64 seed)`: For hashed dict keys.
+
+Built-in seeded hashers (wyhash). The fixed-width ones produce the same result as `m_hash_bytes` for their size.
+- `U64 m_hash_bytes(Void* item, I32 itemsize, U64 seed)`: Hashes `itemsize` raw key bytes.
+- `U64 m_hash_u32(...)`, `U64 m_hash_u64(...)`, `U64 m_hash_u128(...)`: Specialised hashers for 4, 8 and 16 byte keys.
+- `U64 m_hash_str(Void* item, I32 itemsize, U64 seed)`: Hashes the NUL-terminated string a `Str` key points to.
+- `m_ItemHasher m_hasher_for_size(I32 itemsize)`: Picks the fastest byte hasher for a key size (used when a dict gets a NULL hasher).
+- `I32 m_compare_str(Void* item1, Void* item2)`: Comparer for `Str` keys (strcmp on the pointed-to strings).
+
 ### List (m_List)
 A dynamic array with flexible operations.
 
@@ -122,6 +132,11 @@ A dynamic array with flexible operations.
 - `ml_destroy(m_List* list)`: Frees the list.
 - `ml_init(m_List* list, I32 itemsize, I32 itemcap, m_ItemComparer comparer)`: Initializes an existing list.
 - `ml_push(m_List* list, Void* item)`: Appends an item.
+- `ml_push_many(m_List* list, Void* items, I32 n)`: Appends `n` packed items, growing at most once, with one `memcpy`.
+- `Void* ml_emplace(m_List* list)`: Appends one slot and returns it, so the item can be built in place. Returns NULL on allocation failure.
+- `Void* ml_extend_uninit(m_List* list, I32 n)`: Appends `n` slots and returns the first. The slots are not cleared: they hold zeroes after growth, or stale items after pops and removes.
+- `ml_reserve(m_List* list, I32 n)`: Makes room for `n` more items. The capacity grows by the list's growth factor, or to exactly what was asked if that is larger.
+- `ml_setgrowth(m_List* list, I32 percent)`: Sets the capacity after each growth, as a percentage of the old capacity. The default (0) is 200, which doubles; the value must be above 100.
 - `Void* ml_pop(m_List* list)`: Removes and returns the last item.
 - `I32 ml_count(m_List* list)`: Returns the number of items.
 - `Void* ml_get(m_List* list, I32 index)`: Retrieves an item by index.
@@ -129,14 +144,58 @@ A dynamic array with flexible operations.
 - `ml_remove(m_List* list, I32 index)`: Removes an item at an index.
 - `ml_remove_range(m_List* list, I32 startindex, I32 count)`: Removes a range of items.
 - `ml_remove_swap(m_List* list, I32 index)`: Removes an item by swapping with the last (faster, unordered).
-- `I32 ml_find(m_List* list, Void* item)`: Returns the index of an item (or -1 if not found).
+- `I32 ml_find(m_List* list, Void* item)`: Returns the index of an item (or -1 if not found). Lists created with a NULL comparer match item bytes, 32 items per SIMD block for 4- and 8-byte items (AVX2 when the CPU supports it, else SSE2).
+- `I32 ml_find_bytes(m_List* list, Void* item)`: Like `ml_find`, but always matches item bytes and never calls the comparer.
+- `ml_find_all(m_List* list, Void* item, m_List* indexes)`: Appends the index of every matching item to `indexes`, a list of `I32`.
+- `I32 ml_count_eq(m_List* list, Void* item)`: Returns the number of matching items.
 - `ml_clear(m_List* list)`: Removes all items.
 - `ml_sort(m_List* list)`: Sorts the list using the provided comparer.
+- `ml_sort_pdq(m_List* list)`: Sorts with pattern-defeating quicksort, which is O(n log n) in the worst case and linear on sorted or reversed input. Items of 4, 8, 12, 16, 24 or 32 bytes are moved as whole words; other sizes are argsorted and moved once. Not stable. Does nothing on a list created without a comparer.
+- `ml_sort_radix(m_List* list, I32 keyoffset, m_RadixKey keytype)`: Stable LSD radix sort on a numeric key at byte `keyoffset` of each item. `keytype` is one of `M_RADIX_U32`, `I32`, `F32`, `U64`, `I64` or `F64`. A digit that every key shares is skipped, so timestamps only pay for the bytes that vary. Needs 24 bytes of scratch per item.
+- `ml_argsort(m_List* list, I32* order)`: Fills `order` with item indexes in ascending comparer order. Equal items keep their original order. Returns `M_ERR_INVALID_OPERATION` for a list created without a comparer.
+- `ml_apply_permutation(m_List* list, I32* order)`: Rearranges the items so item `order[i]` moves to position `i`, for example to apply one argsort to several parallel lists.
+- `ml_sort_parallel(m_List* list, I32 nthreads, Bool stable)`: Sorts `nthreads` chunks on their own threads (0 means one per online CPU), then merges them in rounds split evenly across the threads with merge path. Stable when `stable` is true, which argsorts the chunks instead of using pdqsort. Uses one copy of the list from its allocator as scratch. Lists under 32K items sort on the calling thread. Returns `M_ERR_INVALID_OPERATION` for a list created without a comparer. Not available with `M_DISABLE_THREADS`.
+
+`M_SORT_DEFINE(T, name, less)` generates `static Void name(T* items, I32 n, Void* context)`, the same pdqsort with
+`less(T* a, T* b, Void* context)` expanded inline instead of called through a pointer:
+
+```c
+#define by_time(a, b, context) ((a)->time < (b)->time)
+M_SORT_DEFINE(Row, sort_rows, by_time)
+
+sort_rows((Row*)rows->buffer.data, ml_count(rows), NULL);
+```
+
+#### Typed lists
+`M_LIST_DEFINE(T, Name)` declares a list of `T` whose accessors are `static inline`. The item size is a compile-time
+constant, so pushes and reads become plain typed stores and loads instead of `itemsize` arithmetic and a `memcpy`.
+`Name` wraps an m_List as its only member, so `&l->list` works with every `ml_` function. By default items are
+compared bytewise and the list gets a NULL comparer, so `ml_find` uses the SIMD byte search. `M_LIST_DEFINE_CMP(T,
+Name, cmp)` takes a function or macro `cmp(T* a, T* b)` that returns 0 for equal items. It is expanded inside
+`Name_find` and is also installed as the runtime comparer for `ml_find`. `ml_sort` and the other ordering functions
+need a list from `M_LIST_DEFINE_CMP` whose `cmp` returns a sign like `int_comparer` does.
+
+- `Name_create(I32 itemcap)`, `Name_init(Name* l, I32 itemcap)`, `Name_destroy(Name* l)`: As the `ml_` versions.
+- `IErr Name_push(Name* l, T item)`: Appends an item.
+- `T* Name_get(Name* l, I32 index)`: Returns a pointer to an item, or NULL when out of range.
+- `T Name_at(Name* l, I32 index)`: Returns an item. The index is only checked by `m_assert`.
+- `IErr Name_put(Name* l, I32 index, T item)`: Replaces an item.
+- `I32 Name_find(Name* l, T item)`: Returns the index of the first equal item, or -1.
+- `I32 Name_count(Name* l)`, `T* Name_items(Name* l)`: Returns the item count, or the items as a C array.
+
+```c
+M_LIST_DEFINE(I32, IntList)
+
+IntList* ids = IntList_create(0);
+IntList_push(ids, 42);
+I32 first = IntList_at(ids, 0);
+ml_remove_swap(&ids->list, 0);
+```
 
 ### Dictionary (m_Dict)
 A key-value store implemented with two lists.
 
-- `m_Dict md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer)`: Creates a dictionary.
+- `m_Dict md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer)`: Creates a dictionary. A NULL comparer compares key bytes, which `ml_find` does with SIMD for 4- and 8-byte keys.
 - `md_destroy(m_Dict* dict)`: Frees the dictionary.
 - `md_init(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer)`: Initializes an existing dictionary.
 - `Void* md_get(m_Dict* dict, Void* key)`: Retrieves a value by key (NULL if not found).
@@ -145,6 +204,330 @@ A key-value store implemented with two lists.
 - `md_remove(m_Dict* dict, Void* key)`: Removes a key-value pair (unordered).
 - `md_remove_ordered(m_Dict* dict, Void* key)`: Removes a key-value pair while preserving order.
 - `md_clear(m_Dict* dict)`: Removes all entries.
+- `md_setseed(m_Dict* dict, U64 seed)`: Sets the seed passed to the hasher (rehashes existing entries).
+- `Bool md_iter(m_Dict* dict, I32* pos, Void** key, Void** value)`: Visits the next entry, starting from `pos = 0` (false when done).
+
+Batched forms take `n` packed keys (an array of CStr in string mode) and suit lookups made a chunk of records at a
+time. Hashed modes hash a chunk of keys first and prefetch their slots so the cache misses overlap. A linear dict
+sorts the batch with its comparer, or by key bytes when it was created without one, and scans `keys` once, so its
+comparer must order keys, not just test equality.
+
+- `I32 md_get_many(m_Dict* dict, Void* keys, Void** values, I32 n)`: Stores a value pointer (or NULL) per key in `values`; returns the number found.
+- `I32 md_has_many(m_Dict* dict, Void* keys, Bool* found, I32 n)`: Stores a flag per key in `found` (may be NULL); returns the number found.
+- `md_put_many(m_Dict* dict, Void* keys, Void* values, I32 n)`: Adds or updates n pairs; later duplicates win.
+- `md_remove_many(m_Dict* dict, Void* keys, I32 n)`: Removes every listed key.
+
+#### Hashed dictionary
+The default dict finds keys by scanning `keys` with the comparer, which is O(n) per lookup.
+A hashed dict keeps the same md_* API but stores entries in an open-addressing table (linear probing,
+power of two slot count, grows at 75% load) so lookups are O(1) on average.
+In this mode `keys` and `values` are slot arrays: `md_count` is still valid, but iterate with `md_iter`.
+
+- `m_Dict md_create_hashed(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a hashed dictionary. A NULL hasher picks one by key size, a NULL comparer compares key bytes.
+- `md_init_hashed(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing hashed dictionary.
+- `m_Dict md_create_swiss(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a swiss-table dictionary. One control byte per slot holds a 7-bit hash fingerprint, and 16 slots are probed with a single SSE2 compare (scalar fallback) before any key is compared. Best for lookup-heavy tables with many misses.
+- `md_init_swiss(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing swiss-table dictionary.
+- `m_Dict md_create_robinhood(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a Robin Hood dictionary. Inserts displace keys that sit closer to their home slot, and removals shift the following chain back instead of leaving tombstones, so probe lengths stay short and even under heavy insert/remove churn.
+- `md_init_robinhood(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing Robin Hood dictionary.
+- `md_stats(m_Dict* dict, m_DictStats* stats)`: Fills in the entry, slot and tombstone counts plus mean/max probe length and a probe length histogram (`probehist[i]` counts keys found after i + 1 probes).
+
+```c
+m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(F32), 0, NULL, NULL);
+I32 key = 42;
+F32 value = 1.5f;
+md_put(dict, &key, &value);
+F32* found = (F32*)md_get(dict, &key);
+```
+
+##### Incremental resizing
+Growing a hashed, swiss or Robin Hood dict normally rehashes every entry inside the `md_put` that crossed the
+load limit, a stall of many milliseconds on tables with millions of entries. With a rehash budget the old table
+stays alive next to the new one: each following `md_put` or `md_remove` first zeroes a slice of the new slot
+array and then moves up to `budget` old slots, while lookups check both tables. Until the new array is cleared,
+inserts still go to the old table. The drained old arrays are released with one allocator call. Lookups
+(`md_get`, `md_has`, the batched forms and `md_iter`) never move entries, so pointers they return stay valid until
+the next write or `md_rehash_step`, as without a budget. Read-only phases can call `md_rehash_step` to keep
+draining.
+
+- `md_setrehashbudget(m_Dict* dict, I32 budget)`: Old slots migrated per write (at least 16; 0 restores one-shot resizing and finishes a pending resize). Returns `M_ERR_INVALID_OPERATION` for other modes.
+- `Bool md_rehash_step(m_Dict* dict, I32 slots)`: Migrates up to `slots` more old slots, e.g. from an idle loop; returns whether a resize is still in progress.
+
+#### Compact dictionary
+Keeps `keys` and `values` as dense lists in insertion order, exactly like the default dict, and adds a sparse
+power of two array of I32 positions into them (linear probing), as CPython's dict does. Lookups are O(1) and
+iterating the dense lists stays a straight walk in insertion order. `md_remove` swaps the last entry into the hole
+and patches its one index slot; `md_remove_ordered` keeps the order and fixes the index in a single pass without
+rehashing.
+
+- `m_Dict md_create_compact(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a compact dictionary.
+- `md_init_compact(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing compact dictionary.
+
+#### String dictionary
+A swiss-table dictionary keyed by C strings. `md_put` copies each new key into one contiguous arena owned by
+the dict, next to its cached hash and length, so lookups compare hash, then length, then bytes. The caller keeps
+no key memory alive. In this mode the `key` argument of the md_* functions is the string itself (not a pointer to it),
+and `md_iter` returns the stored key string. Arena space of removed keys is reclaimed when the arena next grows.
+
+- `m_Dict md_create_str(I32 valuesize, I32 itemcap)`: Creates a string-keyed dictionary.
+- `md_init_str(m_Dict* dict, I32 valuesize, I32 itemcap)`: Initializes an existing string-keyed dictionary.
+
+```c
+m_Dict* headers = md_create_str(sizeof(I32), 0);
+I32 length = 42;
+md_put(headers, "content-length", &length);
+I32* found = (I32*)md_get(headers, "content-length");
+```
+
+#### Sorted dictionary
+Keeps `keys` sorted by the comparer (bytewise when NULL), so lookups binary search in O(log n) and
+the dense lists iterate in key order. Inserts shift entries, so load write-once tables with `md_build_sorted`.
+`md_remove` preserves the order in this mode.
+
+- `m_Dict md_create_sorted(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer)`: Creates a sorted dictionary.
+- `md_init_sorted(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer)`: Initializes an existing sorted dictionary.
+- `md_build_sorted(m_Dict* dict, Void* keys, Void* values, I32 n)`: Adds n key/value pairs from two packed arrays with one sort and one merge. Later duplicates win. Other modes fall back to `md_put`.
+- `I32 md_lower_bound(m_Dict* dict, Void* key)`: Index of the first key not less than `key` (-1 if the dict is not sorted).
+- `I32 md_upper_bound(m_Dict* dict, Void* key)`: Index of the first key greater than `key` (-1 if the dict is not sorted).
+
+### Set (m_Set)
+A hash set of fixed-size keys. It is a swiss table with a zero value size, so it allocates and moves no value array
+and a slot costs only its key plus one control byte. The set algebra works in place on the first set in linear passes:
+union inserts the other set's keys after one presize, intersect walks the slots once, and difference probes from
+whichever side is smaller.
+
+- `m_Set* mset_create(I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a set (NULL hasher/comparer for the defaults).
+- `mset_destroy(m_Set* set)`: Frees the set.
+- `mset_init(m_Set* set, I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing set.
+- `mset_clear(m_Set* set)`: Removes all keys.
+- `mset_add(m_Set* set, Void* key)`: Adds a key if it is not present.
+- `Bool mset_has(m_Set* set, Void* key)`: Checks if a key exists.
+- `mset_remove(m_Set* set, Void* key)`: Removes a key.
+- `I32 mset_count(m_Set* set)`: Returns the number of keys.
+- `Bool mset_iter(m_Set* set, I32* pos, Void** key)`: Visits the next key, starting from `pos = 0`.
+- `mset_union(m_Set* set, m_Set* other)`: Adds every key of `other` to `set`.
+- `mset_intersect(m_Set* set, m_Set* other)`: Keeps only the keys of `set` that are also in `other`.
+- `mset_difference(m_Set* set, m_Set* other)`: Removes the keys of `other` from `set`.
+
+### Cache (m_Cache)
+A fixed-capacity cache with O(1) get and put. Keys, values and the per-policy bookkeeping live in buffers sized at
+init. A Robin Hood dict, whose deletes leave no tombstones, maps keys to entries. A full cache reuses the victim's
+entry in place, so the steady state never allocates. Policies:
+
+- `M_CACHE_LRU`: Evicts the least recently used entry. A hit relinks the entry at the head of a list.
+- `M_CACHE_CLOCK`: A hand sweeps the entries as a ring and spares, once, each entry hit since its last visit. A hit only sets a bit.
+- `M_CACHE_SIEVE`: Like CLOCK, but the hand sweeps from the oldest insert toward the newest, and spared entries keep their place. This resists one-off scans better than LRU.
+
+The evictor callback receives every key and value the cache drops: capacity evictions, values replaced by a put,
+removals, and the remaining entries on clear and destroy. `hits`, `misses` and `evictions` count `mcache_get`
+outcomes and capacity evictions.
+
+- `m_Cache* mcache_create(I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a cache holding up to `cap` entries (NULL hasher/comparer for the defaults).
+- `mcache_destroy(m_Cache* cache)`: Hands the remaining entries to the evictor and frees the cache.
+- `mcache_init(m_Cache* cache, I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing cache.
+- `mcache_setevictor(m_Cache* cache, m_CacheEvictor evictor, Void* context)`: Sets the callback `evictor(key, value, context)`.
+- `mcache_clear(m_Cache* cache)`: Hands every entry to the evictor and empties the cache.
+- `Void* mcache_get(m_Cache* cache, Void* key)`: Retrieves a value and marks it used (NULL on a miss).
+- `mcache_put(m_Cache* cache, Void* key, Void* value)`: Adds or replaces a value, evicting one entry when full.
+- `Bool mcache_has(m_Cache* cache, Void* key)`: Checks for a key without touching it or the counters.
+- `mcache_remove(m_Cache* cache, Void* key)`: Removes an entry.
+- `I32 mcache_count(m_Cache* cache)`: Returns the number of entries.
+
+### Filter (m_Filter)
+An approximate membership filter to put in front of a large dict or an on-disk table, so most misses are answered
+without touching it. A test never misses an added key, and it reports a key that was never added only at about the
+false positive rate. Two modes:
+
+- `M_FILTER_BLOOM`: A split block Bloom filter. A key selects one 32-byte block and sets one bit in each of its eight words. A test reads one cache line and checks the block against the mask with two SSE2 compares. Sized from `fpr`, it takes about 12 bits per key at 1%. Keys cannot be removed.
+- `M_FILTER_CUCKOO`: A cuckoo filter. A key keeps a 16-bit fingerprint in one of two buckets of four lanes, which are matched together as one 64-bit word. Its false positive rate is about 0.01% whatever `fpr` asks for. It supports removal. Only remove keys that were added, since removing an absent key can clear a colliding fingerprint.
+
+- `m_Filter* mfilter_create(m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher)`: Creates a filter sized for `itemcap` keys at false positive rate `fpr` (NULL hasher for the default).
+- `mfilter_destroy(m_Filter* filter)`: Frees the filter.
+- `mfilter_init(m_Filter* filter, m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher)`: Initializes an existing filter.
+- `mfilter_clear(m_Filter* filter)`: Removes all keys.
+- `mfilter_add(m_Filter* filter, Void* key)`: Adds a key. A cuckoo filter returns `M_ERR_OUT_OF_BOUNDS` once it is full.
+- `Bool mfilter_test(m_Filter* filter, Void* key)`: Returns false if the key was certainly never added.
+- `mfilter_remove(m_Filter* filter, Void* key)`: Removes a key from a cuckoo filter (`M_ERR_INVALID_OPERATION` for Bloom).
+- `mfilter_save(m_Filter* filter, m_Buffer* out)`: Resizes an initialized buffer to hold a header and the filter's blocks.
+- `mfilter_load(m_Filter* filter, Void* data, Sz size, m_ItemHasher hasher)`: Initializes a filter from a saved image, copying its blocks. Release it with `mb_setcap(&filter->blocks, 0)`, or with `mfilter_destroy` if it was heap allocated.
+
+### B-Tree (m_BTree)
+An ordered map for sorted iteration, bounds and range deletes. It is a B+ tree: entries live in leaves linked left to
+right, and inner nodes hold only separators. Each node's keys span `M_BTREE_NODE_BYTES` (four cache lines, at least 4
+keys), so a lookup binary searches a few lines per level. Nodes come from the library allocator. Inserts and removes
+are O(log n). A range delete frees whole subtrees inside the range and only rebalances along its two edges. Cursors
+are invalidated by any change to the tree.
+
+- `m_BTree* mbt_create(I32 keysize, I32 valuesize, m_ItemComparer comparer)`: Creates a tree ordered by `comparer`, which is required.
+- `mbt_destroy(m_BTree* tree)`: Frees the tree and all nodes.
+- `mbt_init(m_BTree* tree, I32 keysize, I32 valuesize, m_ItemComparer comparer)`: Initializes an existing tree.
+- `mbt_clear(m_BTree* tree)`: Removes all entries.
+- `mbt_load(m_BTree* tree, m_List* keys, m_List* values)`: Replaces the contents with strictly ascending `keys` and matching `values` (NULL for zeroed values). Nodes are filled evenly from the bottom up. Unsorted keys return `M_ERR_INVALID_OPERATION`.
+- `Void* mbt_get(m_BTree* tree, Void* key)`: Retrieves a value by key (NULL if not found).
+- `mbt_put(m_BTree* tree, Void* key, Void* value)`: Adds or updates an entry.
+- `Bool mbt_has(m_BTree* tree, Void* key)`: Checks if a key exists.
+- `mbt_remove(m_BTree* tree, Void* key)`: Removes an entry.
+- `I32 mbt_remove_range(m_BTree* tree, Void* lo, Void* hi)`: Removes the keys in `[lo, hi)` and returns how many. A NULL bound is open.
+- `I32 mbt_count(m_BTree* tree)`: Returns the number of entries.
+- `m_BTreeCursor mbt_lower_bound(m_BTree* tree, Void* key)`: Returns a cursor at the first key not below `key` (NULL for the first entry).
+- `m_BTreeCursor mbt_upper_bound(m_BTree* tree, Void* key)`: Returns a cursor at the first key above `key`.
+- `m_BTreeCursor mbt_range(m_BTree* tree, Void* lo, Void* hi)`: Returns a cursor over `[lo, hi)`. The bounds are kept by pointer.
+- `Bool mbt_next(m_BTreeCursor* cursor, Void** key, Void** value)`: Visits the next entry in ascending order.
+
+```c
+m_BTreeCursor cursor = mbt_range(tree, &lo, &hi);
+Void* key;
+Void* value;
+while (mbt_next(&cursor, &key, &value)) {
+    // ...
+}
+```
+
+### Adaptive Radix Tree (m_Art)
+An index over byte-string keys for exact lookup, prefix queries and longest-prefix match, such as URL routes or IP
+prefixes. Inner nodes have room for 4, 16, 48 or 256 children and change size as children come and go. Node16 finds
+a byte with one SSE2 compare. Runs without branches are folded into a node's prefix, with the first 12 bytes stored
+inline. A key may be a prefix of another key. Keys and values are copied into the leaves. Iteration is in byte order,
+so integer keys written big-endian with `mart_key_u64` iterate numerically.
+
+- `m_Art* mart_create(I32 valuesize)`: Creates an empty tree.
+- `mart_destroy(m_Art* art)`: Frees the tree and all leaves.
+- `mart_init(m_Art* art, I32 valuesize)`: Initializes an existing tree.
+- `mart_clear(m_Art* art)`: Removes all keys.
+- `Void* mart_get(m_Art* art, Void* key, I32 keylen)`: Retrieves a value by key (NULL if not found).
+- `mart_put(m_Art* art, Void* key, I32 keylen, Void* value)`: Adds or updates a key.
+- `Bool mart_has(m_Art* art, Void* key, I32 keylen)`: Checks if a key exists.
+- `mart_remove(m_Art* art, Void* key, I32 keylen)`: Removes a key.
+- `I32 mart_count(m_Art* art)`: Returns the number of keys.
+- `Void* mart_longest_prefix(m_Art* art, Void* key, I32 keylen, I32* matchlen)`: Returns the value of the longest stored key that is a prefix of `key`, and its length in `matchlen` (NULL and 0 if none).
+- `I32 mart_iter_prefix(m_Art* art, Void* prefix, I32 prefixlen, m_ArtVisitor visitor, Void* context)`: Calls `visitor(key, keylen, value, context)` on every key starting with `prefix`, in order, until it returns false. Returns the number of visits. Use `prefixlen = 0` to visit all keys.
+- `mart_key_u64(U64 value, U8* out)`: Writes `value` as 8 big-endian bytes.
+
+```c
+I32 matched;
+Route* route = (Route*)mart_longest_prefix(routes, path, (I32)strlen(path), &matched);
+```
+
+### Small Dictionary (m_SmallDict)
+A dictionary for the common case of a handful of entries, such as per-request attributes. Up to 16 keys and values
+(128 bytes of each) live inline in the struct, so one declared on the stack or inside another struct allocates
+nothing. With no comparer, 4- and 8-byte keys are matched against all inline keys with SSE2 compares instead of a
+comparer call per key. The first insert that does not fit moves everything into a swiss dict, after which every call
+forwards to it.
+
+- `m_SmallDict* msd_create(I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a small dictionary on the heap. The hasher and comparer are used after a spill (NULL for the defaults).
+- `msd_destroy(m_SmallDict* dict)`: Frees the dictionary and its spilled table.
+- `msd_init(m_SmallDict* dict, I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer)`: Initializes an existing small dictionary without allocating.
+- `msd_clear(m_SmallDict* dict)`: Removes all entries and frees a spilled table; call it before an initialized dict goes out of scope.
+- `Void* msd_get(m_SmallDict* dict, Void* key)`: Retrieves a value by key (NULL if not found).
+- `msd_put(m_SmallDict* dict, Void* key, Void* value)`: Adds or updates a key-value pair.
+- `Bool msd_has(m_SmallDict* dict, Void* key)`: Checks if a key exists.
+- `msd_remove(m_SmallDict* dict, Void* key)`: Removes a key-value pair (unordered).
+- `I32 msd_count(m_SmallDict* dict)`: Returns the number of entries.
+- `Bool msd_iter(m_SmallDict* dict, I32* pos, Void** key, Void** value)`: Visits the next entry, starting from `pos = 0`.
+
+```c
+m_SmallDict attrs;
+msd_init(&attrs, sizeof(U32), sizeof(I32), NULL, NULL);
+U32 id = 7;
+I32 level = 3;
+msd_put(&attrs, &id, &level);
+msd_clear(&attrs);
+```
+
+### Frozen Dictionary (m_FrozenDict)
+An immutable snapshot of an m_Dict for lookup tables that never change after startup. `md_freeze` builds a minimal
+perfect hash (CHD style, hash and displace): keys and values are packed into arrays exactly `count` entries long and a
+small displacement table, about one U32 per four keys, sends every key to its own slot. A lookup is one hash, one
+probe and one key compare, hit or miss. Everything lives in one position independent blob (`data`, `size`) that can be
+written to disk and handed back to `mf_load`, for example from a mapped file. String-keyed dicts cannot be frozen.
+
+- `m_FrozenDict* md_freeze(m_Dict* dict)`: Builds a frozen copy of a fixed-key dict; the source is left untouched. Hashed modes keep their hasher. List-backed and sorted dicts have none, so they are hashed by key bytes when their comparer is NULL and with `m_hash_str` when it is `m_compare_str`. Returns NULL for any other comparer without a hasher, for string dicts and on allocation failure.
+- `m_FrozenDict* mf_load(Void* data, Sz size, m_ItemHasher hasher, m_ItemComparer comparer)`: Wraps an existing blob without copying it after checking its header. Pass the hasher the dict was frozen with (NULL selects `m_hasher_for_size`, `m_hash_str` goes with `m_compare_str`) and the key comparer (NULL for bytewise). The blob must be 8-byte aligned and outlive the frozen dict.
+- `mf_destroy(m_FrozenDict* frozen)`: Frees the frozen dict and, unless it came from `mf_load`, its blob.
+- `Void* mf_get(m_FrozenDict* frozen, Void* key)`: Returns a pointer to the value for `key`, or NULL.
+- `Bool mf_has(m_FrozenDict* frozen, Void* key)`: Checks if a key exists.
+- `I32 mf_count(m_FrozenDict* frozen)`: Returns the number of entries.
+
+```c
+m_FrozenDict* frozen = md_freeze(dict);
+fwrite(frozen->data, 1, frozen->size, file);
+// later, with the file mapped at `base`
+m_FrozenDict* table = mf_load(base, length, NULL, NULL);
+```
+
+#### Mapped files
+`ml_save` and `md_save` write a list or dict to a versioned binary file, and `ml_map` and `md_map` map it back
+read-only. Cold start is then an O(1) `mmap` instead of parsing text and calling `md_put` for every entry. A file
+has a header padded to 64 bytes (magic, version, byte order, item size, count, payload offset and size, a payload checksum and a
+header checksum), then the payload at a 64-byte aligned offset. List payloads are the packed items. Dict payloads are
+the frozen blob of `md_freeze`, so a mapped dict is an m_FrozenDict served straight from the page cache. Files are
+written to `path.tmp` and renamed over `path`, so processes that still map the old file are not disturbed. Without
+`mmap` (or with `M_DISABLE_MMAP` defined) the file is read into memory instead.
+
+- `IErr ml_save(m_List* list, CStr path)`: Writes the list items to `path`.
+- `m_List* ml_map(CStr path, m_ItemComparer comparer, Bool verify)`: Maps a saved list. Reads and searches work as usual; anything that grows the list fails and writes are not allowed. `ml_destroy` unmaps the file. With `verify` the payload checksum is checked, which reads the whole file. Returns NULL for a missing, foreign, truncated or corrupt file.
+- `IErr md_save(m_Dict* dict, CStr path)`: Freezes the dict and writes the blob to `path`. String dicts, dicts keyed by `CStr` pointers with `m_compare_str` and dicts that `md_freeze` rejects return `M_ERR_INVALID_OPERATION`.
+- `m_FrozenDict* md_map(CStr path, m_ItemHasher hasher, m_ItemComparer comparer, Bool verify)`: Maps a saved dict. Pass the same hasher and comparer as `mf_load`; `mf_destroy` unmaps the file.
+
+```c
+md_save(dict, "routes.mg");
+// at the next start
+m_FrozenDict* routes = md_map("routes.mg", NULL, NULL, false);
+```
+
+### Concurrent Dictionary (m_ConcurrentDict)
+A thread-safe dictionary that splits the key space across independently locked swiss-table shards, so threads
+touching different shards never contend. Each shard sits on its own cache lines. Values are copied out under the
+shard lock, because a pointer into a shard could move as soon as the lock is released.
+It is built on unix and Apple targets; define `M_DISABLE_THREADS` to leave it out there too.
+
+- `m_ConcurrentDict* mcd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a concurrent dictionary. `shardcount` is rounded up to a power of two. With `rwlocks` set, each shard uses a reader/writer lock so readers of one shard run in parallel, otherwise a mutex.
+- `mcd_destroy(m_ConcurrentDict* dict)`: Frees the dictionary.
+- `mcd_init(m_ConcurrentDict* dict, ...)`: Initializes an existing concurrent dictionary.
+- `Bool mcd_get(m_ConcurrentDict* dict, Void* key, Void* value)`: Copies the value for `key` into `value` (may be NULL) and returns whether it was found.
+- `mcd_put(m_ConcurrentDict* dict, Void* key, Void* value)`: Adds or updates a key-value pair.
+- `Bool mcd_has(m_ConcurrentDict* dict, Void* key)`: Checks if a key exists.
+- `mcd_remove(m_ConcurrentDict* dict, Void* key)`: Removes a key-value pair.
+- `I32 mcd_count(m_ConcurrentDict* dict)`: Returns the number of entries (a snapshot while other threads write).
+
+### Read-Mostly Dictionary (m_ReadDict)
+A thread-safe dictionary for tables that are read far more often than written. Readers take no lock and write only
+their own cache line: they announce the current epoch, probe the published swiss table and leave. Writers serialise
+on a mutex, apply their change to a copy of the table, publish the copy atomically and retire the old table. A retired
+table is freed (through the allocator it came from) once every reader inside a lookup has announced a later epoch.
+Each write copies the whole table, so batch writes with `mrd_put_many`. Not available with `M_DISABLE_THREADS`.
+
+- `m_ReadDict* mrd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates a read-mostly dictionary with room for `maxreaders` concurrently registered reader threads.
+- `mrd_destroy(m_ReadDict* dict)`: Frees the dictionary and all retired tables. No reader may be inside a lookup.
+- `mrd_init(m_ReadDict* dict, ...)`: Initializes an existing read-mostly dictionary.
+- `I32 mrd_register(m_ReadDict* dict)`: Claims a reader slot for the calling thread (-1 when all are taken).
+- `mrd_unregister(m_ReadDict* dict, I32 reader)`: Releases a reader slot.
+- `Bool mrd_get(m_ReadDict* dict, I32 reader, Void* key, Void* value)`: Lock-free lookup; copies the value into `value` (may be NULL).
+- `Bool mrd_has(m_ReadDict* dict, I32 reader, Void* key)`: Lock-free membership test.
+- `mrd_put(m_ReadDict* dict, Void* key, Void* value)`: Adds or updates a pair and publishes a new table.
+- `mrd_put_many(m_ReadDict* dict, Void* keys, Void* values, I32 n)`: Applies n packed pairs and publishes once.
+- `mrd_remove(m_ReadDict* dict, Void* key)`: Removes a key and publishes a new table.
+- `I32 mrd_count(m_ReadDict* dict)`: Returns the number of entries in the published table.
+
+### Process-Shared Dictionary (m_SharedDict)
+One mutable table that several processes use together, in place of one m_Dict copy per worker process and the IPC
+that keeps the copies in sync. The slot tags, keys and values live in a named POSIX shared memory segment. The segment
+header stores offsets rather than pointers, so each process can map it at any address. Slots use linear probing with
+backward-shift deletion, so removals leave no tombstones. The segment is sized once from `itemcap` and never grows.
+Writers serialise on a process-shared mutex, which is robust on Linux: if a process dies while holding it, the next
+writer recovers the table. Each write is wrapped in a sequence counter, so readers take no lock; they copy the value
+out and retry if a writer got in the way. Keys and values must not contain pointers, since another process cannot
+follow them. Not available with `M_DISABLE_THREADS` or `M_DISABLE_MMAP`. On glibc older than 2.34, link with `-lrt`.
+
+- `m_SharedDict* mshd_create(CStr name, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer)`: Creates the segment `name` (such as `"/routes"`), sized for `itemcap` entries. Returns NULL if the name already exists.
+- `m_SharedDict* mshd_open(CStr name, m_ItemHasher hasher, m_ItemComparer comparer)`: Maps an existing segment. Waits briefly for a creator that has not finished setting it up. Every process must pass the same hasher; NULL selects `m_hasher_for_size`.
+- `mshd_destroy(m_SharedDict* dict)`: Unmaps the segment. The table remains for the other processes.
+- `mshd_unlink(CStr name)`: Removes the name. The memory is freed once the last process unmaps it.
+- `Bool mshd_get(m_SharedDict* dict, Void* key, Void* value)`: Lock-free lookup that copies the value into `value` (may be NULL).
+- `Bool mshd_has(m_SharedDict* dict, Void* key)`: Lock-free membership test.
+- `mshd_put(m_SharedDict* dict, Void* key, Void* value)`: Adds or updates a pair. A NULL `value` leaves an existing value alone and zeroes a new one. Returns `M_ERR_OUT_OF_BOUNDS` once the segment is full.
+- `mshd_remove(m_SharedDict* dict, Void* key)`: Removes a key-value pair. Missing keys are not an error.
+- `I32 mshd_count(m_SharedDict* dict)`: Returns the number of entries.
 
 ### String Buffer (m_StrBuffer)
 A dynamic string buffer for efficient manipulation.
@@ -182,6 +565,10 @@ The logging system provides configurable severity levels for debugging and monit
   - `m_log_error(format, ...)`: Logs at ERROR level.
   - `m_log_fatal(format, ...)`: Logs at FATAL level.
 
+## Benchmarks
+
+`make bench` builds src/bench.c in release mode and prints per-operation timings for the containers.
+
 ## Other macros
 
 
@@ -410,9 +797,25 @@ I32 main(I32 argc, Str* argv) {
 }
 */
 
+// POSIX.1-2008 with XSI, so rwlocks, robust mutexes, ftruncate and nanosleep stay visible under -std=c99
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
+
+// Threaded containers need pthreads, so they are built on POSIX targets unless M_DISABLE_THREADS is defined
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(M_DISABLE_THREADS)
+#define M_THREADS
+#endif
+
+// Files and shared memory are mapped with mmap on the same targets unless M_DISABLE_MMAP is defined
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(M_DISABLE_MMAP)
+#define M_MMAP
+#endif
 
 #ifndef M_DISABLE_ASSERTS
 #include <assert.h>
@@ -481,23 +884,208 @@ typedef struct m_Buffer {
 } m_Buffer;
 
 typedef I32 (*m_ItemComparer)(Void* item1, Void* item2);
+typedef U64 (*m_ItemHasher)(Void* item, I32 itemsize, U64 seed);
 
 typedef struct m_List {
     m_Buffer buffer;
     I32 count;
     m_ItemComparer comparer;
+    I32 growth;         // capacity after growing, in percent of the old one; 0 means 200
 } m_List;
 
-typedef struct m_Dict {
-    m_List keys;
-    m_List values;
-} m_Dict;
+typedef enum m_RadixKey {
+    M_RADIX_U32,
+    M_RADIX_I32,
+    M_RADIX_F32,
+    M_RADIX_U64,
+    M_RADIX_I64,
+    M_RADIX_F64,
+} m_RadixKey;
 
 typedef struct m_StrBuffer {
     m_Buffer buffer;
     I32 length;
 } m_StrBuffer;
 
+typedef enum m_DictMode {
+    M_DICT_LINEAR,      // keys/values are dense lists, lookups scan with the comparer
+    M_DICT_HASHED,      // keys/values are slot arrays indexed by an open-addressing table
+    M_DICT_SWISS,       // like M_DICT_HASHED, probed 16 control bytes at a time
+    M_DICT_ROBINHOOD,   // like M_DICT_HASHED, with Robin Hood displacement and backward-shift deletion
+    M_DICT_STRING,      // swiss table keyed by C strings copied into an owned arena
+    M_DICT_SORTED,      // keys/values are dense lists kept in key order, lookups binary search
+    M_DICT_COMPACT,     // keys/values are dense lists in insertion order, found through an I32 hash index
+} m_DictMode;
+
+typedef struct m_Dict {
+    m_List keys;
+    m_List values;
+    m_DictMode mode;
+    m_ItemHasher hasher;
+    U64 seed;
+    m_Buffer slots;     // per-slot hash tags or control bytes for the hashed modes, dense indexes for compact
+    I32 used;           // live + deleted slots
+    I32 maxload;        // max load factor in percent
+    m_StrBuffer arena;  // key bytes for the string mode
+    struct m_Dict* old; // table still being drained by an incremental resize, NULL otherwise
+    I32 cleared;        // bytes of the new slot array zeroed so far; the new table is used once all are
+    I32 migrated;       // old slots drained so far, counted from migratestart
+    I32 migratestart;
+    I32 rehashbudget;   // old slots drained per write, 0 resizes in one go
+} m_Dict;
+
+#define M_PROBE_HIST_SIZE 16
+
+typedef struct m_DictStats {
+    I32 count;
+    I32 slots;
+    I32 deleted;                        // tombstones waiting for the next rehash
+    I32 maxprobe;                       // slots (groups for swiss) visited to reach the farthest key
+    F64 meanprobe;
+    I32 probehist[M_PROBE_HIST_SIZE];   // keys by probe length, the last bucket counts longer probes too
+} m_DictStats;
+
+typedef struct m_FrozenDict {
+    Void* data;         // header, displacements, keys and values in one position independent blob
+    Sz size;
+    Bool owned;         // false when the blob belongs to the caller, e.g. a mapped file
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+    U32* disps;         // views into data
+    U8* keys;
+    U8* values;
+    I32 count;
+    I32 keysize;
+    I32 valuesize;
+    I32 bucketcount;
+    U64 seed;
+    Void* file;         // whole file behind md_map, released by mf_destroy; NULL otherwise
+    Sz filesize;
+} m_FrozenDict;
+
+typedef struct m_Set {
+    m_Dict dict;        // swiss table with no value storage
+} m_Set;
+
+typedef enum m_CachePolicy {
+    M_CACHE_LRU,        // evicts the least recently used entry
+    M_CACHE_CLOCK,      // second chance around a ring, a hit only sets a visited bit
+    M_CACHE_SIEVE,      // second chance over insertion order, survivors keep their place
+} m_CachePolicy;
+
+typedef Void (*m_CacheEvictor)(Void* key, Void* value, Void* context);
+
+typedef struct m_Cache {
+    m_Dict index;       // key -> entry, Robin Hood so deletes leave no tombstones
+    m_Buffer keys;
+    m_Buffer values;
+    m_Buffer links;     // newer/older I32 pairs for LRU and SIEVE, newest at head
+    m_Buffer marks;     // visited bits for CLOCK and SIEVE
+    I32 count;
+    I32 cap;
+    I32 head;
+    I32 tail;
+    I32 hand;
+    m_CachePolicy policy;
+    m_CacheEvictor evictor;
+    Void* context;
+    I64 hits;
+    I64 misses;
+    I64 evictions;
+} m_Cache;
+
+typedef enum m_FilterMode {
+    M_FILTER_BLOOM,     // split block Bloom filter, 32-byte blocks of eight U32 words, no removal
+    M_FILTER_CUCKOO,    // cuckoo filter, buckets of four U16 fingerprints, supports removal
+} m_FilterMode;
+
+typedef struct m_Filter {
+    m_Buffer blocks;    // Bloom blocks or cuckoo buckets, zeroed on init
+    m_FilterMode mode;
+    I32 keysize;
+    I32 count;
+    I32 blockcount;
+    I32 victim;         // cuckoo bucket of a fingerprint that found no room, -1 if none
+    U32 victimtag;
+    U64 seed;
+    m_ItemHasher hasher;
+} m_Filter;
+
+#define M_BTREE_NODE_BYTES  256     // key bytes per node, four cache lines
+
+typedef struct m_BTree {
+    Void* root;         // NULL while empty
+    I32 keysize;
+    I32 valuesize;
+    I32 order;          // max keys per node
+    I32 count;
+    m_ItemComparer comparer;
+    U8* scratch;        // one key, carries separators up through splits
+} m_BTree;
+
+typedef struct m_BTreeCursor {
+    m_BTree* tree;
+    Void* node;         // current leaf, NULL once past the end
+    I32 index;
+    Void* end;          // exclusive upper key, NULL for none
+} m_BTreeCursor;
+
+typedef struct m_Art {
+    Void* root;         // NULL while empty
+    I32 valuesize;
+    I32 count;
+} m_Art;
+
+typedef Bool (*m_ArtVisitor)(Void* key, I32 keylen, Void* value, Void* context);
+
+#define M_SMALL_DICT_CAP    16
+#define M_SMALL_DICT_BYTES  128     // inline bytes for keys and again for values
+
+typedef struct m_SmallDict {
+    I32 keysize;
+    I32 valuesize;
+    I32 count;
+    I32 cap;            // inline entries that fit, at most M_SMALL_DICT_CAP
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+    m_Dict* spill;      // swiss dict holding every entry after an overflow, NULL while inline
+    U64 keys[M_SMALL_DICT_BYTES / sizeof(U64)];
+    U64 values[M_SMALL_DICT_BYTES / sizeof(U64)];
+} m_SmallDict;
+
+typedef struct m_ConcurrentDict {
+    Void* shards;       // shardcount cache-line aligned (m_Dict, lock) pairs
+    Void* memory;
+    I32 shardcount;
+    I32 keysize;
+    Bool rwlocks;
+    m_ItemHasher hasher;
+} m_ConcurrentDict;
+
+typedef struct m_ReadDict {
+    Void* table;        // published m_Dict snapshot, replaced atomically by writers
+    U64 epoch;
+    I32 count;
+    I32 maxreaders;
+    Void* readers;      // one cache line per registered reader
+    Void* writelock;
+    Void* memory;
+    m_List retired;     // replaced tables waiting for readers to leave their epoch
+} m_ReadDict;
+
+typedef struct m_SharedDict {
+    Void* segment;      // POSIX shared memory: header, slot tags, keys and values, found through offsets
+    Sz size;
+    U32* tags;          // views into this process's mapping of the segment
+    U8* keys;
+    U8* values;
+    I32 keysize;
+    I32 valuesize;
+    I32 mask;
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+} m_SharedDict;
+
 typedef enum m_LogLevel {
     M_LOG_TRACE,
     M_LOG_INFO,
@@ -526,6 +1114,11 @@ IErr ml_init(m_List* list, I32 itemsize, I32 itemcap, m_ItemComparer comparer);
 IErr ml_setcap(m_List* list, I32 newcap);
 Void ml_clear(m_List* list);
 IErr ml_push(m_List* list, Void* item);
+IErr ml_push_many(m_List* list, Void* items, I32 n);
+Void* ml_emplace(m_List* list);
+Void* ml_extend_uninit(m_List* list, I32 n);
+IErr ml_reserve(m_List* list, I32 n);
+IErr ml_setgrowth(m_List* list, I32 percent);
 Void* ml_pop(m_List* list);
 Void* ml_get(m_List* list, I32 index);
 IErr ml_put(m_List* list, I32 index, Void* item);
@@ -535,7 +1128,247 @@ IErr ml_remove_range(m_List* list, I32 startindex, I32 count);
 IErr ml_remove_swap(m_List* list, I32 index);
 I32 ml_count(m_List* list);
 I32 ml_find(m_List* list, Void* item);
+I32 ml_find_bytes(m_List* list, Void* item);
+IErr ml_find_all(m_List* list, Void* item, m_List* indexes);
+I32 ml_count_eq(m_List* list, Void* item);
 Void ml_sort(m_List* list);
+Void ml_sort_pdq(m_List* list);
+IErr ml_sort_radix(m_List* list, I32 keyoffset, m_RadixKey keytype);
+IErr ml_argsort(m_List* list, I32* order);
+IErr ml_apply_permutation(m_List* list, I32* order);
+
+// Sort functions
+// M_SORT_DEFINE(T, name, less) defines static Void name(T* items, I32 n, Void* context), a pattern-defeating
+// quicksort (Orson Peters' pdqsort) with less(T* a, T* b, Void* context) expanded at every comparison.
+// Median-of-3 pivots (ninther above 128 items), insertion sort below 24, a partial insertion sort after
+// partitions that moved nothing, so sorted and reversed runs finish in linear time, an equal-keys partition
+// when the pivot repeats, and heapsort after log2(n) badly balanced partitions. Not stable.
+#define M_SORT_DEFINE(T, name, less)                                                            \
+static inline Void name##_swap(T* a, I32 i, I32 j) {                                            \
+    T tmp = a[i];                                                                               \
+    a[i] = a[j];                                                                                \
+    a[j] = tmp;                                                                                 \
+}                                                                                               \
+static inline Void name##_sort2(T* a, I32 i, I32 j, Void* context) {                            \
+    if (less(&a[j], &a[i], context)) {                                                          \
+        name##_swap(a, i, j);                                                                   \
+    }                                                                                           \
+}                                                                                               \
+static inline Void name##_sort3(T* a, I32 i, I32 j, I32 k, Void* context) {                     \
+    name##_sort2(a, i, j, context);                                                             \
+    name##_sort2(a, j, k, context);                                                             \
+    name##_sort2(a, i, j, context);                                                             \
+}                                                                                               \
+static Bool name##_insertion(T* a, I32 lo, I32 hi, I32 limit, Void* context) {                  \
+    I32 moved = 0;                                                                              \
+    for (I32 i = lo + 1; i < hi; ++i) {                                                         \
+        if (less(&a[i], &a[i - 1], context)) {                                                  \
+            T tmp = a[i];                                                                       \
+            I32 j = i;                                                                          \
+            do {                                                                                \
+                a[j] = a[j - 1];                                                                \
+                --j;                                                                            \
+            } while (j > lo && less(&tmp, &a[j - 1], context));                                 \
+            a[j] = tmp;                                                                         \
+            moved += i - j;                                                                     \
+            if (moved > limit) {                                                                \
+                return false;                                                                   \
+            }                                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+    return true;                                                                                \
+}                                                                                               \
+static Void name##_siftdown(T* h, I32 root, I32 n, Void* context) {                             \
+    for (I32 child = 2 * root + 1; child < n; child = 2 * root + 1) {                           \
+        if (child + 1 < n && less(&h[child], &h[child + 1], context)) {                         \
+            child++;                                                                            \
+        }                                                                                       \
+        if (!less(&h[root], &h[child], context)) {                                              \
+            return;                                                                             \
+        }                                                                                       \
+        name##_swap(h, root, child);                                                            \
+        root = child;                                                                           \
+    }                                                                                           \
+}                                                                                               \
+static Void name##_heapsort(T* h, I32 n, Void* context) {                                       \
+    for (I32 i = n / 2 - 1; i >= 0; --i) {                                                      \
+        name##_siftdown(h, i, n, context);                                                      \
+    }                                                                                           \
+    for (I32 i = n - 1; i > 0; --i) {                                                           \
+        name##_swap(h, 0, i);                                                                   \
+        name##_siftdown(h, 0, i, context);                                                      \
+    }                                                                                           \
+}                                                                                               \
+static I32 name##_partition_right(T* a, I32 lo, I32 hi, Bool* partitioned, Void* context) {     \
+    T pivot = a[lo];                                                                            \
+    I32 first = lo;                                                                             \
+    I32 last = hi;                                                                              \
+    while (++first, less(&a[first], &pivot, context));                                          \
+    if (first - 1 == lo) {                                                                      \
+        while (first < last && (--last, !less(&a[last], &pivot, context)));                     \
+    } else {                                                                                    \
+        while (--last, !less(&a[last], &pivot, context));                                       \
+    }                                                                                           \
+    *partitioned = first >= last;                                                               \
+    while (first < last) {                                                                      \
+        name##_swap(a, first, last);                                                            \
+        while (++first, less(&a[first], &pivot, context));                                      \
+        while (--last, !less(&a[last], &pivot, context));                                       \
+    }                                                                                           \
+    a[lo] = a[first - 1];                                                                       \
+    a[first - 1] = pivot;                                                                       \
+    return first - 1;                                                                           \
+}                                                                                               \
+static I32 name##_partition_left(T* a, I32 lo, I32 hi, Void* context) {                         \
+    T pivot = a[lo];                                                                            \
+    I32 first = lo;                                                                             \
+    I32 last = hi;                                                                              \
+    while (--last, less(&pivot, &a[last], context));                                            \
+    if (last + 1 == hi) {                                                                       \
+        while (first < last && (++first, !less(&pivot, &a[first], context)));                   \
+    } else {                                                                                    \
+        while (++first, !less(&pivot, &a[first], context));                                     \
+    }                                                                                           \
+    while (first < last) {                                                                      \
+        name##_swap(a, first, last);                                                            \
+        while (--last, less(&pivot, &a[last], context));                                        \
+        while (++first, !less(&pivot, &a[first], context));                                     \
+    }                                                                                           \
+    a[lo] = a[last];                                                                            \
+    a[last] = pivot;                                                                            \
+    return last;                                                                                \
+}                                                                                               \
+static Void name##_loop(T* a, I32 lo, I32 hi, I32 bad, Bool leftmost, Void* context) {          \
+    for (;;) {                                                                                  \
+        I32 size = hi - lo;                                                                     \
+        if (size < 24) {                                                                        \
+            name##_insertion(a, lo, hi, size * size, context);                                  \
+            return;                                                                             \
+        }                                                                                       \
+        I32 half = size / 2;                                                                    \
+        if (size > 128) {                                                                       \
+            name##_sort3(a, lo, lo + half, hi - 1, context);                                    \
+            name##_sort3(a, lo + 1, lo + half - 1, hi - 2, context);                            \
+            name##_sort3(a, lo + 2, lo + half + 1, hi - 3, context);                            \
+            name##_sort3(a, lo + half - 1, lo + half, lo + half + 1, context);                  \
+            name##_swap(a, lo, lo + half);                                                      \
+        } else {                                                                                \
+            name##_sort3(a, lo + half, lo, hi - 1, context);                                    \
+        }                                                                                       \
+        if (!leftmost && !less(&a[lo - 1], &a[lo], context)) {                                  \
+            lo = name##_partition_left(a, lo, hi, context) + 1;                                 \
+            continue;                                                                           \
+        }                                                                                       \
+        Bool partitioned;                                                                       \
+        I32 pos = name##_partition_right(a, lo, hi, &partitioned, context);                     \
+        I32 lsize = pos - lo;                                                                   \
+        I32 rsize = hi - pos - 1;                                                               \
+        if (lsize < size / 8 || rsize < size / 8) {                                             \
+            if (--bad == 0) {                                                                   \
+                name##_heapsort(a + lo, size, context);                                         \
+                return;                                                                         \
+            }                                                                                   \
+            if (lsize >= 24) {                                                                  \
+                name##_swap(a, lo, lo + lsize / 4);                                             \
+                name##_swap(a, pos - 1, pos - lsize / 4);                                       \
+            }                                                                                   \
+            if (rsize >= 24) {                                                                  \
+                name##_swap(a, pos + 1, pos + 1 + rsize / 4);                                   \
+                name##_swap(a, hi - 1, hi - rsize / 4);                                         \
+            }                                                                                   \
+        } else if (partitioned && name##_insertion(a, lo, pos, 8, context)                      \
+                   && name##_insertion(a, pos + 1, hi, 8, context)) {                           \
+            return;                                                                             \
+        }                                                                                       \
+        if (lsize < rsize) {                                                                    \
+            name##_loop(a, lo, pos, bad, leftmost, context);                                    \
+            lo = pos + 1;                                                                       \
+            leftmost = false;                                                                   \
+        } else {                                                                                \
+            name##_loop(a, pos + 1, hi, bad, false, context);                                   \
+            hi = pos;                                                                           \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+static Void name(T* items, I32 n, Void* context) {                                              \
+    I32 bad = 1;                                                                                \
+    for (I32 m = n; m > 1; m >>= 1) {                                                           \
+        bad++;                                                                                  \
+    }                                                                                           \
+    if (n > 1) {                                                                                \
+        name##_loop(items, 0, n, bad, true, context);                                           \
+    }                                                                                           \
+}
+
+// Typed list functions
+// M_LIST_DEFINE(I32, IntList) declares IntList, a wrapper around m_List that any ml_ function accepts
+// through &l->list, plus static inline IntList_push/get/at/put/find/count whose item size is a compile-time
+// constant and whose comparer is expanded in place. cmp takes two T* and returns 0 when they are equal;
+// M_LIST_DEFINE compares bytes, so use M_LIST_DEFINE_CMP for floats or padded structs. M_LIST_DEFINE leaves
+// the list's runtime comparer NULL, so ml_find matches bytes with SIMD; ml_sort and the other ordering
+// functions need M_LIST_DEFINE_CMP with a cmp that returns a sign.
+#define M_LIST_CMP_BYTES(a, b)      memcmp((a), (b), sizeof(*(a)))
+#define M_LIST_DEFINE(T, Name)      M_LIST_DEFINE_IMPL(T, Name, M_LIST_CMP_BYTES, NULL)
+#define M_LIST_DEFINE_CMP(T, Name, cmp) M_LIST_DEFINE_IMPL(T, Name, cmp, Name##_comparer)
+
+#define M_LIST_DEFINE_IMPL(T, Name, cmp, runtime)                                               \
+typedef struct Name {                                                                           \
+    m_List list;                                                                                \
+} Name;                                                                                         \
+static inline I32 Name##_comparer(Void* item1, Void* item2) {                                   \
+    return (I32)cmp((T*)item1, (T*)item2);                                                      \
+}                                                                                               \
+static inline IErr Name##_init(Name* l, I32 itemcap) {                                          \
+    return ml_init(&l->list, (I32)sizeof(T), itemcap, runtime);                                 \
+}                                                                                               \
+static inline Name* Name##_create(I32 itemcap) {                                                \
+    return (Name*)ml_create((I32)sizeof(T), itemcap, runtime);                                  \
+}                                                                                               \
+static inline Void Name##_destroy(Name* l) {                                                    \
+    ml_destroy(&l->list);                                                                       \
+}                                                                                               \
+static inline T* Name##_items(Name* l) {                                                        \
+    return (T*)l->list.buffer.data;                                                             \
+}                                                                                               \
+static inline I32 Name##_count(Name* l) {                                                       \
+    return l->list.count;                                                                       \
+}                                                                                               \
+static inline IErr Name##_push(Name* l, T item) {                                               \
+    if (l->list.count >= l->list.buffer.itemcap) {                                              \
+        IErr err = ml_reserve(&l->list, 1);                                                     \
+        if (err != 0) {                                                                         \
+            return err;                                                                         \
+        }                                                                                       \
+    }                                                                                           \
+    ((T*)l->list.buffer.data)[l->list.count++] = item;                                          \
+    return 0;                                                                                   \
+}                                                                                               \
+static inline T* Name##_get(Name* l, I32 index) {                                               \
+    if (index < 0 || index >= l->list.count) {                                                  \
+        return NULL;                                                                            \
+    }                                                                                           \
+    return (T*)l->list.buffer.data + index;                                                     \
+}                                                                                               \
+static inline T Name##_at(Name* l, I32 index) {                                                 \
+    m_assert(index >= 0 && index < l->list.count);                                              \
+    return ((T*)l->list.buffer.data)[index];                                                    \
+}                                                                                               \
+static inline IErr Name##_put(Name* l, I32 index, T item) {                                     \
+    if (index < 0 || index >= l->list.count) {                                                  \
+        return M_ERR_OUT_OF_BOUNDS;                                                             \
+    }                                                                                           \
+    ((T*)l->list.buffer.data)[index] = item;                                                    \
+    return 0;                                                                                   \
+}                                                                                               \
+static inline I32 Name##_find(Name* l, T item) {                                                \
+    T* items = (T*)l->list.buffer.data;                                                         \
+    for (I32 i = 0; i < l->list.count; ++i) {                                                   \
+        if (cmp(&items[i], &item) == 0) {                                                       \
+            return i;                                                                           \
+        }                                                                                       \
+    }                                                                                           \
+    return -1;                                                                                  \
+}
 
 // Dictionary functions
 m_Dict* md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
@@ -549,6 +1382,184 @@ Bool md_has(m_Dict* dict, Void* key);
 IErr md_remove(m_Dict* dict, Void* key);
 IErr md_remove_ordered(m_Dict* dict, Void* key);
 I32 md_count(m_Dict* dict);
+Bool md_iter(m_Dict* dict, I32* pos, Void** key, Void** value);
+I32 md_get_many(m_Dict* dict, Void* keys, Void** values, I32 n);
+I32 md_has_many(m_Dict* dict, Void* keys, Bool* found, I32 n);
+IErr md_put_many(m_Dict* dict, Void* keys, Void* values, I32 n);
+IErr md_remove_many(m_Dict* dict, Void* keys, I32 n);
+
+// Hashed dictionary functions
+m_Dict* md_create_hashed(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_hashed(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_swiss(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_swiss(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+
+m_Dict* md_create_robinhood(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_robinhood(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_compact(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_compact(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_str(I32 valuesize, I32 itemcap);
+IErr md_init_str(m_Dict* dict, I32 valuesize, I32 itemcap);
+IErr md_setseed(m_Dict* dict, U64 seed);
+IErr md_setrehashbudget(m_Dict* dict, I32 budget);
+Bool md_rehash_step(m_Dict* dict, I32 slots);
+IErr md_stats(m_Dict* dict, m_DictStats* stats);
+
+// Sorted dictionary functions
+m_Dict* md_create_sorted(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
+IErr md_init_sorted(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
+IErr md_build_sorted(m_Dict* dict, Void* keys, Void* values, I32 n);
+I32 md_lower_bound(m_Dict* dict, Void* key);
+I32 md_upper_bound(m_Dict* dict, Void* key);
+
+// Set functions
+m_Set* mset_create(I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mset_destroy(m_Set* set);
+IErr mset_init(m_Set* set, I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mset_clear(m_Set* set);
+IErr mset_add(m_Set* set, Void* key);
+Bool mset_has(m_Set* set, Void* key);
+IErr mset_remove(m_Set* set, Void* key);
+I32 mset_count(m_Set* set);
+Bool mset_iter(m_Set* set, I32* pos, Void** key);
+IErr mset_union(m_Set* set, m_Set* other);
+IErr mset_intersect(m_Set* set, m_Set* other);
+IErr mset_difference(m_Set* set, m_Set* other);
+
+// Cache functions
+m_Cache* mcache_create(I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcache_destroy(m_Cache* cache);
+IErr mcache_init(m_Cache* cache, I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcache_setevictor(m_Cache* cache, m_CacheEvictor evictor, Void* context);
+Void mcache_clear(m_Cache* cache);
+Void* mcache_get(m_Cache* cache, Void* key);
+IErr mcache_put(m_Cache* cache, Void* key, Void* value);
+Bool mcache_has(m_Cache* cache, Void* key);
+IErr mcache_remove(m_Cache* cache, Void* key);
+I32 mcache_count(m_Cache* cache);
+
+// Filter functions
+m_Filter* mfilter_create(m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher);
+Void mfilter_destroy(m_Filter* filter);
+IErr mfilter_init(m_Filter* filter, m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher);
+Void mfilter_clear(m_Filter* filter);
+IErr mfilter_add(m_Filter* filter, Void* key);
+Bool mfilter_test(m_Filter* filter, Void* key);
+IErr mfilter_remove(m_Filter* filter, Void* key);
+IErr mfilter_save(m_Filter* filter, m_Buffer* out);
+IErr mfilter_load(m_Filter* filter, Void* data, Sz size, m_ItemHasher hasher);
+
+// B-tree functions
+m_BTree* mbt_create(I32 keysize, I32 valuesize, m_ItemComparer comparer);
+Void mbt_destroy(m_BTree* tree);
+IErr mbt_init(m_BTree* tree, I32 keysize, I32 valuesize, m_ItemComparer comparer);
+Void mbt_clear(m_BTree* tree);
+IErr mbt_load(m_BTree* tree, m_List* keys, m_List* values);
+Void* mbt_get(m_BTree* tree, Void* key);
+IErr mbt_put(m_BTree* tree, Void* key, Void* value);
+Bool mbt_has(m_BTree* tree, Void* key);
+IErr mbt_remove(m_BTree* tree, Void* key);
+I32 mbt_remove_range(m_BTree* tree, Void* lo, Void* hi);
+I32 mbt_count(m_BTree* tree);
+m_BTreeCursor mbt_lower_bound(m_BTree* tree, Void* key);
+m_BTreeCursor mbt_upper_bound(m_BTree* tree, Void* key);
+m_BTreeCursor mbt_range(m_BTree* tree, Void* lo, Void* hi);
+Bool mbt_next(m_BTreeCursor* cursor, Void** key, Void** value);
+
+// Adaptive radix tree functions
+m_Art* mart_create(I32 valuesize);
+Void mart_destroy(m_Art* art);
+IErr mart_init(m_Art* art, I32 valuesize);
+Void mart_clear(m_Art* art);
+Void* mart_get(m_Art* art, Void* key, I32 keylen);
+IErr mart_put(m_Art* art, Void* key, I32 keylen, Void* value);
+Bool mart_has(m_Art* art, Void* key, I32 keylen);
+IErr mart_remove(m_Art* art, Void* key, I32 keylen);
+I32 mart_count(m_Art* art);
+Void* mart_longest_prefix(m_Art* art, Void* key, I32 keylen, I32* matchlen);
+I32 mart_iter_prefix(m_Art* art, Void* prefix, I32 prefixlen, m_ArtVisitor visitor, Void* context);
+Void mart_key_u64(U64 value, U8* out);
+
+// Small dictionary functions
+m_SmallDict* msd_create(I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer);
+Void msd_destroy(m_SmallDict* dict);
+IErr msd_init(m_SmallDict* dict, I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer);
+Void msd_clear(m_SmallDict* dict);
+Void* msd_get(m_SmallDict* dict, Void* key);
+IErr msd_put(m_SmallDict* dict, Void* key, Void* value);
+Bool msd_has(m_SmallDict* dict, Void* key);
+IErr msd_remove(m_SmallDict* dict, Void* key);
+I32 msd_count(m_SmallDict* dict);
+Bool msd_iter(m_SmallDict* dict, I32* pos, Void** key, Void** value);
+
+// Frozen dictionary functions
+m_FrozenDict* md_freeze(m_Dict* dict);
+m_FrozenDict* mf_load(Void* data, Sz size, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mf_destroy(m_FrozenDict* frozen);
+Void* mf_get(m_FrozenDict* frozen, Void* key);
+Bool mf_has(m_FrozenDict* frozen, Void* key);
+I32 mf_count(m_FrozenDict* frozen);
+
+// Mapped file functions
+IErr ml_save(m_List* list, CStr path);
+m_List* ml_map(CStr path, m_ItemComparer comparer, Bool verify);
+IErr md_save(m_Dict* dict, CStr path);
+m_FrozenDict* md_map(CStr path, m_ItemHasher hasher, m_ItemComparer comparer, Bool verify);
+
+// Hash functions
+U64 m_hash_bytes(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u32(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u64(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u128(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_str(Void* item, I32 itemsize, U64 seed);
+m_ItemHasher m_hasher_for_size(I32 itemsize);
+I32 m_compare_str(Void* item1, Void* item2);
+
+#ifdef M_THREADS
+// Concurrent dictionary functions
+m_ConcurrentDict* mcd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+                             m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcd_destroy(m_ConcurrentDict* dict);
+IErr mcd_init(m_ConcurrentDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+              m_ItemHasher hasher, m_ItemComparer comparer);
+Bool mcd_get(m_ConcurrentDict* dict, Void* key, Void* value);
+IErr mcd_put(m_ConcurrentDict* dict, Void* key, Void* value);
+Bool mcd_has(m_ConcurrentDict* dict, Void* key);
+IErr mcd_remove(m_ConcurrentDict* dict, Void* key);
+I32 mcd_count(m_ConcurrentDict* dict);
+
+// Read-mostly dictionary functions
+m_ReadDict* mrd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+                       m_ItemHasher hasher, m_ItemComparer comparer);
+Void mrd_destroy(m_ReadDict* dict);
+IErr mrd_init(m_ReadDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+              m_ItemHasher hasher, m_ItemComparer comparer);
+I32 mrd_register(m_ReadDict* dict);
+Void mrd_unregister(m_ReadDict* dict, I32 reader);
+Bool mrd_get(m_ReadDict* dict, I32 reader, Void* key, Void* value);
+Bool mrd_has(m_ReadDict* dict, I32 reader, Void* key);
+IErr mrd_put(m_ReadDict* dict, Void* key, Void* value);
+IErr mrd_put_many(m_ReadDict* dict, Void* keys, Void* values, I32 n);
+IErr mrd_remove(m_ReadDict* dict, Void* key);
+I32 mrd_count(m_ReadDict* dict);
+
+// Parallel sort functions
+IErr ml_sort_parallel(m_List* list, I32 nthreads, Bool stable);
+
+#ifdef M_MMAP
+// Process-shared dictionary functions
+m_SharedDict* mshd_create(CStr name, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher,
+                          m_ItemComparer comparer);
+m_SharedDict* mshd_open(CStr name, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mshd_destroy(m_SharedDict* dict);
+IErr mshd_unlink(CStr name);
+Bool mshd_get(m_SharedDict* dict, Void* key, Void* value);
+IErr mshd_put(m_SharedDict* dict, Void* key, Void* value);
+Bool mshd_has(m_SharedDict* dict, Void* key);
+IErr mshd_remove(m_SharedDict* dict, Void* key);
+I32 mshd_count(m_SharedDict* dict);
+#endif
+#endif
 
 // String Buffer functions
 m_StrBuffer* ms_create(I32 itemcap);
@@ -575,6 +1586,30 @@ I32 ms_find(m_StrBuffer* strbuffer, CStr substring);
 #include <stdarg.h>
 #include <ctype.h> // For isspace
 
+#ifdef M_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef M_MMAP
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) && !defined(M_DISABLE_SIMD)
+#include <emmintrin.h>
+#define M_SSE2
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define M_AVX2      // AVX2 functions are compiled with a target attribute and called after a runtime check
+#endif
+#endif
+
 // Default malloc function
 static Void* _default_malloc(Sz size, Void* userdata) {
     return malloc(size);
@@ -736,6 +1771,7 @@ IErr ml_init(m_List* list, I32 itemsize, I32 itemcap, m_ItemComparer comparer) {
     }
     list->count = 0;
     list->comparer = comparer ? comparer : _default_comparer;
+    list->growth = 0;
     return 0;  // Success
 }
 
@@ -746,10 +1782,40 @@ IErr ml_setcap(m_List* list, I32 newcap) {
     return mb_setcap(&list->buffer, newcap);
 }
 
+IErr ml_reserve(m_List* list, I32 n) {
+    if (!list) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (n < 0 || n > INT32_MAX - list->count) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    I32 needed = list->count + n;
+    if (needed <= list->buffer.itemcap) {
+        return 0;  // Success
+    }
+    I64 limit = INT32_MAX / m_max(list->buffer.itemsize, 1);   // Buffer sizes are I32 bytes
+    if (needed > limit) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    // Grow geometrically so repeated appends stay amortised O(1), but never short of what was asked for
+    I64 grown = (I64)list->buffer.itemcap * (list->growth ? list->growth : 200) / 100;
+    return ml_setcap(list, (I32)m_min(m_max(grown, (I64)needed), limit));
+}
+
+IErr ml_setgrowth(m_List* list, I32 percent) {
+    if (!list) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (percent != 0 && percent <= 100) {
+        return M_ERR_INVALID_OPERATION;  // The capacity has to grow
+    }
+    list->growth = percent;
+    return 0;  // Success
+}
+
 IErr ml_push(m_List* list, Void* item) {
     if (list->count >= list->buffer.itemcap) {
-        I32 newcap = list->buffer.itemcap * 2 ?: 1; // Double or start at 1
-        IErr err = ml_setcap(list, newcap);
+        IErr err = ml_reserve(list, 1);
         if (err != 0) {
             return err;
         }
@@ -759,6 +1825,35 @@ IErr ml_push(m_List* list, Void* item) {
     return 0; // Success
 }
 
+IErr ml_push_many(m_List* list, Void* items, I32 n) {
+    if (!list || !items) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (n == 0) {
+        return 0; // Success
+    }
+    Void* slots = ml_extend_uninit(list, n);
+    if (!slots) {
+        return n < 0 ? M_ERR_OUT_OF_BOUNDS : M_ERR_ALLOCATION_FAILED;
+    }
+    memcpy(slots, items, (Sz)n * list->buffer.itemsize);
+    return 0; // Success
+}
+
+Void* ml_emplace(m_List* list) {
+    return ml_extend_uninit(list, 1);
+}
+
+// The new slots hold whatever the buffer held before: zeroes after growth, old items after pops or removes
+Void* ml_extend_uninit(m_List* list, I32 n) {
+    if (ml_reserve(list, n) != 0 || !list->buffer.data) {
+        return NULL;
+    }
+    Void* slots = list->buffer.data + ((Sz)list->count * list->buffer.itemsize);
+    list->count += n;
+    return slots;
+}
+
 Void* ml_pop(m_List* list) {
     if (list->count == 0) {
         return NULL;
@@ -791,8 +1886,7 @@ IErr ml_insert(m_List* list, I32 index, Void* item) {
         return M_ERR_OUT_OF_BOUNDS;
     }
     if (list->count >= list->buffer.itemcap) {
-        I32 newcap = list->buffer.itemcap * 2 ?: 1;
-        IErr err = ml_setcap(list, newcap);
+        IErr err = ml_reserve(list, 1);
         if (err != 0) {
             return err;
         }
@@ -842,10 +1936,156 @@ IErr ml_remove_swap(m_List* list, I32 index) {
     return 0; // Success
 }
 
+// Bytewise find functions
+// Lists created without a comparer match items by their bytes instead of the default comparer's addresses.
+// 4- and 8-byte items are compared 32 at a time with SSE2, or AVX2 when the CPU has it, and each block
+// yields a bitmask of the matching items.
+typedef U32 (*_MatchBlock)(U8* items, U8* key);
+
+static U32 _match4(U8* items, U8* key) {
+    U32 k;
+    memcpy(&k, key, 4);
+    U32 mask = 0;
+#ifdef M_SSE2
+    __m128i needle = _mm_set1_epi32((I32)k);
+    for (I32 i = 0; i < 32; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(items + i * 4)), needle);
+        mask |= (U32)_mm_movemask_ps(_mm_castsi128_ps(eq)) << i;
+    }
+#else
+    for (I32 i = 0; i < 32; ++i) {
+        U32 item;
+        memcpy(&item, items + i * 4, 4);
+        mask |= (U32)(item == k) << i;
+    }
+#endif
+    return mask;
+}
+
+static U32 _match8(U8* items, U8* key) {
+    U64 k;
+    memcpy(&k, key, 8);
+    U32 mask = 0;
+#ifdef M_SSE2
+    // SSE2 has no 64-bit compare: both 32-bit halves must match
+    __m128i needle = _mm_set1_epi64x((I64)k);
+    for (I32 i = 0; i < 32; i += 2) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(items + i * 8)), needle);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        mask |= (U32)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+    }
+#else
+    for (I32 i = 0; i < 32; ++i) {
+        U64 item;
+        memcpy(&item, items + i * 8, 8);
+        mask |= (U32)(item == k) << i;
+    }
+#endif
+    return mask;
+}
+
+#ifdef M_AVX2
+__attribute__((target("avx2"))) static U32 _match4_avx2(U8* items, U8* key) {
+    U32 k;
+    memcpy(&k, key, 4);
+    __m256i needle = _mm256_set1_epi32((I32)k);
+    U32 mask = 0;
+    for (I32 i = 0; i < 32; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(items + i * 4)), needle);
+        mask |= (U32)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) << i;
+    }
+    return mask;
+}
+
+__attribute__((target("avx2"))) static U32 _match8_avx2(U8* items, U8* key) {
+    U64 k;
+    memcpy(&k, key, 8);
+    __m256i needle = _mm256_set1_epi64x((I64)k);
+    U32 mask = 0;
+    for (I32 i = 0; i < 32; i += 4) {
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(items + i * 8)), needle);
+        mask |= (U32)_mm256_movemask_pd(_mm256_castsi256_pd(eq)) << i;
+    }
+    return mask;
+}
+
+static I32 _avx2_checked = -1;   // -1 until the first check; racing threads store the same answer
+#endif
+
+static _MatchBlock _match_block(I32 itemsize) {
+    if (itemsize != 4 && itemsize != 8) {
+        return NULL;
+    }
+#ifdef M_AVX2
+    I32 avx2 = __atomic_load_n(&_avx2_checked, __ATOMIC_RELAXED);
+    if (avx2 < 0) {
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+        __atomic_store_n(&_avx2_checked, avx2, __ATOMIC_RELAXED);
+    }
+    if (avx2) {
+        return itemsize == 4 ? _match4_avx2 : _match8_avx2;
+    }
+#endif
+    return itemsize == 4 ? _match4 : _match8;
+}
+
+static Bool _bytewise(m_List* list) {
+    return !list->comparer || list->comparer == _default_comparer;
+}
+
+// With first set, returns the index of the first match or -1. Otherwise returns the number of matches and
+// appends their indexes to indexes when it is not NULL, or returns -1 if that fails.
+static I32 _bytes_scan(m_List* list, Void* item, Bool first, m_List* indexes) {
+    I32 size = list->buffer.itemsize;
+    U8* data = list->buffer.data;
+    _MatchBlock match = _match_block(size);
+    I32 found = 0;
+    I32 i = 0;
+    if (match) {
+        for (; i + 32 <= list->count; i += 32) {
+            U32 mask = match(data + (Sz)i * size, (U8*)item);
+            if (mask && first) {
+                return i + __builtin_ctz(mask);
+            }
+            found += __builtin_popcount(mask);
+            for (; mask && indexes; mask &= mask - 1) {
+                I32 index = i + __builtin_ctz(mask);
+                if (ml_push(indexes, &index) != 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+    for (; i < list->count; ++i) {
+        if (memcmp(data + (Sz)i * size, item, size) != 0) {
+            continue;
+        }
+        if (first) {
+            return i;
+        }
+        found++;
+        if (indexes && ml_push(indexes, &i) != 0) {
+            return -1;
+        }
+    }
+    return first ? -1 : found;
+}
+
+I32 ml_find_bytes(m_List* list, Void* item) {
+    if (!list || !item) {
+        return -1;
+    }
+    return _bytes_scan(list, item, true, NULL);
+}
+
 I32 ml_find(m_List* list, Void* item) {
-    if (!list || !item || !list->comparer) {
+    if (!list || !item) {
         return -1;
     }
+    if (_bytewise(list)) {
+        return _bytes_scan(list, item, true, NULL);
+    }
     for (I32 i = 0; i < list->count; ++i) {
         Void* list_item = list->buffer.data + (i * list->buffer.itemsize);
         if (list->comparer(list_item, item) == 0) {
@@ -855,6 +2095,41 @@ I32 ml_find(m_List* list, Void* item) {
     return -1;
 }
 
+IErr ml_find_all(m_List* list, Void* item, m_List* indexes) {
+    if (!list || !item || !indexes) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (indexes->buffer.itemsize != sizeof(I32)) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    if (_bytewise(list)) {
+        return _bytes_scan(list, item, false, indexes) < 0 ? M_ERR_ALLOCATION_FAILED : 0;
+    }
+    for (I32 i = 0; i < list->count; ++i) {
+        if (list->comparer(list->buffer.data + (Sz)i * list->buffer.itemsize, item) == 0) {
+            IErr err = ml_push(indexes, &i);
+            if (err != 0) {
+                return err;
+            }
+        }
+    }
+    return 0;  // Success
+}
+
+I32 ml_count_eq(m_List* list, Void* item) {
+    if (!list || !item) {
+        return 0;
+    }
+    if (_bytewise(list)) {
+        return _bytes_scan(list, item, false, NULL);
+    }
+    I32 found = 0;
+    for (I32 i = 0; i < list->count; ++i) {
+        found += list->comparer(list->buffer.data + (Sz)i * list->buffer.itemsize, item) == 0;
+    }
+    return found;
+}
+
 Void ml_clear(m_List* list) {
     list->count = 0;
 }
@@ -864,113 +2139,5558 @@ Void ml_sort(m_List* list) {
           (int (*)(const Void*, const Void*))list->comparer);
 }
 
-// Dictionary functions
-m_Dict* md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
-    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
-    if (!dict) {
-        return null;
-    }
-    IErr err = md_init(dict, keysize, valuesize, itemcap, comparer);
-    if (err != 0) {
-        m_free(dict);
-        return null;
-    }
-    return dict;
+// Pdqsort instances for common record sizes; the comparer is still called through a pointer, but items move
+// as whole words instead of through memcpy. Other sizes argsort the indexes and move every item once.
+typedef struct _Sort12 {
+    U32 words[3];
+} _Sort12;
+
+typedef struct _Sort16 {
+    U64 words[2];
+} _Sort16;
+
+typedef struct _Sort24 {
+    U64 words[3];
+} _Sort24;
+
+typedef struct _Sort32 {
+    U64 words[4];
+} _Sort32;
+
+#define _SORT_LESS(a, b, context)   ((*(m_ItemComparer*)(context))((Void*)(a), (Void*)(b)) < 0)
+
+M_SORT_DEFINE(U32, _sort_u32, _SORT_LESS)
+M_SORT_DEFINE(U64, _sort_u64, _SORT_LESS)
+M_SORT_DEFINE(_Sort12, _sort_12, _SORT_LESS)
+M_SORT_DEFINE(_Sort16, _sort_16, _SORT_LESS)
+M_SORT_DEFINE(_Sort24, _sort_24, _SORT_LESS)
+M_SORT_DEFINE(_Sort32, _sort_32, _SORT_LESS)
+
+// Index order by item, ties by index, which makes the argsort stable
+static inline Bool _sort_index_less(I32* a, I32* b, Void* context) {
+    m_List* list = (m_List*)context;
+    I32 order = list->comparer(list->buffer.data + (Sz)*a * list->buffer.itemsize,
+                               list->buffer.data + (Sz)*b * list->buffer.itemsize);
+    return order < 0 || (order == 0 && *a < *b);
 }
 
-Void md_destroy(m_Dict* dict) {
-    if (!dict) {
+M_SORT_DEFINE(I32, _sort_index, _sort_index_less)
+
+Void ml_sort_pdq(m_List* list) {
+    // The default comparer orders addresses, so every item is less than the stack copy of the pivot and the
+    // unguarded partition scans would run off the end; without an ordering comparer there is nothing to do
+    if (list->count < 2 || _bytewise(list)) {
         return;
     }
-    md_clear(dict);
-    ml_setcap(&dict->keys, 0);
-    ml_setcap(&dict->values, 0);
-    m_free(dict);
+    switch (list->buffer.itemsize) {
+        case 4:  _sort_u32((U32*)list->buffer.data, list->count, &list->comparer); return;
+        case 8:  _sort_u64((U64*)list->buffer.data, list->count, &list->comparer); return;
+        case 12: _sort_12((_Sort12*)list->buffer.data, list->count, &list->comparer); return;
+        case 16: _sort_16((_Sort16*)list->buffer.data, list->count, &list->comparer); return;
+        case 24: _sort_24((_Sort24*)list->buffer.data, list->count, &list->comparer); return;
+        case 32: _sort_32((_Sort32*)list->buffer.data, list->count, &list->comparer); return;
+    }
+    I32* order = (I32*)m_alloc(sizeof(I32) * list->count + 1);
+    if (!order || ml_argsort(list, order) != 0 || ml_apply_permutation(list, order) != 0) {
+        ml_sort(list);  // Out of memory for the indexes, sort in place the slow way
+    }
+    m_free(order);
 }
 
-IErr md_init(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
-    if (!dict) {
+IErr ml_argsort(m_List* list, I32* order) {
+    if (!list || !order) {
         return M_ERR_NULL_POINTER;
     }
-    IErr err = ml_init(&dict->keys, keysize, itemcap, comparer);
-    if (err != 0) {
-        return err;
+    if (_bytewise(list)) {
+        return M_ERR_INVALID_OPERATION;  // No comparer to order by
     }
-    err = ml_init(&dict->values, valuesize, itemcap, NULL);
-    if (err != 0) {
-        ml_destroy(&dict->keys);
-        return err;
+    for (I32 i = 0; i < list->count; ++i) {
+        order[i] = i;
     }
+    _sort_index(order, list->count, list);
     return 0;  // Success
 }
 
-IErr md_setcap(m_Dict* dict, I32 newcap) {
-    if (!dict) {
+// Gathers item order[i] into position i, through one scratch copy of the items
+IErr ml_apply_permutation(m_List* list, I32* order) {
+    if (!list || !order) {
         return M_ERR_NULL_POINTER;
     }
-    IErr err = ml_setcap(&dict->keys, newcap);
-    if (err != 0) {
-        return err;
+    Sz itemsize = list->buffer.itemsize;
+    Sz size = (Sz)list->count * itemsize;
+    if (size == 0) {
+        return 0;  // Success
     }
-    err = ml_setcap(&dict->values, newcap);
-    if (err != 0) {
-        return err;
+    U8* scratch = (U8*)m_alloc(size + 1);
+    if (!scratch) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    for (I32 i = 0; i < list->count; ++i) {
+        if (order[i] < 0 || order[i] >= list->count) {
+            m_free(scratch);
+            return M_ERR_OUT_OF_BOUNDS;
+        }
+        memcpy(scratch + i * itemsize, list->buffer.data + order[i] * itemsize, itemsize);
     }
+    memcpy(list->buffer.data, scratch, size);
+    m_free(scratch);
     return 0;  // Success
 }
 
-Void* md_get(m_Dict* dict, Void* key) {
-    I32 index = ml_find(&dict->keys, key);
-    return (index >= 0) ? ml_get(&dict->values, index) : NULL;
+// Maps a key to a U64 whose unsigned order is the key's order: signed keys flip the sign bit, floats flip
+// every bit when negative and the sign bit otherwise
+static U64 _radix_key(U8* item, m_RadixKey keytype) {
+    U32 u32;
+    U64 u64;
+    switch (keytype) {
+        case M_RADIX_U32: memcpy(&u32, item, 4); return u32;
+        case M_RADIX_I32: memcpy(&u32, item, 4); return u32 ^ 0x80000000u;
+        case M_RADIX_F32: memcpy(&u32, item, 4); return (U32)((u32 & 0x80000000u) ? ~u32 : u32 | 0x80000000u);
+        case M_RADIX_U64: memcpy(&u64, item, 8); return u64;
+        case M_RADIX_I64: memcpy(&u64, item, 8); return u64 ^ 0x8000000000000000ull;
+        case M_RADIX_F64: memcpy(&u64, item, 8); return (u64 >> 63) ? ~u64 : u64 | 0x8000000000000000ull;
+    }
+    return 0;
 }
 
-IErr md_put(m_Dict* dict, Void* key, Void* value) {
-    I32 index = ml_find(&dict->keys, key);
-    if (index >= 0) {
-        return ml_put(&dict->values, index, value);
+// LSD radix sort on 8-bit digits of (key, index) pairs, then one gather of the items. All digit histograms
+// come from a single pass over the keys, and a digit that is the same for every key is skipped, so
+// timestamps or small ids with constant high bytes take only the passes they need. Stable.
+IErr ml_sort_radix(m_List* list, I32 keyoffset, m_RadixKey keytype) {
+    if (!list) {
+        return M_ERR_NULL_POINTER;
     }
-    IErr err = ml_push(&dict->keys, key);
-    if (err != 0) return err;
-    err = ml_push(&dict->values, value);
-    if (err != 0) {
-        ml_remove(&dict->keys, ml_count(&dict->keys) - 1);
-        return err;
+    I32 keysize = keytype >= M_RADIX_U64 ? 8 : 4;
+    if (keytype < M_RADIX_U32 || keytype > M_RADIX_F64 || keyoffset < 0
+        || keyoffset + keysize > list->buffer.itemsize) {
+        return M_ERR_OUT_OF_BOUNDS;
     }
-    return 0; // Success
+    I32 n = list->count;
+    if (n < 2) {
+        return 0;  // Success
+    }
+    U64* keys = (U64*)m_alloc(sizeof(U64) * 2 * (Sz)n);
+    I32* order = (I32*)m_alloc(sizeof(I32) * 2 * (Sz)n);
+    U32* counts = (U32*)m_alloc(sizeof(U32) * 256 * keysize);
+    if (!keys || !order || !counts) {
+        m_free(keys);
+        m_free(order);
+        m_free(counts);
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    memset(counts, 0, sizeof(U32) * 256 * keysize);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = _radix_key(list->buffer.data + (Sz)i * list->buffer.itemsize + keyoffset, keytype);
+        keys[i] = key;
+        order[i] = i;
+        for (I32 d = 0; d < keysize; ++d) {
+            counts[d * 256 + ((key >> (8 * d)) & 0xff)]++;
+        }
+    }
+    U64* srckeys = keys;
+    U64* dstkeys = keys + n;
+    I32* srcorder = order;
+    I32* dstorder = order + n;
+    for (I32 d = 0; d < keysize; ++d) {
+        U32* count = counts + d * 256;
+        I32 shift = 8 * d;
+        if (count[(srckeys[0] >> shift) & 0xff] == (U32)n) {
+            continue;  // Every key has this digit
+        }
+        U32 offset = 0;
+        for (I32 b = 0; b < 256; ++b) {
+            U32 c = count[b];
+            count[b] = offset;
+            offset += c;
+        }
+        for (I32 i = 0; i < n; ++i) {
+            U32 slot = count[(srckeys[i] >> shift) & 0xff]++;
+            dstkeys[slot] = srckeys[i];
+            dstorder[slot] = srcorder[i];
+        }
+        U64* keyswap = srckeys;
+        srckeys = dstkeys;
+        dstkeys = keyswap;
+        I32* orderswap = srcorder;
+        srcorder = dstorder;
+        dstorder = orderswap;
+    }
+    m_free(keys);
+    m_free(counts);
+    IErr err = ml_apply_permutation(list, srcorder);
+    m_free(order);
+    return err;
 }
 
-Bool md_has(m_Dict* dict, Void* key) {
-    return ml_find(&dict->keys, key) >= 0;
+// Dictionary functions
+#define M_DICT_DEFAULT_MAXLOAD  75  // percent
+#define M_DICT_SWISS_MAXLOAD    87  // group probing stays short at higher load
+#define M_DICT_ROBINHOOD_MAXLOAD 85 // displacement keeps probe lengths even at higher load
+#define M_SLOT_EMPTY            0u
+#define M_SLOT_DELETED          1u
+#define M_GROUP_WIDTH           16
+
+static Void* _dict_key_at(m_Dict* dict, I32 slot) {
+    return dict->keys.buffer.data + (slot * dict->keys.buffer.itemsize);
+}
+
+static Void* _dict_value_at(m_Dict* dict, I32 slot) {
+    return dict->values.buffer.data + (slot * dict->values.buffer.itemsize);
+}
+
+// String mode slots hold arena offsets of a header followed by the NUL-terminated key bytes
+typedef struct _StrKeyHeader {
+    U64 hash;
+    I32 length;
+    I32 size;           // header + bytes + NUL, padded to 8
+} _StrKeyHeader;
+
+// What string mode probes with: the caller's key with its hash and length computed once
+typedef struct _StrKeyQuery {
+    U64 hash;
+    I32 length;
+    CStr str;
+} _StrKeyQuery;
+
+static _StrKeyHeader* _strkey_at(m_Dict* dict, Void* slotkey) {
+    return (_StrKeyHeader*)(dict->arena.buffer.data + *(I32*)slotkey);
+}
+
+static CStr _strkey_str(_StrKeyHeader* header) {
+    return (CStr)(header + 1);
+}
+
+// Hashed modes treat a null comparer as bytewise key equality. Lookups always pass the stored key first.
+static Bool _dict_keys_equal(m_Dict* dict, Void* key1, Void* key2) {
+    if (dict->mode == M_DICT_STRING) {
+        _StrKeyHeader* header = _strkey_at(dict, key1);
+        _StrKeyQuery* query = (_StrKeyQuery*)key2;
+        return header->hash == query->hash && header->length == query->length
+            && memcmp(_strkey_str(header), query->str, query->length) == 0;
+    }
+    if (dict->keys.comparer) {
+        return dict->keys.comparer(key1, key2) == 0;
+    }
+    return memcmp(key1, key2, dict->keys.buffer.itemsize) == 0;
+}
+
+static U64 _dict_hash(m_Dict* dict, Void* key) {
+    if (dict->mode == M_DICT_STRING) {
+        return _strkey_at(dict, key)->hash;  // Only stored keys are hashed this way, queries carry their own
+    }
+    return dict->hasher(key, dict->keys.buffer.itemsize, dict->seed);
+}
+
+static Bool _dict_is_table(m_Dict* dict) {
+    return dict->mode == M_DICT_HASHED || dict->mode == M_DICT_SWISS || dict->mode == M_DICT_ROBINHOOD
+        || dict->mode == M_DICT_STRING;
+}
+
+// Smallest power of two slot count (at least one group) that holds itemcap entries under maxload
+static I32 _table_slotcap(I32 itemcap, I32 maxload) {
+    I32 cap = M_GROUP_WIDTH;
+    while ((I64)cap * maxload < (I64)itemcap * 100) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+// Linear probing over U32 tags. Tags 0 and 1 mark empty and deleted slots, so live tags are shifted past them
+static U32 _slot_tag(U64 hash) {
+    U32 tag = (U32)(hash >> 32);
+    return tag > M_SLOT_DELETED ? tag : tag + 2;
+}
+
+static I32 _hashed_find(m_Dict* dict, Void* key, U64 hash) {
+    U32* tags = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 tag = _slot_tag(hash);
+    for (U32 i = (U32)hash & mask;; i = (i + 1) & mask) {
+        if (tags[i] == M_SLOT_EMPTY) {
+            return -1;
+        }
+        if (tags[i] == tag && _dict_keys_equal(dict, _dict_key_at(dict, i), key)) {
+            return (I32)i;
+        }
+    }
+}
+
+static I32 _hashed_claim(m_Dict* dict, U64 hash) {
+    U32* tags = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 i = (U32)hash & mask;
+    while (tags[i] > M_SLOT_DELETED) {
+        i = (i + 1) & mask;
+    }
+    if (tags[i] == M_SLOT_EMPTY) {
+        dict->used++;
+    }
+    tags[i] = _slot_tag(hash);
+    return (I32)i;
+}
+
+static Void _hashed_release(m_Dict* dict, I32 slot) {
+    U32* tags = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    // No probe chain runs through a slot followed by an empty one, so it can be freed outright
+    if (tags[(slot + 1) & mask] == M_SLOT_EMPTY) {
+        tags[slot] = M_SLOT_EMPTY;
+        dict->used--;
+    } else {
+        tags[slot] = M_SLOT_DELETED;
+    }
+}
+
+// Swiss-table group probing over U8 control bytes: 0 is empty, 1 is deleted and live slots
+// hold 0x80 | a 7-bit hash fingerprint, so the high bit alone tells full from free
+static U8 _swiss_h2(U64 hash) {
+    return (U8)(0x80 | (hash & 0x7f));
+}
+
+static U32 _group_match(U8* group, U8 byte) {
+#ifdef M_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+    U32 mask = 0;
+    for (I32 i = 0; i < M_GROUP_WIDTH; ++i) {
+        mask |= (U32)(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+static U32 _group_free(U8* group) {
+#ifdef M_SSE2
+    return ~(U32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group)) & 0xffff;
+#else
+    U32 mask = 0;
+    for (I32 i = 0; i < M_GROUP_WIDTH; ++i) {
+        mask |= (U32)!(group[i] & 0x80) << i;
+    }
+    return mask;
+#endif
+}
+
+static I32 _swiss_find(m_Dict* dict, Void* key, U64 hash) {
+    U32 groupmask = (U32)(dict->slots.itemcap / M_GROUP_WIDTH) - 1;
+    U8 h2 = _swiss_h2(hash);
+    U32 g = (U32)(hash >> 7) & groupmask;
+    // Triangular steps visit every group of a power of two table
+    for (U32 step = 1;; g = (g + step++) & groupmask) {
+        U8* group = dict->slots.data + (g * M_GROUP_WIDTH);
+        for (U32 match = _group_match(group, h2); match; match &= match - 1) {
+            I32 slot = (I32)(g * M_GROUP_WIDTH) + __builtin_ctz(match);
+            if (_dict_keys_equal(dict, _dict_key_at(dict, slot), key)) {
+                return slot;
+            }
+        }
+        if (_group_match(group, M_SLOT_EMPTY)) {
+            return -1;
+        }
+    }
+}
+
+static I32 _swiss_claim(m_Dict* dict, U64 hash) {
+    U32 groupmask = (U32)(dict->slots.itemcap / M_GROUP_WIDTH) - 1;
+    U32 g = (U32)(hash >> 7) & groupmask;
+    for (U32 step = 1;; g = (g + step++) & groupmask) {
+        U8* group = dict->slots.data + (g * M_GROUP_WIDTH);
+        U32 avail = _group_free(group);
+        if (avail) {
+            I32 slot = (I32)(g * M_GROUP_WIDTH) + __builtin_ctz(avail);
+            if (dict->slots.data[slot] == M_SLOT_EMPTY) {
+                dict->used++;
+            }
+            dict->slots.data[slot] = _swiss_h2(hash);
+            return slot;
+        }
+    }
+}
+
+static Void _swiss_release(m_Dict* dict, I32 slot) {
+    U8* group = dict->slots.data + (slot & ~(M_GROUP_WIDTH - 1));
+    // Lookups stop at the first group holding an empty byte, so such a group never needs tombstones
+    if (_group_match(group, M_SLOT_EMPTY)) {
+        dict->slots.data[slot] = M_SLOT_EMPTY;
+        dict->used--;
+    } else {
+        dict->slots.data[slot] = M_SLOT_DELETED;
+    }
+}
+
+// Robin Hood probing over U32 slot words holding the low hash bits with the top bit set, so 0 is empty
+// and home = word & mask. Inserts displace entries closer to home, deletes shift the chain back.
+static U32 _rh_word(U64 hash) {
+    return (U32)hash | 0x80000000u;
+}
+
+static U32 _rh_dist(U32 word, U32 slot, U32 mask) {
+    return (slot - word) & mask;
+}
+
+static Void _rh_move(m_Dict* dict, U32 from, U32 to) {
+    U32* words = (U32*)dict->slots.data;
+    words[to] = words[from];
+    memcpy(_dict_key_at(dict, to), _dict_key_at(dict, from), dict->keys.buffer.itemsize);
+    memcpy(_dict_value_at(dict, to), _dict_value_at(dict, from), dict->values.buffer.itemsize);
+}
+
+static I32 _robinhood_find(m_Dict* dict, Void* key, U64 hash) {
+    U32* words = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 word = _rh_word(hash);
+    U32 i = word & mask;
+    for (U32 dist = 0;; ++dist, i = (i + 1) & mask) {
+        // A resident closer to its home than we are to ours means the key would have displaced it
+        if (words[i] == 0 || _rh_dist(words[i], i, mask) < dist) {
+            return -1;
+        }
+        if (words[i] == word && _dict_keys_equal(dict, _dict_key_at(dict, i), key)) {
+            return (I32)i;
+        }
+    }
+}
+
+static I32 _robinhood_claim(m_Dict* dict, U64 hash) {
+    U32* words = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 word = _rh_word(hash);
+    U32 i = word & mask;
+    for (U32 dist = 0; words[i] != 0 && _rh_dist(words[i], i, mask) >= dist; ++dist) {
+        i = (i + 1) & mask;
+    }
+    if (words[i] != 0) {
+        // Take the richer slot and push the rest of the run one step further from home
+        U32 end = i;
+        while (words[end] != 0) {
+            end = (end + 1) & mask;
+        }
+        for (U32 j = end; j != i; j = (j - 1) & mask) {
+            _rh_move(dict, (j - 1) & mask, j);
+        }
+    }
+    words[i] = word;
+    dict->used++;
+    return (I32)i;
+}
+
+static Void _robinhood_release(m_Dict* dict, I32 slot) {
+    U32* words = (U32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 i = (U32)slot;
+    for (U32 next = (i + 1) & mask; words[next] != 0 && _rh_dist(words[next], next, mask) > 0; next = (i + 1) & mask) {
+        _rh_move(dict, next, i);
+        i = next;
+    }
+    words[i] = 0;
+    dict->used--;
+}
+
+// Mode-independent table operations
+static Bool _table_live(m_Dict* dict, I32 slot) {
+    switch (dict->mode) {
+        case M_DICT_SWISS:
+        case M_DICT_STRING:    return (dict->slots.data[slot] & 0x80) != 0;
+        case M_DICT_ROBINHOOD: return ((U32*)dict->slots.data)[slot] != 0;
+        default:               return ((U32*)dict->slots.data)[slot] > M_SLOT_DELETED;
+    }
+}
+
+static I32 _table_find(m_Dict* dict, Void* key, U64 hash) {
+    if (dict->slots.itemcap == 0) {
+        return -1;
+    }
+    switch (dict->mode) {
+        case M_DICT_SWISS:
+        case M_DICT_STRING:    return _swiss_find(dict, key, hash);
+        case M_DICT_ROBINHOOD: return _robinhood_find(dict, key, hash);
+        default:               return _hashed_find(dict, key, hash);
+    }
+}
+
+// Places a key known to be absent; the caller guarantees a free slot
+static I32 _table_insert_new(m_Dict* dict, Void* key, Void* value, U64 hash) {
+    I32 slot;
+    switch (dict->mode) {
+        case M_DICT_SWISS:
+        case M_DICT_STRING:    slot = _swiss_claim(dict, hash); break;
+        case M_DICT_ROBINHOOD: slot = _robinhood_claim(dict, hash); break;
+        default:               slot = _hashed_claim(dict, hash); break;
+    }
+    memcpy(_dict_key_at(dict, slot), key, dict->keys.buffer.itemsize);
+    if (value) {
+        memcpy(_dict_value_at(dict, slot), value, dict->values.buffer.itemsize);
+    }
+    dict->keys.count++;
+    dict->values.count++;
+    return slot;
+}
+
+// Incremental resizing: the full table becomes dict->old and a fresh one takes its place. Each write
+// first zeroes rehashbudget groups of the new slot array while the old table keeps taking inserts (the
+// budget minimum keeps that within the old load headroom), then drains rehashbudget old slots per write
+// into the new table. Lookups fall back to the old slots not yet drained but never step themselves, so
+// value pointers from md_get, md_get_many and md_iter stay valid until the next write. Robin Hood backward shifts only
+// move entries forward of the removed one, so draining starts at an empty slot, which no shift crosses,
+// and entries never move from the undrained part into the drained one.
+static Bool _rehash_ready(m_Dict* dict) {
+    return !dict->old || dict->cleared == dict->slots.itemcap * dict->slots.itemsize;
+}
+
+static Bool _rehash_drained(m_Dict* dict, I32 slot) {
+    U32 mask = (U32)dict->old->slots.itemcap - 1;
+    return (((U32)slot - (U32)dict->migratestart) & mask) < (U32)dict->migrated;
+}
+
+static Void _rehash_drop(m_Dict* dict) {
+    m_Dict* old = dict->old;
+    mb_setcap(&old->keys.buffer, 0);
+    mb_setcap(&old->values.buffer, 0);
+    mb_setcap(&old->slots, 0);
+    m_free(old);
+    dict->old = NULL;
+}
+
+static Void _rehash_step(m_Dict* dict, I32 budget) {
+    m_Dict* old = dict->old;
+    if (!old) {
+        return;
+    }
+    I32 oldcap = old->slots.itemcap;
+    if (!_rehash_ready(dict)) {
+        I32 total = dict->slots.itemcap * dict->slots.itemsize;
+        I32 bytes = (I32)m_min((I64)budget * M_GROUP_WIDTH, (I64)(total - dict->cleared));
+        memset(dict->slots.data + dict->cleared, 0, bytes);
+        dict->cleared += bytes;
+        if (dict->cleared < total) {
+            return;
+        }
+        if (dict->mode == M_DICT_ROBINHOOD) {
+            // Inserts have stopped landing in the old table, so an empty slot found now stays empty
+            while (((U32*)old->slots.data)[dict->migratestart] != 0) {
+                dict->migratestart++;
+            }
+        }
+        return;
+    }
+    for (; budget > 0 && dict->migrated < oldcap; --budget) {
+        I32 s = (dict->migratestart + dict->migrated++) & (oldcap - 1);
+        if (_table_live(old, s)) {
+            Void* key = _dict_key_at(old, s);
+            _table_insert_new(dict, key, _dict_value_at(old, s), _dict_hash(dict, key));
+            old->keys.count--;
+            old->values.count--;
+        }
+    }
+    if (dict->migrated == oldcap) {
+        _rehash_drop(dict);
+    }
+}
+
+static Void _rehash_finish(m_Dict* dict) {
+    while (dict->old) {
+        _rehash_step(dict, m_max(dict->slots.itemcap, dict->old->slots.itemcap));
+    }
+}
+
+static IErr _buffer_alloc(m_Buffer* buffer, I32 itemsize, I32 itemcap) {
+    buffer->allocator = m_get_allocator();
+    buffer->itemsize = itemsize;
+    buffer->itemcap = itemcap;
+    buffer->data = itemcap ? (U8*)m_alloc((Sz)m_max(itemsize, 1) * itemcap) : NULL;
+    return (buffer->data || !itemcap) ? 0 : M_ERR_ALLOCATION_FAILED;
+}
+
+static IErr _rehash_begin(m_Dict* dict, I32 newcap) {
+    m_Dict* old = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!old) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    m_Buffer keys, values, slots;
+    IErr err = _buffer_alloc(&keys, dict->keys.buffer.itemsize, newcap);
+    if (err == 0) {
+        err = _buffer_alloc(&values, dict->values.buffer.itemsize, dict->values.buffer.itemsize ? newcap : 0);
+        if (err != 0) mb_setcap(&keys, 0);
+    }
+    if (err == 0) {
+        err = _buffer_alloc(&slots, dict->slots.itemsize, newcap);
+        if (err != 0) {
+            mb_setcap(&keys, 0);
+            mb_setcap(&values, 0);
+        }
+    }
+    if (err != 0) {
+        m_free(old);
+        return err;
+    }
+
+    *old = *dict;
+    old->old = NULL;
+    dict->keys.buffer = keys;
+    dict->values.buffer = values;
+    dict->slots = slots;
+    dict->keys.count = 0;
+    dict->values.count = 0;
+    dict->used = 0;
+    dict->old = old;
+    dict->cleared = 0;
+    dict->migrated = 0;
+    dict->migratestart = 0;
+    return 0;  // Success
+}
+
+// Finds key in the table, falling back to the old slots an incremental resize has not drained yet
+static m_Dict* _table_locate(m_Dict* dict, Void* key, U64 hash, I32* slot) {
+    *slot = _rehash_ready(dict) ? _table_find(dict, key, hash) : -1;
+    if (*slot >= 0) {
+        return dict;
+    }
+    if (dict->old) {
+        *slot = _table_find(dict->old, key, hash);
+        if (*slot >= 0 && !_rehash_drained(dict, *slot)) {
+            return dict->old;
+        }
+    }
+    return null;
+}
+
+static Void* _table_get(m_Dict* dict, Void* key, U64 hash) {
+    I32 slot;
+    m_Dict* owner = _table_locate(dict, key, hash, &slot);
+    return owner ? _dict_value_at(owner, slot) : NULL;
+}
+
+// Moves every live entry into freshly allocated slot arrays, dropping tombstones
+static IErr _table_rehash(m_Dict* dict, I32 newcap) {
+    _rehash_finish(dict);
+    m_Buffer keys, values, slots;
+    IErr err = mb_init(&keys, dict->keys.buffer.itemsize, newcap);
+    if (err != 0) {
+        return err;
+    }
+    // Sets carry no values, so a zero value size keeps the value array unallocated
+    err = mb_init(&values, dict->values.buffer.itemsize, dict->values.buffer.itemsize ? newcap : 0);
+    if (err != 0) {
+        mb_setcap(&keys, 0);
+        return err;
+    }
+    err = mb_init(&slots, dict->slots.itemsize, newcap);
+    if (err != 0) {
+        mb_setcap(&keys, 0);
+        mb_setcap(&values, 0);
+        return err;
+    }
+
+    m_Dict old = *dict;
+    dict->keys.buffer = keys;
+    dict->values.buffer = values;
+    dict->slots = slots;
+    dict->keys.count = 0;
+    dict->values.count = 0;
+    dict->used = 0;
+    for (I32 s = 0; s < old.slots.itemcap; ++s) {
+        if (_table_live(&old, s)) {
+            Void* key = _dict_key_at(&old, s);
+            _table_insert_new(dict, key, _dict_value_at(&old, s), _dict_hash(dict, key));
+        }
+    }
+
+    mb_setcap(&old.keys.buffer, 0);
+    mb_setcap(&old.values.buffer, 0);
+    mb_setcap(&old.slots, 0);
+    return 0;  // Success
+}
+
+// Adds a key known to be absent, growing or purging tombstones first when the load budget is spent
+static IErr _table_add(m_Dict* dict, Void* key, Void* value, U64 hash) {
+    if (dict->old && (_rehash_ready(dict) ? (I64)(dict->used + 1) * 100 > (I64)dict->slots.itemcap * dict->maxload
+                                          : dict->old->used + M_GROUP_WIDTH >= dict->old->slots.itemcap)) {
+        _rehash_finish(dict);
+    }
+    I32 cap = dict->slots.itemcap;
+    if ((I64)(dict->used + 1) * 100 > (I64)cap * dict->maxload) {
+        // Grow when live entries fill more than half the budget, otherwise just purge tombstones
+        I32 newcap = cap ? cap : M_GROUP_WIDTH;
+        if ((I64)(dict->keys.count + 1) * 200 > (I64)newcap * dict->maxload) {
+            newcap *= 2;
+        }
+        IErr err = (dict->rehashbudget > 0 && dict->keys.count > 0) ? _rehash_begin(dict, newcap)
+                                                                     : _table_rehash(dict, newcap);
+        if (err != 0) {
+            return err;
+        }
+    }
+    // Until the new slot array is cleared, inserts keep landing in the old table's load headroom
+    _table_insert_new(_rehash_ready(dict) ? dict : dict->old, key, value, hash);
+    return 0; // Success
+}
+
+static IErr _table_put(m_Dict* dict, Void* key, Void* value, U64 hash) {
+    _rehash_step(dict, dict->rehashbudget);
+    I32 slot;
+    m_Dict* owner = _table_locate(dict, key, hash, &slot);
+    if (owner) {
+        if (value) {
+            memcpy(_dict_value_at(owner, slot), value, owner->values.buffer.itemsize);
+        }
+        return 0;
+    }
+    return _table_add(dict, key, value, hash);
+}
+
+static Void _table_remove(m_Dict* dict, Void* key, U64 hash) {
+    _rehash_step(dict, dict->rehashbudget);
+    I32 slot;
+    m_Dict* owner = _table_locate(dict, key, hash, &slot);
+    if (!owner) {
+        return;
+    }
+    switch (owner->mode) {
+        case M_DICT_SWISS:
+        case M_DICT_STRING:    _swiss_release(owner, slot); break;
+        case M_DICT_ROBINHOOD: _robinhood_release(owner, slot); break;
+        default:               _hashed_release(owner, slot); break;
+    }
+    owner->keys.count--;
+    owner->values.count--;
+}
+
+static IErr _table_init(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap,
+                        m_ItemHasher hasher, m_ItemComparer comparer, m_DictMode mode) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    Bool swiss = mode == M_DICT_SWISS || mode == M_DICT_STRING;
+    I32 maxload = swiss ? M_DICT_SWISS_MAXLOAD
+                : mode == M_DICT_ROBINHOOD ? M_DICT_ROBINHOOD_MAXLOAD : M_DICT_DEFAULT_MAXLOAD;
+    I32 slotcap = _table_slotcap(itemcap, maxload);
+    IErr err = md_init(dict, keysize, valuesize, slotcap, comparer);
+    if (err != 0) {
+        return err;
+    }
+    err = mb_init(&dict->slots, swiss ? sizeof(U8) : sizeof(U32), slotcap);
+    if (err != 0) {
+        ml_setcap(&dict->keys, 0);
+        ml_setcap(&dict->values, 0);
+        return err;
+    }
+    if (valuesize == 0) {
+        mb_setcap(&dict->values.buffer, 0);
+        dict->values.buffer.itemsize = 0;   // mb_setcap assumes one byte items once it allocates
+    }
+    dict->keys.comparer = comparer;
+    dict->mode = mode;
+    dict->hasher = hasher ? hasher : m_hasher_for_size(keysize);
+    dict->maxload = maxload;
+    return 0;  // Success
+}
+
+// String mode: a swiss table of arena offsets. Keys are copied into one growing arena and
+// compacted whenever it has to be reallocated, so removed keys are reclaimed on the next growth.
+static _StrKeyQuery _strkey_query(m_Dict* dict, CStr str) {
+    _StrKeyQuery query;
+    query.str = str;
+    query.length = (I32)strlen(str);
+    query.hash = m_hash_bytes((Void*)str, query.length, dict->seed);
+    return query;
+}
+
+static IErr _strkey_reserve(m_Dict* dict, I32 size) {
+    m_StrBuffer* arena = &dict->arena;
+    if (arena->length + size <= arena->buffer.itemcap) {
+        return 0;
+    }
+    I32 live = 0;
+    for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+        if (_table_live(dict, s)) {
+            live += _strkey_at(dict, _dict_key_at(dict, s))->size;
+        }
+    }
+    m_Buffer fresh;
+    IErr err = mb_init(&fresh, 1, m_max(256, 2 * (live + size)));
+    if (err != 0) {
+        return err;
+    }
+    I32 length = 0;
+    for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+        if (_table_live(dict, s)) {
+            I32* offset = (I32*)_dict_key_at(dict, s);
+            _StrKeyHeader* header = _strkey_at(dict, offset);
+            memcpy(fresh.data + length, header, header->size);
+            *offset = length;
+            length += header->size;
+        }
+    }
+    mb_setcap(&arena->buffer, 0);
+    arena->buffer = fresh;
+    arena->length = length;
+    return 0;  // Success
+}
+
+static IErr _strkey_put(m_Dict* dict, CStr str, Void* value) {
+    _StrKeyQuery query = _strkey_query(dict, str);
+    I32 slot = _table_find(dict, &query, query.hash);
+    if (slot >= 0) {
+        if (value) {
+            memcpy(_dict_value_at(dict, slot), value, dict->values.buffer.itemsize);
+        }
+        return 0;
+    }
+
+    I32 size = (I32)((sizeof(_StrKeyHeader) + query.length + 1 + 7) & ~(Sz)7);
+    IErr err = _strkey_reserve(dict, size);
+    if (err != 0) {
+        return err;
+    }
+    I32 offset = dict->arena.length;
+    _StrKeyHeader* header = _strkey_at(dict, &offset);
+    header->hash = query.hash;
+    header->length = query.length;
+    header->size = size;
+    memcpy(header + 1, str, query.length + 1);
+    dict->arena.length += size;
+    return _table_add(dict, &offset, value, query.hash);
+}
+
+// Sorted mode keeps keys/values as dense lists ordered by the comparer (bytewise when null)
+static I32 _dict_keys_compare(m_Dict* dict, Void* key1, Void* key2) {
+    if (dict->keys.comparer && dict->keys.comparer != _default_comparer) {
+        return dict->keys.comparer(key1, key2);
+    }
+    return memcmp(key1, key2, dict->keys.buffer.itemsize);
+}
+
+// Index of the first key not less than key (or greater than key when upper is set)
+static I32 _sorted_bound(m_Dict* dict, Void* key, Bool upper) {
+    I32 lo = 0;
+    I32 hi = dict->keys.count;
+    while (lo < hi) {
+        I32 mid = lo + (hi - lo) / 2;
+        I32 cmp = _dict_keys_compare(dict, _dict_key_at(dict, mid), key);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static I32 _sorted_find(m_Dict* dict, Void* key) {
+    I32 index = _sorted_bound(dict, key, false);
+    if (index < dict->keys.count && _dict_keys_compare(dict, _dict_key_at(dict, index), key) == 0) {
+        return index;
+    }
+    return -1;
+}
+
+static IErr _sorted_put(m_Dict* dict, Void* key, Void* value) {
+    I32 index = _sorted_bound(dict, key, false);
+    if (index < dict->keys.count && _dict_keys_compare(dict, _dict_key_at(dict, index), key) == 0) {
+        return ml_put(&dict->values, index, value);
+    }
+    IErr err = ml_insert(&dict->keys, index, key);
+    if (err != 0) return err;
+    err = ml_insert(&dict->values, index, value);
+    if (err != 0) {
+        ml_remove(&dict->keys, index);
+        return err;
+    }
+    return 0; // Success
+}
+
+// Records are padded to 8 bytes, so the key at the start of each one is aligned for U64 and F64 comparers
+static I32 _record_size(I32 keysize, I32 extra) {
+    return (keysize + extra + 7) & ~7;
+}
+
+// Stable bottom-up merge sort of (key, value) records by their leading key
+static U8* _sort_records(m_Dict* dict, U8* records, U8* scratch, I32 count, I32 recsize) {
+    U8* src = records;
+    U8* dst = scratch;
+    for (I32 width = 1; width < count; width *= 2) {
+        for (I32 lo = 0; lo < count; lo += 2 * width) {
+            I32 mid = m_min(lo + width, count);
+            I32 hi = m_min(lo + 2 * width, count);
+            I32 i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (_dict_keys_compare(dict, src + (Sz)j * recsize, src + (Sz)i * recsize) < 0) {
+                    memcpy(dst + (Sz)k++ * recsize, src + (Sz)j++ * recsize, recsize);
+                } else {
+                    memcpy(dst + (Sz)k++ * recsize, src + (Sz)i++ * recsize, recsize);
+                }
+            }
+            memcpy(dst + (Sz)k * recsize, src + (Sz)i * recsize, (Sz)(mid - i) * recsize);
+            k += mid - i;
+            memcpy(dst + (Sz)k * recsize, src + (Sz)j * recsize, (Sz)(hi - j) * recsize);
+        }
+        U8* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    return src;
+}
+
+// Merges n sorted, duplicate-free records into the dict; on equal keys the record wins
+static IErr _sorted_merge(m_Dict* dict, U8* records, I32 n) {
+    I32 keysize = dict->keys.buffer.itemsize;
+    I32 valuesize = dict->values.buffer.itemsize;
+    I32 recsize = _record_size(keysize, valuesize);
+    m_Buffer keys, values;
+    IErr err = mb_init(&keys, keysize, m_max(dict->keys.count + n, dict->keys.buffer.itemcap));
+    if (err != 0) {
+        return err;
+    }
+    err = mb_init(&values, valuesize, keys.itemcap);
+    if (err != 0) {
+        mb_setcap(&keys, 0);
+        return err;
+    }
+    I32 i = 0, j = 0, k = 0;
+    while (i < dict->keys.count || j < n) {
+        U8* record = records + (Sz)j * recsize;
+        I32 cmp = i == dict->keys.count ? 1 : j == n ? -1 : _dict_keys_compare(dict, _dict_key_at(dict, i), record);
+        if (cmp < 0) {
+            memcpy(keys.data + (Sz)k * keysize, _dict_key_at(dict, i), keysize);
+            memcpy(values.data + (Sz)k * valuesize, _dict_value_at(dict, i), valuesize);
+            i++;
+        } else {
+            memcpy(keys.data + (Sz)k * keysize, record, keysize);
+            memcpy(values.data + (Sz)k * valuesize, record + keysize, valuesize);
+            i += cmp == 0;
+            j++;
+        }
+        k++;
+    }
+    mb_setcap(&dict->keys.buffer, 0);
+    mb_setcap(&dict->values.buffer, 0);
+    dict->keys.buffer = keys;
+    dict->values.buffer = values;
+    dict->keys.count = k;
+    dict->values.count = k;
+    return 0;  // Success
+}
+
+// Compact mode keeps keys/values dense in insertion order, as the linear mode does, and finds them through
+// a power of two array of I32 indexes into the dense lists (linear probing, like CPython's compact dict)
+#define M_INDEX_EMPTY   -1
+#define M_INDEX_DELETED -2
+
+static I32 _compact_find(m_Dict* dict, Void* key, U64 hash) {
+    I32* index = (I32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    if (dict->slots.itemcap == 0) {
+        return -1;
+    }
+    for (U32 i = (U32)hash & mask;; i = (i + 1) & mask) {
+        if (index[i] == M_INDEX_EMPTY) {
+            return -1;
+        }
+        if (index[i] >= 0 && _dict_keys_equal(dict, _dict_key_at(dict, index[i]), key)) {
+            return (I32)i;
+        }
+    }
+}
+
+// Slot that holds dense position pos, whose key hashes to hash
+static I32 _compact_slot_of(m_Dict* dict, I32 pos, U64 hash) {
+    I32* index = (I32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 i = (U32)hash & mask;
+    while (index[i] != pos) {
+        i = (i + 1) & mask;
+    }
+    return (I32)i;
+}
+
+static Void _compact_claim(m_Dict* dict, I32 pos, U64 hash) {
+    I32* index = (I32*)dict->slots.data;
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    U32 i = (U32)hash & mask;
+    while (index[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    if (index[i] == M_INDEX_EMPTY) {
+        dict->used++;
+    }
+    index[i] = pos;
+}
+
+// Rebuilds the index at slotcap slots from the dense keys, dropping tombstones
+static IErr _compact_reindex(m_Dict* dict, I32 slotcap) {
+    if (slotcap != dict->slots.itemcap) {
+        m_Buffer slots;
+        IErr err = mb_init(&slots, sizeof(I32), slotcap);
+        if (err != 0) {
+            return err;
+        }
+        mb_setcap(&dict->slots, 0);
+        dict->slots = slots;
+    }
+    memset(dict->slots.data, 0xff, (Sz)dict->slots.itemcap * sizeof(I32));  // All M_INDEX_EMPTY
+    dict->used = 0;
+    for (I32 i = 0; i < dict->keys.count; ++i) {
+        _compact_claim(dict, i, _dict_hash(dict, _dict_key_at(dict, i)));
+    }
+    return 0;  // Success
+}
+
+static IErr _compact_put(m_Dict* dict, Void* key, Void* value) {
+    U64 hash = _dict_hash(dict, key);
+    I32 slot = _compact_find(dict, key, hash);
+    if (slot >= 0) {
+        return ml_put(&dict->values, ((I32*)dict->slots.data)[slot], value);
+    }
+    I32 cap = dict->slots.itemcap;
+    if ((I64)(dict->used + 1) * 100 > (I64)cap * dict->maxload) {
+        // Grow when live entries fill more than half the budget, otherwise just purge tombstones
+        I32 newcap = cap ? cap : M_GROUP_WIDTH;
+        if ((I64)(dict->keys.count + 1) * 200 > (I64)newcap * dict->maxload) {
+            newcap *= 2;
+        }
+        IErr err = _compact_reindex(dict, newcap);
+        if (err != 0) {
+            return err;
+        }
+    }
+    IErr err = ml_push(&dict->keys, key);
+    if (err != 0) return err;
+    err = ml_push(&dict->values, value);
+    if (err != 0) {
+        ml_remove(&dict->keys, ml_count(&dict->keys) - 1);
+        return err;
+    }
+    _compact_claim(dict, dict->keys.count - 1, hash);
+    return 0; // Success
+}
+
+static IErr _compact_remove(m_Dict* dict, Void* key, Bool ordered) {
+    I32 slot = _compact_find(dict, key, _dict_hash(dict, key));
+    if (slot < 0) {
+        return 0;  // No key found, still success
+    }
+    I32* index = (I32*)dict->slots.data;
+    I32 pos = index[slot];
+    I32 last = dict->keys.count - 1;
+    index[slot] = M_INDEX_DELETED;
+    if (ordered) {
+        IErr err = ml_remove(&dict->keys, pos);
+        if (err != 0) return err;
+        err = ml_remove(&dict->values, pos);
+        if (err != 0) return err;
+        // Every entry after pos moved down by one; fix the index in one pass, no hashing needed
+        for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+            if (index[s] > pos) {
+                index[s]--;
+            }
+        }
+        return 0;
+    }
+    if (pos != last) {
+        // The swap moves the last entry into pos, so only its slot needs patching
+        index[_compact_slot_of(dict, last, _dict_hash(dict, _dict_key_at(dict, last)))] = pos;
+    }
+    IErr err = ml_remove_swap(&dict->keys, pos);
+    if (err != 0) return err;
+    return ml_remove_swap(&dict->values, pos);
+}
+
+m_Dict* md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init(dict, keysize, valuesize, itemcap, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_hashed(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_hashed(dict, keysize, valuesize, itemcap, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_swiss(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_swiss(dict, keysize, valuesize, itemcap, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_robinhood(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_robinhood(dict, keysize, valuesize, itemcap, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_compact(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_compact(dict, keysize, valuesize, itemcap, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_sorted(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_sorted(dict, keysize, valuesize, itemcap, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+m_Dict* md_create_str(I32 valuesize, I32 itemcap) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = md_init_str(dict, valuesize, itemcap);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+// Frees the storage of a dict without freeing the dict itself
+static Void _dict_release(m_Dict* dict) {
+    md_clear(dict);
+    ml_setcap(&dict->keys, 0);
+    ml_setcap(&dict->values, 0);
+    mb_setcap(&dict->slots, 0);
+    mb_setcap(&dict->arena.buffer, 0);
+}
+
+Void md_destroy(m_Dict* dict) {
+    if (!dict) {
+        return;
+    }
+    _dict_release(dict);
+    m_free(dict);
+}
+
+IErr md_init(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    IErr err = ml_init(&dict->keys, keysize, itemcap, comparer);
+    if (err != 0) {
+        return err;
+    }
+    err = ml_init(&dict->values, valuesize, itemcap, NULL);
+    if (err != 0) {
+        ml_setcap(&dict->keys, 0);
+        return err;
+    }
+    dict->mode = M_DICT_LINEAR;
+    dict->hasher = NULL;
+    dict->seed = 0;
+    memset(&dict->slots, 0, sizeof(dict->slots));
+    memset(&dict->arena, 0, sizeof(dict->arena));
+    dict->used = 0;
+    dict->maxload = M_DICT_DEFAULT_MAXLOAD;
+    dict->old = NULL;
+    dict->cleared = 0;
+    dict->migrated = 0;
+    dict->migratestart = 0;
+    dict->rehashbudget = 0;
+    return 0;  // Success
+}
+
+IErr md_init_hashed(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    return _table_init(dict, keysize, valuesize, itemcap, hasher, comparer, M_DICT_HASHED);
+}
+
+IErr md_init_swiss(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    return _table_init(dict, keysize, valuesize, itemcap, hasher, comparer, M_DICT_SWISS);
+}
+
+IErr md_init_robinhood(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    return _table_init(dict, keysize, valuesize, itemcap, hasher, comparer, M_DICT_ROBINHOOD);
+}
+
+IErr md_init_str(m_Dict* dict, I32 valuesize, I32 itemcap) {
+    IErr err = _table_init(dict, sizeof(I32), valuesize, itemcap, NULL, NULL, M_DICT_STRING);
+    if (err != 0) {
+        return err;
+    }
+    err = mb_init(&dict->arena.buffer, 1, m_max(256, itemcap * 32));
+    if (err != 0) {
+        ml_setcap(&dict->keys, 0);
+        ml_setcap(&dict->values, 0);
+        mb_setcap(&dict->slots, 0);
+        return err;
+    }
+    return 0;  // Success
+}
+
+IErr md_init_compact(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    IErr err = md_init(dict, keysize, valuesize, itemcap, comparer);
+    if (err != 0) {
+        return err;
+    }
+    dict->keys.comparer = comparer;
+    dict->mode = M_DICT_COMPACT;
+    dict->hasher = hasher ? hasher : m_hasher_for_size(keysize);
+    err = _compact_reindex(dict, _table_slotcap(itemcap, dict->maxload));
+    if (err != 0) {
+        ml_setcap(&dict->keys, 0);
+        ml_setcap(&dict->values, 0);
+        return err;
+    }
+    return 0;  // Success
+}
+
+IErr md_init_sorted(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer) {
+    IErr err = md_init(dict, keysize, valuesize, itemcap, comparer);
+    if (err != 0) {
+        return err;
+    }
+    dict->keys.comparer = comparer;
+    dict->mode = M_DICT_SORTED;
+    return 0;  // Success
+}
+
+IErr md_setcap(m_Dict* dict, I32 newcap) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (_dict_is_table(dict)) {
+        _rehash_finish(dict);
+        I32 slotcap = _table_slotcap(m_max(newcap, dict->keys.count), dict->maxload);
+        return slotcap != dict->slots.itemcap ? _table_rehash(dict, slotcap) : 0;
+    }
+    IErr err = ml_setcap(&dict->keys, newcap);
+    if (err != 0) {
+        return err;
+    }
+    err = ml_setcap(&dict->values, newcap);
+    if (err != 0) {
+        return err;
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        I32 slotcap = _table_slotcap(dict->keys.count, dict->maxload);
+        return _compact_reindex(dict, m_max(slotcap, _table_slotcap(newcap, dict->maxload)));
+    }
+    return 0;  // Success
+}
+
+Void* md_get(m_Dict* dict, Void* key) {
+    if (dict->mode == M_DICT_STRING) {
+        _StrKeyQuery query = _strkey_query(dict, (CStr)key);
+        I32 slot = _table_find(dict, &query, query.hash);
+        return (slot >= 0) ? _dict_value_at(dict, slot) : NULL;
+    }
+    if (_dict_is_table(dict)) {
+        return _table_get(dict, key, _dict_hash(dict, key));
+    }
+    if (dict->mode == M_DICT_SORTED) {
+        I32 index = _sorted_find(dict, key);
+        return (index >= 0) ? _dict_value_at(dict, index) : NULL;
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        I32 slot = _compact_find(dict, key, _dict_hash(dict, key));
+        return (slot >= 0) ? _dict_value_at(dict, ((I32*)dict->slots.data)[slot]) : NULL;
+    }
+    I32 index = ml_find(&dict->keys, key);
+    return (index >= 0) ? ml_get(&dict->values, index) : NULL;
+}
+
+IErr md_put(m_Dict* dict, Void* key, Void* value) {
+    if (dict->mode == M_DICT_STRING) {
+        return _strkey_put(dict, (CStr)key, value);
+    }
+    if (_dict_is_table(dict)) {
+        return _table_put(dict, key, value, _dict_hash(dict, key));
+    }
+    if (dict->mode == M_DICT_SORTED) {
+        return _sorted_put(dict, key, value);
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        return _compact_put(dict, key, value);
+    }
+    I32 index = ml_find(&dict->keys, key);
+    if (index >= 0) {
+        return ml_put(&dict->values, index, value);
+    }
+    IErr err = ml_push(&dict->keys, key);
+    if (err != 0) return err;
+    err = ml_push(&dict->values, value);
+    if (err != 0) {
+        ml_remove(&dict->keys, ml_count(&dict->keys) - 1);
+        return err;
+    }
+    return 0; // Success
+}
+
+Bool md_has(m_Dict* dict, Void* key) {
+    if (dict->mode == M_DICT_STRING) {
+        _StrKeyQuery query = _strkey_query(dict, (CStr)key);
+        return _table_find(dict, &query, query.hash) >= 0;
+    }
+    if (_dict_is_table(dict)) {
+        I32 slot;
+        return _table_locate(dict, key, _dict_hash(dict, key), &slot) != null;
+    }
+    if (dict->mode == M_DICT_SORTED) {
+        return _sorted_find(dict, key) >= 0;
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        return _compact_find(dict, key, _dict_hash(dict, key)) >= 0;
+    }
+    return ml_find(&dict->keys, key) >= 0;
+}
+
+IErr md_remove(m_Dict* dict, Void* key) {
+    if (dict->mode == M_DICT_STRING) {
+        _StrKeyQuery query = _strkey_query(dict, (CStr)key);
+        _table_remove(dict, &query, query.hash);
+        return 0;
+    }
+    if (_dict_is_table(dict)) {
+        _table_remove(dict, key, _dict_hash(dict, key));
+        return 0;
+    }
+    if (dict->mode == M_DICT_SORTED) {
+        return md_remove_ordered(dict, key);  // A swap would break the key order
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        return _compact_remove(dict, key, false);
+    }
+    I32 index = ml_find(&dict->keys, key);
+    if (index >= 0) {
+        IErr err = ml_remove_swap(&dict->keys, index);
+        if (err != 0) return err;
+        return ml_remove_swap(&dict->values, index);
+    }
+    return 0; // No key found, still success
+}
+
+IErr md_remove_ordered(m_Dict* dict, Void* key) {
+    if (dict->mode == M_DICT_STRING) {
+        return md_remove(dict, key);
+    }
+    if (_dict_is_table(dict)) {
+        _table_remove(dict, key, _dict_hash(dict, key));  // Slot order is not insertion order anyway
+        return 0;
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        return _compact_remove(dict, key, true);
+    }
+    I32 index = dict->mode == M_DICT_SORTED ? _sorted_find(dict, key) : ml_find(&dict->keys, key);
+    if (index >= 0) {
+        IErr err = ml_remove(&dict->keys, index);
+        if (err != 0) return err;
+        return ml_remove(&dict->values, index);
+    }
+    return 0; // No key found, still success
+}
+
+IErr md_build_sorted(m_Dict* dict, Void* keys, Void* values, I32 n) {
+    if (!dict || (n > 0 && (!keys || !values))) {
+        return M_ERR_NULL_POINTER;
+    }
+    I32 keysize = dict->keys.buffer.itemsize;
+    I32 valuesize = dict->values.buffer.itemsize;
+    if (dict->mode != M_DICT_SORTED) {
+        for (I32 i = 0; i < n; ++i) {
+            IErr err = md_put(dict, (U8*)keys + (Sz)i * keysize, (U8*)values + (Sz)i * valuesize);
+            if (err != 0) return err;
+        }
+        return 0;
+    }
+    if (n <= 0) {
+        return 0;
+    }
+
+    // Sort (key, value) records once, then merge them into the existing keys in a single pass
+    I32 recsize = _record_size(keysize, valuesize);
+    U8* records = (U8*)m_alloc((Sz)n * recsize * 2);
+    if (!records) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    for (I32 i = 0; i < n; ++i) {
+        memcpy(records + (Sz)i * recsize, (U8*)keys + (Sz)i * keysize, keysize);
+        memcpy(records + (Sz)i * recsize + keysize, (U8*)values + (Sz)i * valuesize, valuesize);
+    }
+    U8* sorted = _sort_records(dict, records, records + (Sz)n * recsize, n, recsize);
+
+    // The sort is stable, so the last record of a run of equal keys is the latest value
+    I32 unique = 0;
+    for (I32 i = 0; i < n; ++i) {
+        if (i + 1 < n && _dict_keys_compare(dict, sorted + (Sz)i * recsize, sorted + (Sz)(i + 1) * recsize) == 0) {
+            continue;
+        }
+        memmove(sorted + (Sz)unique++ * recsize, sorted + (Sz)i * recsize, recsize);
+    }
+    IErr err = _sorted_merge(dict, sorted, unique);
+    m_free(records);
+    return err;
+}
+
+I32 md_lower_bound(m_Dict* dict, Void* key) {
+    return dict->mode == M_DICT_SORTED ? _sorted_bound(dict, key, false) : -1;
+}
+
+I32 md_upper_bound(m_Dict* dict, Void* key) {
+    return dict->mode == M_DICT_SORTED ? _sorted_bound(dict, key, true) : -1;
+}
+
+// Probe length of a live slot: 1 when the key sits in its home slot (or home group for swiss)
+static I32 _table_probelen(m_Dict* dict, I32 slot) {
+    U32 mask = (U32)dict->slots.itemcap - 1;
+    if (dict->mode == M_DICT_ROBINHOOD) {
+        return (I32)_rh_dist(((U32*)dict->slots.data)[slot], (U32)slot, mask) + 1;
+    }
+    U64 hash = _dict_hash(dict, _dict_key_at(dict, slot));
+    if (dict->mode == M_DICT_SWISS || dict->mode == M_DICT_STRING) {
+        U32 groupmask = (U32)(dict->slots.itemcap / M_GROUP_WIDTH) - 1;
+        U32 g = (U32)(hash >> 7) & groupmask;
+        I32 probes = 1;
+        for (U32 step = 1; g != (U32)slot / M_GROUP_WIDTH; g = (g + step++) & groupmask) {
+            probes++;
+        }
+        return probes;
+    }
+    return (I32)(((U32)slot - (U32)hash) & mask) + 1;
+}
+
+IErr md_stats(m_Dict* dict, m_DictStats* stats) {
+    if (!dict || !stats) {
+        return M_ERR_NULL_POINTER;
+    }
+    _rehash_finish(dict);   // Probe lengths are only meaningful for one settled table
+    memset(stats, 0, sizeof(*stats));
+    stats->count = md_count(dict);
+    if (dict->mode == M_DICT_COMPACT) {
+        stats->slots = dict->slots.itemcap;
+        stats->deleted = dict->used - dict->keys.count;
+        I64 total = 0;
+        for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+            I32 pos = ((I32*)dict->slots.data)[s];
+            if (pos < 0) {
+                continue;
+            }
+            U64 hash = _dict_hash(dict, _dict_key_at(dict, pos));
+            I32 probes = (I32)(((U32)s - (U32)hash) & (U32)(dict->slots.itemcap - 1)) + 1;
+            total += probes;
+            stats->maxprobe = m_max(stats->maxprobe, probes);
+            stats->probehist[m_min(probes, M_PROBE_HIST_SIZE) - 1]++;
+        }
+        stats->meanprobe = stats->count ? (F64)total / stats->count : 0;
+        return 0;
+    }
+    if (!_dict_is_table(dict)) {
+        stats->slots = dict->keys.buffer.itemcap;
+        return 0;
+    }
+    stats->slots = dict->slots.itemcap;
+    stats->deleted = dict->used - dict->keys.count;
+    I64 total = 0;
+    for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+        if (!_table_live(dict, s)) {
+            continue;
+        }
+        I32 probes = _table_probelen(dict, s);
+        total += probes;
+        stats->maxprobe = m_max(stats->maxprobe, probes);
+        stats->probehist[m_min(probes, M_PROBE_HIST_SIZE) - 1]++;
+    }
+    stats->meanprobe = stats->count ? (F64)total / stats->count : 0;
+    return 0;  // Success
+}
+
+Void md_clear(m_Dict* dict) {
+    if (dict->old) {
+        _rehash_drop(dict);
+    }
+    ml_clear(&dict->keys);
+    ml_clear(&dict->values);
+    if (dict->slots.data) {
+        I32 fill = dict->mode == M_DICT_COMPACT ? 0xff : 0;   // Compact index slots start at M_INDEX_EMPTY
+        memset(dict->slots.data, fill, dict->slots.itemcap * dict->slots.itemsize);
+    }
+    dict->used = 0;
+    dict->arena.length = 0;
+}
+
+I32 md_count(m_Dict* dict) {
+    return dict->keys.count + (dict->old ? dict->old->keys.count : 0);
+}
+
+IErr md_setrehashbudget(m_Dict* dict, I32 budget) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (dict->mode != M_DICT_HASHED && dict->mode != M_DICT_SWISS && dict->mode != M_DICT_ROBINHOOD) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    // At least a group per operation, so the old table drains before new keys can fill the new one
+    dict->rehashbudget = budget > 0 ? m_max(budget, M_GROUP_WIDTH) : 0;
+    if (dict->rehashbudget == 0) {
+        _rehash_finish(dict);
+    }
+    return 0;  // Success
+}
+
+Bool md_rehash_step(m_Dict* dict, I32 slots) {
+    _rehash_step(dict, slots);
+    return dict->old != NULL;
+}
+
+IErr md_setseed(m_Dict* dict, U64 seed) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    _rehash_finish(dict);
+    dict->seed = seed;
+    if (dict->mode == M_DICT_STRING) {
+        for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+            if (_table_live(dict, s)) {
+                _StrKeyHeader* header = _strkey_at(dict, _dict_key_at(dict, s));
+                header->hash = m_hash_bytes((Void*)_strkey_str(header), header->length, seed);
+            }
+        }
+    }
+    // Existing entries sit where the old seed put them
+    if (_dict_is_table(dict) && dict->keys.count > 0) {
+        return _table_rehash(dict, dict->slots.itemcap);
+    }
+    if (dict->mode == M_DICT_COMPACT) {
+        return _compact_reindex(dict, dict->slots.itemcap);
+    }
+    return 0;  // Success
+}
+
+Bool md_iter(m_Dict* dict, I32* pos, Void** key, Void** value) {
+    I32 slot = *pos;
+    m_Dict* owner = dict;
+    I32 index = slot;
+    if (_dict_is_table(dict)) {
+        // Positions past the table walk the undrained part of an incremental resize
+        I32 cap = dict->slots.itemcap;
+        I32 end = cap + (dict->old ? dict->old->slots.itemcap : 0);
+        if (slot < cap && !_rehash_ready(dict)) {
+            slot = cap;
+        }
+        while (slot < end && !(slot < cap ? _table_live(dict, slot)
+                                          : _table_live(dict->old, slot - cap) && !_rehash_drained(dict, slot - cap))) {
+            slot++;
+        }
+        if (slot >= end) {
+            *pos = slot;
+            return false;
+        }
+        owner = slot < cap ? dict : dict->old;
+        index = slot < cap ? slot : slot - cap;
+    } else if (slot >= dict->keys.count) {
+        return false;
+    }
+    if (key) *key = dict->mode == M_DICT_STRING ? (Void*)_strkey_str(_strkey_at(dict, _dict_key_at(dict, index)))
+                                                : _dict_key_at(owner, index);
+    if (value) *value = _dict_value_at(owner, index);
+    *pos = slot + 1;
+    return true;
+}
+
+// Batched dictionary functions
+// Table modes hash a chunk of keys up front and prefetch each key's home slot, so the cache misses of the
+// whole chunk overlap instead of being paid one key at a time. The linear mode sorts the batch once and
+// resolves it in a single scan of the stored keys; the sorted mode merges it against the key order.
+#define M_BATCH_CHUNK 16
+
+static Void _table_prefetch(m_Dict* dict, U64 hash) {
+    if (dict->slots.itemcap == 0) {
+        return;
+    }
+    I32 slot;
+    if (dict->mode == M_DICT_SWISS || dict->mode == M_DICT_STRING) {
+        slot = (I32)((U32)(hash >> 7) & (U32)(dict->slots.itemcap / M_GROUP_WIDTH - 1)) * M_GROUP_WIDTH;
+    } else {
+        slot = (I32)(hash & (U64)(dict->slots.itemcap - 1));
+    }
+    __builtin_prefetch(dict->slots.data + (Sz)slot * dict->slots.itemsize);
+    __builtin_prefetch(_dict_key_at(dict, slot));
+}
+
+// Hashes batch keys [first, first + n) and prefetches their slots. String-mode batches hold CStr
+// entries, which become queries so the probes reuse the hash.
+static Void _batch_hash(m_Dict* dict, Void* keys, I32 first, I32 n, U64* hashes, _StrKeyQuery* queries, Void** probes) {
+    for (I32 i = 0; i < n; ++i) {
+        if (dict->mode == M_DICT_STRING) {
+            queries[i] = _strkey_query(dict, ((CStr*)keys)[first + i]);
+            hashes[i] = queries[i].hash;
+            probes[i] = &queries[i];
+        } else {
+            probes[i] = (U8*)keys + (Sz)(first + i) * dict->keys.buffer.itemsize;
+            hashes[i] = _dict_hash(dict, probes[i]);
+        }
+        _table_prefetch(dict, hashes[i]);
+    }
+}
+
+static Void* _batch_key(m_Dict* dict, Void* keys, I32 i) {
+    if (dict->mode == M_DICT_STRING) {
+        return (Void*)((CStr*)keys)[i];
+    }
+    return (U8*)keys + (Sz)i * dict->keys.buffer.itemsize;
+}
+
+// The single-scan path orders the batch with the comparer, or by key bytes when the dict was created without one
+static Bool _batch_scannable(m_Dict* dict) {
+    return dict->mode == M_DICT_LINEAR || dict->mode == M_DICT_SORTED;
+}
+
+// Stable sort of (key, batch index) records; the result lives inside *memory, which the caller frees
+static U8* _batch_sort(m_Dict* dict, Void* keys, I32 n, U8** memory) {
+    I32 keysize = dict->keys.buffer.itemsize;
+    I32 recsize = _record_size(keysize, (I32)sizeof(I32));
+    *memory = (U8*)m_alloc((Sz)n * recsize * 2);
+    if (!*memory) {
+        return null;
+    }
+    for (I32 i = 0; i < n; ++i) {
+        memcpy(*memory + (Sz)i * recsize, (U8*)keys + (Sz)i * keysize, keysize);
+        memcpy(*memory + (Sz)i * recsize + keysize, &i, sizeof(I32));
+    }
+    return _sort_records(dict, *memory, *memory + (Sz)n * recsize, n, recsize);
+}
+
+static I32 _batch_index(m_Dict* dict, U8* sorted, I32 j) {
+    I32 index;
+    I32 keysize = dict->keys.buffer.itemsize;
+    memcpy(&index, sorted + (Sz)j * _record_size(keysize, (I32)sizeof(I32)) + keysize, sizeof(I32));
+    return index;
+}
+
+// First record of the run of batch keys equal to key, or -1
+static I32 _batch_find(m_Dict* dict, U8* sorted, I32 n, Void* key) {
+    Sz recsize = _record_size(dict->keys.buffer.itemsize, (I32)sizeof(I32));
+    I32 lo = 0;
+    I32 hi = n;
+    while (lo < hi) {
+        I32 mid = lo + (hi - lo) / 2;
+        if (_dict_keys_compare(dict, sorted + mid * recsize, key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < n && _dict_keys_compare(dict, sorted + lo * recsize, key) == 0) ? lo : -1;
+}
+
+// Resolves a batch into values and/or found flags; returns the number of keys found
+static I32 _batch_get(m_Dict* dict, Void* keys, I32 n, Void** values, Bool* found) {
+    I32 hits = 0;
+    if (_dict_is_table(dict)) {
+        U64 hashes[M_BATCH_CHUNK];
+        _StrKeyQuery queries[M_BATCH_CHUNK];
+        Void* probes[M_BATCH_CHUNK];
+        for (I32 first = 0; first < n; first += M_BATCH_CHUNK) {
+            I32 count = m_min(M_BATCH_CHUNK, n - first);
+            _batch_hash(dict, keys, first, count, hashes, queries, probes);
+            for (I32 i = 0; i < count; ++i) {
+                I32 slot;
+                m_Dict* owner = _table_locate(dict, probes[i], hashes[i], &slot);
+                if (values) values[first + i] = owner ? _dict_value_at(owner, slot) : NULL;
+                if (found) found[first + i] = owner != null;
+                hits += owner != null;
+            }
+        }
+        return hits;
+    }
+
+    U8* memory = null;
+    U8* sorted = (dict->mode == M_DICT_LINEAR && _batch_scannable(dict)) ? _batch_sort(dict, keys, n, &memory) : null;
+    if (!sorted) {
+        // Sorted dicts binary search each key anyway; linear ones only land here if the batch copy failed
+        for (I32 i = 0; i < n; ++i) {
+            Void* value = md_get(dict, _batch_key(dict, keys, i));
+            if (values) values[i] = value;
+            if (found) found[i] = value != NULL;
+            hits += value != NULL;
+        }
+        m_free(memory);
+        return hits;
+    }
+    if (values) memset(values, 0, sizeof(Void*) * n);
+    if (found) memset(found, 0, sizeof(Bool) * n);
+    Sz recsize = _record_size(dict->keys.buffer.itemsize, (I32)sizeof(I32));
+    for (I32 s = 0; s < dict->keys.count; ++s) {
+        Void* key = _dict_key_at(dict, s);
+        I32 j = _batch_find(dict, sorted, n, key);
+        for (; j >= 0 && j < n && _dict_keys_compare(dict, sorted + j * recsize, key) == 0; ++j) {
+            I32 index = _batch_index(dict, sorted, j);
+            if (values) values[index] = _dict_value_at(dict, s);
+            if (found) found[index] = true;
+            hits++;
+        }
+    }
+    m_free(memory);
+    return hits;
+}
+
+I32 md_get_many(m_Dict* dict, Void* keys, Void** values, I32 n) {
+    if (!dict || !values || n <= 0 || !keys) {
+        return 0;
+    }
+    return _batch_get(dict, keys, n, values, NULL);
+}
+
+I32 md_has_many(m_Dict* dict, Void* keys, Bool* found, I32 n) {
+    if (!dict || n <= 0 || !keys) {
+        return 0;
+    }
+    return _batch_get(dict, keys, n, NULL, found);
+}
+
+IErr md_put_many(m_Dict* dict, Void* keys, Void* values, I32 n) {
+    if (!dict || (n > 0 && (!keys || !values))) {
+        return M_ERR_NULL_POINTER;
+    }
+    I32 valuesize = dict->values.buffer.itemsize;
+    if (dict->mode == M_DICT_SORTED) {
+        return md_build_sorted(dict, keys, values, n);
+    }
+    if (dict->mode == M_DICT_HASHED || dict->mode == M_DICT_SWISS || dict->mode == M_DICT_ROBINHOOD) {
+        U64 hashes[M_BATCH_CHUNK];
+        Void* probes[M_BATCH_CHUNK];
+        for (I32 first = 0; first < n; first += M_BATCH_CHUNK) {
+            I32 count = m_min(M_BATCH_CHUNK, n - first);
+            _batch_hash(dict, keys, first, count, hashes, NULL, probes);
+            for (I32 i = 0; i < count; ++i) {
+                IErr err = _table_put(dict, probes[i], (U8*)values + (Sz)(first + i) * valuesize, hashes[i]);
+                if (err != 0) return err;
+            }
+        }
+        return 0;
+    }
+    if (dict->mode == M_DICT_STRING || !_batch_scannable(dict) || n <= 0) {
+        for (I32 i = 0; i < n; ++i) {
+            IErr err = md_put(dict, _batch_key(dict, keys, i), (U8*)values + (Sz)i * valuesize);
+            if (err != 0) return err;
+        }
+        return 0;
+    }
+
+    // Linear: update the keys already present during one scan, then append the new ones
+    U8* memory;
+    U8* sorted = _batch_sort(dict, keys, n, &memory);
+    if (!sorted) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    I32 keysize = dict->keys.buffer.itemsize;
+    Sz recsize = _record_size(keysize, (I32)sizeof(I32));
+    for (I32 s = 0; s < dict->keys.count; ++s) {
+        I32 j = _batch_find(dict, sorted, n, _dict_key_at(dict, s));
+        if (j < 0) {
+            continue;
+        }
+        while (j + 1 < n && _dict_keys_compare(dict, sorted + j * recsize, sorted + (j + 1) * recsize) == 0) {
+            j++;  // The sort is stable, so the last of a run is the latest value
+        }
+        memcpy(_dict_value_at(dict, s), (U8*)values + (Sz)_batch_index(dict, sorted, j) * valuesize, valuesize);
+        I32 done = -1;
+        memcpy(sorted + j * recsize + keysize, &done, sizeof(I32));
+    }
+    IErr err = 0;
+    for (I32 j = 0; j < n && err == 0; ++j) {
+        if (j + 1 < n && _dict_keys_compare(dict, sorted + j * recsize, sorted + (j + 1) * recsize) == 0) {
+            continue;
+        }
+        I32 index = _batch_index(dict, sorted, j);
+        if (index >= 0) {
+            err = ml_push(&dict->keys, sorted + j * recsize);
+            if (err == 0) {
+                err = ml_push(&dict->values, (U8*)values + (Sz)index * valuesize);
+                if (err != 0) ml_remove(&dict->keys, ml_count(&dict->keys) - 1);
+            }
+        }
+    }
+    m_free(memory);
+    return err;
+}
+
+IErr md_remove_many(m_Dict* dict, Void* keys, I32 n) {
+    if (!dict || (n > 0 && !keys)) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (_dict_is_table(dict)) {
+        U64 hashes[M_BATCH_CHUNK];
+        _StrKeyQuery queries[M_BATCH_CHUNK];
+        Void* probes[M_BATCH_CHUNK];
+        for (I32 first = 0; first < n; first += M_BATCH_CHUNK) {
+            I32 count = m_min(M_BATCH_CHUNK, n - first);
+            _batch_hash(dict, keys, first, count, hashes, queries, probes);
+            for (I32 i = 0; i < count; ++i) {
+                _table_remove(dict, probes[i], hashes[i]);
+            }
+        }
+        return 0;
+    }
+    U8* memory = null;
+    U8* sorted = (_batch_scannable(dict) && n > 0) ? _batch_sort(dict, keys, n, &memory) : null;
+    if (!sorted) {
+        for (I32 i = 0; i < n; ++i) {
+            IErr err = md_remove(dict, _batch_key(dict, keys, i));
+            if (err != 0) {
+                m_free(memory);
+                return err;
+            }
+        }
+        m_free(memory);
+        return 0;
+    }
+    if (dict->mode == M_DICT_SORTED) {
+        // Both sides are ordered, so one merge pass compacts the survivors in place
+        Sz recsize = _record_size(dict->keys.buffer.itemsize, (I32)sizeof(I32));
+        I32 keysize = dict->keys.buffer.itemsize;
+        I32 valuesize = dict->values.buffer.itemsize;
+        I32 kept = 0;
+        I32 j = 0;
+        for (I32 s = 0; s < dict->keys.count; ++s) {
+            Void* key = _dict_key_at(dict, s);
+            I32 cmp = 1;
+            while (j < n && (cmp = _dict_keys_compare(dict, sorted + j * recsize, key)) < 0) {
+                j++;
+            }
+            if (j < n && cmp == 0) {
+                continue;
+            }
+            if (kept != s) {
+                memcpy(_dict_key_at(dict, kept), key, keysize);
+                memcpy(_dict_value_at(dict, kept), _dict_value_at(dict, s), valuesize);
+            }
+            kept++;
+        }
+        dict->keys.count = kept;
+        dict->values.count = kept;
+    } else {
+        // Walking backwards, every entry swapped into a freed index has already been checked
+        for (I32 s = dict->keys.count - 1; s >= 0; --s) {
+            if (_batch_find(dict, sorted, n, _dict_key_at(dict, s)) >= 0) {
+                ml_remove_swap(&dict->keys, s);
+                ml_remove_swap(&dict->values, s);
+            }
+        }
+    }
+    m_free(memory);
+    return 0;
+}
+
+// Hash functions
+// wyhash (final version 4, public domain): one 64x64->128 multiply per 16 input bytes.
+// The fixed-width hashers are the same function with the length folded in, so they agree with m_hash_bytes.
+static const U64 _wyp0 = 0xa0761d6478bd642full;
+static const U64 _wyp1 = 0xe7037ed1a0b428dbull;
+static const U64 _wyp2 = 0x8ebc6af09c88c6e3ull;
+static const U64 _wyp3 = 0x589965cc75374cc3ull;
+
+// Full 64x64 -> 128 bit product: low half into *a, high half into *b
+static inline Void _wymum(U64* a, U64* b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (U64)r;
+    *b = (U64)(r >> 64);
+#else
+    // Targets without a 128-bit type (32-bit, MSVC) sum the four 32x32 partial products, as wyhash does
+    U64 ha = *a >> 32, hb = *b >> 32, la = (U32)*a, lb = (U32)*b;
+    U64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    U64 t = rl + (rm0 << 32);
+    U64 carry = t < rl;
+    U64 lo = t + (rm1 << 32);
+    carry += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+static inline U64 _wymix(U64 a, U64 b) {
+    _wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline U64 _wyr8(const U8* p) {
+    U64 v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline U64 _wyr4(const U8* p) {
+    U32 v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline U64 _wyfinish(U64 a, U64 b, U64 seed, Sz len) {
+    a ^= _wyp1;
+    b ^= seed;
+    _wymum(&a, &b);
+    return _wymix(a ^ _wyp0 ^ len, b ^ _wyp1);
+}
+
+static inline U64 _wyseed(U64 seed) {
+    return seed ^ _wymix(seed ^ _wyp0, _wyp1);
+}
+
+static U64 _wyhash(const U8* p, Sz len, U64 seed) {
+    seed = _wyseed(seed);
+    U64 a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (_wyr4(p) << 32) | _wyr4(p + ((len >> 3) << 2));
+            b = (_wyr4(p + len - 4) << 32) | _wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((U64)p[0] << 16) | ((U64)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        Sz i = len;
+        if (i > 48) {
+            U64 see1 = seed, see2 = seed;
+            do {
+                seed = _wymix(_wyr8(p) ^ _wyp1, _wyr8(p + 8) ^ seed);
+                see1 = _wymix(_wyr8(p + 16) ^ _wyp2, _wyr8(p + 24) ^ see1);
+                see2 = _wymix(_wyr8(p + 32) ^ _wyp3, _wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = _wymix(_wyr8(p) ^ _wyp1, _wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = _wyr8(p + i - 16);
+        b = _wyr8(p + i - 8);
+    }
+    return _wyfinish(a, b, seed, len);
+}
+
+U64 m_hash_bytes(Void* item, I32 itemsize, U64 seed) {
+    return _wyhash((const U8*)item, (Sz)itemsize, seed);
+}
+
+U64 m_hash_u32(Void* item, I32 itemsize, U64 seed) {
+    U64 x = _wyr4((const U8*)item);
+    U64 ab = (x << 32) | x;
+    return _wyfinish(ab, ab, _wyseed(seed), 4);
+}
+
+U64 m_hash_u64(Void* item, I32 itemsize, U64 seed) {
+    const U8* p = (const U8*)item;
+    U64 lo = _wyr4(p), hi = _wyr4(p + 4);
+    return _wyfinish((lo << 32) | hi, (hi << 32) | lo, _wyseed(seed), 8);
+}
+
+U64 m_hash_u128(Void* item, I32 itemsize, U64 seed) {
+    const U8* p = (const U8*)item;
+    return _wyfinish((_wyr4(p) << 32) | _wyr4(p + 8), (_wyr4(p + 12) << 32) | _wyr4(p + 4), _wyseed(seed), 16);
+}
+
+U64 m_hash_str(Void* item, I32 itemsize, U64 seed) {
+    CStr str = *(CStr*)item;
+    return _wyhash((const U8*)str, strlen(str), seed);
+}
+
+m_ItemHasher m_hasher_for_size(I32 itemsize) {
+    switch (itemsize) {
+        case 4:  return m_hash_u32;
+        case 8:  return m_hash_u64;
+        case 16: return m_hash_u128;
+        default: return m_hash_bytes;
+    }
+}
+
+I32 m_compare_str(Void* item1, Void* item2) {
+    return strcmp(*(CStr*)item1, *(CStr*)item2);
+}
+
+// Set functions
+// A swiss table with a zero value size, so no value array is ever allocated or copied
+m_Set* mset_create(I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Set* set = (m_Set*)m_alloc(sizeof(m_Set));
+    if (!set) {
+        return null;
+    }
+    IErr err = mset_init(set, keysize, itemcap, hasher, comparer);
+    if (err != 0) {
+        m_free(set);
+        return null;
+    }
+    return set;
+}
+
+Void mset_destroy(m_Set* set) {
+    if (!set) {
+        return;
+    }
+    _dict_release(&set->dict);
+    m_free(set);
+}
+
+IErr mset_init(m_Set* set, I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!set) {
+        return M_ERR_NULL_POINTER;
+    }
+    return _table_init(&set->dict, keysize, 0, itemcap, hasher, comparer, M_DICT_SWISS);
+}
+
+Void mset_clear(m_Set* set) {
+    md_clear(&set->dict);
+}
+
+IErr mset_add(m_Set* set, Void* key) {
+    return _table_put(&set->dict, key, NULL, _dict_hash(&set->dict, key));
+}
+
+Bool mset_has(m_Set* set, Void* key) {
+    return md_has(&set->dict, key);
+}
+
+IErr mset_remove(m_Set* set, Void* key) {
+    return md_remove(&set->dict, key);
+}
+
+I32 mset_count(m_Set* set) {
+    return md_count(&set->dict);
+}
+
+Bool mset_iter(m_Set* set, I32* pos, Void** key) {
+    return md_iter(&set->dict, pos, key, NULL);
+}
+
+// Set algebra walks slot arrays directly. Swiss removals only retag slots, so removing while walking is safe.
+static Void _set_filter(m_Set* set, m_Set* other, Bool keep) {
+    m_Dict* dict = &set->dict;
+    _rehash_finish(dict);
+    for (I32 s = 0; s < dict->slots.itemcap; ++s) {
+        if (_table_live(dict, s) && mset_has(other, _dict_key_at(dict, s)) != keep) {
+            _swiss_release(dict, s);
+            dict->keys.count--;
+            dict->values.count--;
+        }
+    }
+}
+
+IErr mset_union(m_Set* set, m_Set* other) {
+    if (!set || !other) {
+        return M_ERR_NULL_POINTER;
+    }
+    IErr err = 0;
+    I32 total = mset_count(set) + mset_count(other);
+    if (_table_slotcap(total, set->dict.maxload) > set->dict.slots.itemcap) {
+        err = md_setcap(&set->dict, total);
+    }
+    I32 pos = 0;
+    Void* key;
+    while (err == 0 && mset_iter(other, &pos, &key)) {
+        err = mset_add(set, key);
+    }
+    return err;
+}
+
+IErr mset_intersect(m_Set* set, m_Set* other) {
+    if (!set || !other) {
+        return M_ERR_NULL_POINTER;
+    }
+    _set_filter(set, other, true);
+    return 0;  // Success
+}
+
+IErr mset_difference(m_Set* set, m_Set* other) {
+    if (!set || !other) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (set == other) {
+        mset_clear(set);
+        return 0;  // Success
+    }
+    // Probe from whichever side is smaller
+    if (mset_count(other) < mset_count(set)) {
+        I32 pos = 0;
+        Void* key;
+        while (mset_iter(other, &pos, &key)) {
+            mset_remove(set, key);
+        }
+    } else {
+        _set_filter(set, other, false);
+    }
+    return 0;  // Success
+}
+
+// Cache functions
+// Entries live densely in fixed buffers sized at init and an index maps keys to entries. Eviction reuses
+// the victim's entry in place and removal moves the last entry into the hole, so a full cache never allocates.
+static Void _cache_release(m_Cache* cache) {
+    _dict_release(&cache->index);
+    mb_setcap(&cache->keys, 0);
+    mb_setcap(&cache->values, 0);
+    mb_setcap(&cache->links, 0);
+    mb_setcap(&cache->marks, 0);
+}
+
+static Void _cache_reset(m_Cache* cache) {
+    cache->count = 0;
+    cache->head = -1;
+    cache->tail = -1;
+    cache->hand = cache->policy == M_CACHE_CLOCK ? 0 : -1;
+}
+
+static I32* _cache_link(m_Cache* cache, I32 entry) {
+    return (I32*)cache->links.data + (Sz)entry * 2;   // [0] toward head, [1] toward tail
+}
+
+static Void _cache_unlink(m_Cache* cache, I32 entry) {
+    I32* link = _cache_link(cache, entry);
+    if (link[0] >= 0) _cache_link(cache, link[0])[1] = link[1]; else cache->head = link[1];
+    if (link[1] >= 0) _cache_link(cache, link[1])[0] = link[0]; else cache->tail = link[0];
+}
+
+static Void _cache_push(m_Cache* cache, I32 entry) {
+    I32* link = _cache_link(cache, entry);
+    link[0] = -1;
+    link[1] = cache->head;
+    if (cache->head >= 0) _cache_link(cache, cache->head)[0] = entry; else cache->tail = entry;
+    cache->head = entry;
+}
+
+static Void _cache_touch(m_Cache* cache, I32 entry) {
+    if (cache->policy == M_CACHE_LRU) {
+        if (cache->head != entry) {
+            _cache_unlink(cache, entry);
+            _cache_push(cache, entry);
+        }
+    } else {
+        cache->marks.data[entry] = 1;
+    }
+}
+
+static I32 _cache_victim(m_Cache* cache) {
+    U8* marks = cache->marks.data;
+    switch (cache->policy) {
+        case M_CACHE_LRU:
+            return cache->tail;
+        case M_CACHE_CLOCK: {
+            I32 hand = cache->hand;
+            while (marks[hand]) {
+                marks[hand] = 0;
+                hand = hand + 1 < cache->count ? hand + 1 : 0;
+            }
+            cache->hand = hand + 1 < cache->count ? hand + 1 : 0;
+            return hand;
+        }
+        default: {
+            // SIEVE walks from the oldest entry toward the newest and wraps back to the tail
+            I32 hand = cache->hand >= 0 ? cache->hand : cache->tail;
+            while (marks[hand]) {
+                marks[hand] = 0;
+                hand = _cache_link(cache, hand)[0] >= 0 ? _cache_link(cache, hand)[0] : cache->tail;
+            }
+            cache->hand = _cache_link(cache, hand)[0];
+            return hand;
+        }
+    }
+}
+
+static Void* _cache_key(m_Cache* cache, I32 entry) {
+    return cache->keys.data + (Sz)entry * cache->keys.itemsize;
+}
+
+static Void* _cache_value(m_Cache* cache, I32 entry) {
+    return cache->values.data + (Sz)entry * cache->values.itemsize;
+}
+
+static Void _cache_drop(m_Cache* cache, I32 entry) {
+    if (cache->evictor) {
+        cache->evictor(_cache_key(cache, entry), _cache_value(cache, entry), cache->context);
+    }
+    md_remove(&cache->index, _cache_key(cache, entry));
+    if (cache->policy != M_CACHE_CLOCK) {
+        if (cache->hand == entry) {
+            cache->hand = _cache_link(cache, entry)[0];
+        }
+        _cache_unlink(cache, entry);
+    }
+    I32 last = --cache->count;
+    if (entry != last) {
+        memcpy(_cache_key(cache, entry), _cache_key(cache, last), cache->keys.itemsize);
+        memcpy(_cache_value(cache, entry), _cache_value(cache, last), cache->values.itemsize);
+        cache->marks.data[entry] = cache->marks.data[last];
+        if (cache->policy != M_CACHE_CLOCK) {
+            I32* link = _cache_link(cache, entry);
+            memcpy(link, _cache_link(cache, last), sizeof(I32) * 2);
+            if (link[0] >= 0) _cache_link(cache, link[0])[1] = entry; else cache->head = entry;
+            if (link[1] >= 0) _cache_link(cache, link[1])[0] = entry; else cache->tail = entry;
+        }
+        if (cache->hand == last) {
+            cache->hand = entry;
+        }
+        *(I32*)md_get(&cache->index, _cache_key(cache, entry)) = entry;
+    }
+    if (cache->policy == M_CACHE_CLOCK && cache->hand >= cache->count) {
+        cache->hand = 0;
+    }
+}
+
+m_Cache* mcache_create(I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_Cache* cache = (m_Cache*)m_alloc(sizeof(m_Cache));
+    if (!cache) {
+        return null;
+    }
+    IErr err = mcache_init(cache, keysize, valuesize, cap, policy, hasher, comparer);
+    if (err != 0) {
+        m_free(cache);
+        return null;
+    }
+    return cache;
+}
+
+Void mcache_destroy(m_Cache* cache) {
+    if (!cache) {
+        return;
+    }
+    mcache_clear(cache);
+    _cache_release(cache);
+    m_free(cache);
+}
+
+IErr mcache_init(m_Cache* cache, I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!cache) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (cap < 1) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    memset(cache, 0, sizeof(m_Cache));
+    cache->cap = cap;
+    cache->policy = policy;
+    _cache_reset(cache);
+    // The index is sized for the full capacity up front and Robin Hood deletes never leave tombstones to purge
+    IErr err = md_init_robinhood(&cache->index, keysize, sizeof(I32), cap, hasher, comparer);
+    if (err == 0) err = mb_init(&cache->keys, keysize, cap);
+    if (err == 0) err = mb_init(&cache->values, valuesize, cap);
+    if (err == 0) err = mb_init(&cache->marks, 1, cap);
+    if (err == 0 && policy != M_CACHE_CLOCK) err = mb_init(&cache->links, sizeof(I32) * 2, cap);
+    if (err != 0) {
+        _cache_release(cache);
+    }
+    return err;
+}
+
+Void mcache_setevictor(m_Cache* cache, m_CacheEvictor evictor, Void* context) {
+    cache->evictor = evictor;
+    cache->context = context;
+}
+
+Void mcache_clear(m_Cache* cache) {
+    if (cache->evictor) {
+        for (I32 i = 0; i < cache->count; ++i) {
+            cache->evictor(_cache_key(cache, i), _cache_value(cache, i), cache->context);
+        }
+    }
+    md_clear(&cache->index);
+    _cache_reset(cache);
+}
+
+Void* mcache_get(m_Cache* cache, Void* key) {
+    I32* entry = (I32*)md_get(&cache->index, key);
+    if (!entry) {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+    _cache_touch(cache, *entry);
+    return _cache_value(cache, *entry);
+}
+
+IErr mcache_put(m_Cache* cache, Void* key, Void* value) {
+    I32* found = (I32*)md_get(&cache->index, key);
+    if (found) {
+        I32 entry = *found;
+        if (cache->evictor) {
+            cache->evictor(_cache_key(cache, entry), _cache_value(cache, entry), cache->context);
+        }
+        memcpy(_cache_value(cache, entry), value, cache->values.itemsize);
+        _cache_touch(cache, entry);
+        return 0;  // Success
+    }
+    I32 entry;
+    if (cache->count < cache->cap) {
+        entry = cache->count++;
+        if (cache->policy != M_CACHE_CLOCK) {
+            _cache_push(cache, entry);
+        }
+    } else {
+        entry = _cache_victim(cache);
+        cache->evictions++;
+        if (cache->evictor) {
+            cache->evictor(_cache_key(cache, entry), _cache_value(cache, entry), cache->context);
+        }
+        md_remove(&cache->index, _cache_key(cache, entry));
+        if (cache->policy != M_CACHE_CLOCK) {
+            _cache_unlink(cache, entry);
+            _cache_push(cache, entry);
+        }
+    }
+    cache->marks.data[entry] = 0;
+    memcpy(_cache_key(cache, entry), key, cache->keys.itemsize);
+    memcpy(_cache_value(cache, entry), value, cache->values.itemsize);
+    return md_put(&cache->index, key, &entry);
+}
+
+Bool mcache_has(m_Cache* cache, Void* key) {
+    return md_has(&cache->index, key);
+}
+
+IErr mcache_remove(m_Cache* cache, Void* key) {
+    I32* entry = (I32*)md_get(&cache->index, key);
+    if (entry) {
+        _cache_drop(cache, *entry);
+    }
+    return 0;  // Success
+}
+
+I32 mcache_count(m_Cache* cache) {
+    return cache->count;
+}
+
+// Filter functions
+// Bloom mode maps a key to one 32-byte block and sets one bit in each of its eight words, so a test touches a single
+// cache line and compares the block against the mask in two SSE2 registers. Cuckoo mode keeps a 16-bit fingerprint in
+// one of two buckets of four, found again by XOR with a hash of the fingerprint, which is what lets it remove keys.
+#define M_FILTER_MAGIC      0x544c464du     // "MFLT" little endian
+#define M_FILTER_VERSION    1u
+#define M_FILTER_KICKS      500
+
+typedef struct _FilterHeader {
+    U32 magic;
+    U32 version;
+    I32 mode;
+    I32 keysize;
+    I32 count;
+    I32 blockcount;
+    I32 victim;
+    U32 victimtag;
+    U64 seed;
+    U64 size;
+} _FilterHeader;
+
+static const U32 _bloom_salts[8] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+// e^-x for the small arguments the sizing needs, as (1 - x/1024)^1024, which keeps libm out of the library
+static F64 _filter_exp_neg(F64 x) {
+    F64 y = 1.0 - x / 1024.0;
+    for (I32 i = 0; i < 10; ++i) {
+        y *= y;
+    }
+    return y;
+}
+
+static I32 _bloom_blockcount(I32 itemcap, F64 fpr) {
+    // Smallest bits per key whose classic k = 8 estimate meets the target, plus a fifth for the skew blocking adds
+    F64 bits = 4.0;
+    while (bits < 64.0) {
+        F64 miss = 1.0 - _filter_exp_neg(8.0 / bits);
+        F64 rate = miss * miss;
+        rate *= rate;
+        if (rate * rate <= fpr) {
+            break;
+        }
+        bits += 0.25;
+    }
+    F64 total = (F64)m_max(itemcap, 1) * bits * 1.2;
+    return m_max((I32)(total / 256.0) + 1, 1);
+}
+
+static Void _bloom_mask(U32 x, U32 mask[8]) {
+    for (I32 i = 0; i < 8; ++i) {
+        mask[i] = 1u << ((x * _bloom_salts[i]) >> 27);
+    }
+}
+
+static U32* _bloom_block(m_Filter* filter, U64 hash) {
+    U32 block = (U32)(((hash >> 32) * (U64)(U32)filter->blockcount) >> 32);
+    return (U32*)filter->blocks.data + (Sz)block * 8;
+}
+
+static Bool _bloom_test(U32* words, U32 mask[8]) {
+#ifdef M_SSE2
+    __m128i lo = _mm_andnot_si128(_mm_loadu_si128((__m128i*)words), _mm_loadu_si128((__m128i*)mask));
+    __m128i hi = _mm_andnot_si128(_mm_loadu_si128((__m128i*)(words + 4)), _mm_loadu_si128((__m128i*)(mask + 4)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(lo, hi), _mm_setzero_si128())) == 0xffff;
+#else
+    U32 missing = 0;
+    for (I32 i = 0; i < 8; ++i) {
+        missing |= mask[i] & ~words[i];
+    }
+    return missing == 0;
+#endif
+}
+
+static U32 _cuckoo_tag(U64 hash) {
+    U32 tag = (U32)(hash >> 48);
+    return tag ? tag : 1;   // Zero marks an empty lane
+}
+
+static U32 _cuckoo_alt(m_Filter* filter, U32 bucket, U32 tag) {
+    return (bucket ^ (tag * 0x5bd1e995u)) & (U32)(filter->blockcount - 1);
+}
+
+static U16* _cuckoo_bucket(m_Filter* filter, U32 bucket) {
+    return (U16*)filter->blocks.data + (Sz)bucket * 4;
+}
+
+// Lanes of a four-tag bucket equal to tag, as the high bit of each U16 lane. The word is built so lane i sits in
+// bits 16i..16i+15 on any host byte order, so ctz >> 4 is the lane; little-endian compilers fold it to one load.
+static U64 _cuckoo_match(U16* lanes, U32 tag) {
+    U64 word = (U64)lanes[0] | (U64)lanes[1] << 16 | (U64)lanes[2] << 32 | (U64)lanes[3] << 48;
+    U64 x = word ^ (tag * 0x0001000100010001ull);
+    return (x - 0x0001000100010001ull) & ~x & 0x8000800080008000ull;
+}
+
+static Bool _cuckoo_place(m_Filter* filter, U32 bucket, U32 tag) {
+    U64 empty = _cuckoo_match(_cuckoo_bucket(filter, bucket), 0);
+    if (!empty) {
+        return false;
+    }
+    _cuckoo_bucket(filter, bucket)[__builtin_ctzll(empty) >> 4] = (U16)tag;
+    return true;
+}
+
+static Void _cuckoo_insert(m_Filter* filter, U32 bucket, U32 tag) {
+    if (_cuckoo_place(filter, bucket, tag)) {
+        return;
+    }
+    bucket = _cuckoo_alt(filter, bucket, tag);
+    for (U32 kick = 0; kick < M_FILTER_KICKS; ++kick) {
+        if (_cuckoo_place(filter, bucket, tag)) {
+            return;
+        }
+        // Swap with a resident fingerprint and move it to its other bucket
+        U16* lanes = _cuckoo_bucket(filter, bucket);
+        U32 lane = (kick ^ tag) & 3;
+        U32 evicted = lanes[lane];
+        lanes[lane] = (U16)tag;
+        tag = evicted;
+        bucket = _cuckoo_alt(filter, bucket, tag);
+    }
+    filter->victim = (I32)bucket;
+    filter->victimtag = tag;
+}
+
+static Void _filter_reset(m_Filter* filter) {
+    if (filter->blocks.data) {
+        memset(filter->blocks.data, 0, (Sz)filter->blocks.itemsize * filter->blocks.itemcap);
+    }
+    filter->count = 0;
+    filter->victim = -1;
+    filter->victimtag = 0;
+}
+
+m_Filter* mfilter_create(m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher) {
+    m_Filter* filter = (m_Filter*)m_alloc(sizeof(m_Filter));
+    if (!filter) {
+        return null;
+    }
+    IErr err = mfilter_init(filter, mode, keysize, itemcap, fpr, hasher);
+    if (err != 0) {
+        m_free(filter);
+        return null;
+    }
+    return filter;
+}
+
+Void mfilter_destroy(m_Filter* filter) {
+    if (!filter) {
+        return;
+    }
+    mb_setcap(&filter->blocks, 0);
+    m_free(filter);
+}
+
+IErr mfilter_init(m_Filter* filter, m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher) {
+    if (!filter) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (keysize <= 0 || itemcap < 0 || !(fpr > 0.0 && fpr < 1.0)) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    filter->mode = mode;
+    filter->keysize = keysize;
+    filter->hasher = hasher ? hasher : m_hasher_for_size(keysize);
+    filter->seed = 0x9e3779b97f4a7c15ull;
+    if (mode == M_FILTER_BLOOM) {
+        filter->blockcount = _bloom_blockcount(itemcap, fpr);
+    } else {
+        // Fingerprints are 16 bits, about 8 / 65536 false positives at full load; buckets are kept 95% full at most
+        I32 buckets = 2;
+        while ((I64)buckets * 4 * 95 < (I64)itemcap * 100) {
+            buckets *= 2;
+        }
+        filter->blockcount = buckets;
+    }
+    filter->count = 0;
+    filter->victim = -1;
+    filter->victimtag = 0;
+    return mb_init(&filter->blocks, mode == M_FILTER_BLOOM ? 32 : 8, filter->blockcount);
+}
+
+Void mfilter_clear(m_Filter* filter) {
+    _filter_reset(filter);
+}
+
+IErr mfilter_add(m_Filter* filter, Void* key) {
+    U64 hash = filter->hasher(key, filter->keysize, filter->seed);
+    if (filter->mode == M_FILTER_BLOOM) {
+        U32 mask[8];
+        _bloom_mask((U32)hash, mask);
+        U32* words = _bloom_block(filter, hash);
+        for (I32 i = 0; i < 8; ++i) {
+            words[i] |= mask[i];
+        }
+    } else {
+        if (filter->victim >= 0) {
+            return M_ERR_OUT_OF_BOUNDS;   // Full: the last insert already ran out of kicks
+        }
+        _cuckoo_insert(filter, (U32)hash & (U32)(filter->blockcount - 1), _cuckoo_tag(hash));
+    }
+    filter->count++;
+    return 0;  // Success
+}
+
+Bool mfilter_test(m_Filter* filter, Void* key) {
+    U64 hash = filter->hasher(key, filter->keysize, filter->seed);
+    if (filter->mode == M_FILTER_BLOOM) {
+        U32 mask[8];
+        _bloom_mask((U32)hash, mask);
+        return _bloom_test(_bloom_block(filter, hash), mask);
+    }
+    U32 tag = _cuckoo_tag(hash);
+    U32 first = (U32)hash & (U32)(filter->blockcount - 1);
+    U32 second = _cuckoo_alt(filter, first, tag);
+    if (_cuckoo_match(_cuckoo_bucket(filter, first), tag) || _cuckoo_match(_cuckoo_bucket(filter, second), tag)) {
+        return true;
+    }
+    return filter->victim >= 0 && filter->victimtag == tag
+        && ((U32)filter->victim == first || (U32)filter->victim == second);
+}
+
+IErr mfilter_remove(m_Filter* filter, Void* key) {
+    if (filter->mode == M_FILTER_BLOOM) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    U64 hash = filter->hasher(key, filter->keysize, filter->seed);
+    U32 tag = _cuckoo_tag(hash);
+    U32 first = (U32)hash & (U32)(filter->blockcount - 1);
+    U32 buckets[2] = {first, _cuckoo_alt(filter, first, tag)};
+    for (I32 i = 0; i < 2; ++i) {
+        U64 match = _cuckoo_match(_cuckoo_bucket(filter, buckets[i]), tag);
+        if (match) {
+            _cuckoo_bucket(filter, buckets[i])[__builtin_ctzll(match) >> 4] = 0;
+            filter->count--;
+            if (filter->victim >= 0) {
+                // The freed lane may give the stranded fingerprint a home again
+                U32 victim = (U32)filter->victim;
+                filter->victim = -1;
+                _cuckoo_insert(filter, victim, filter->victimtag);
+            }
+            return 0;  // Success
+        }
+    }
+    if (filter->victim >= 0 && filter->victimtag == tag && ((U32)filter->victim == buckets[0] || (U32)filter->victim == buckets[1])) {
+        filter->victim = -1;
+        filter->count--;
+    }
+    return 0;  // Success
+}
+
+IErr mfilter_save(m_Filter* filter, m_Buffer* out) {
+    if (!filter || !out) {
+        return M_ERR_NULL_POINTER;
+    }
+    Sz bytes = (Sz)filter->blocks.itemsize * filter->blockcount;
+    Sz total = sizeof(_FilterHeader) + bytes;
+    I32 itemsize = m_max(out->itemsize, 1);
+    IErr err = mb_setcap(out, (I32)((total + itemsize - 1) / itemsize));
+    if (err != 0) {
+        return err;
+    }
+    _FilterHeader* header = (_FilterHeader*)out->data;
+    header->magic = M_FILTER_MAGIC;
+    header->version = M_FILTER_VERSION;
+    header->mode = filter->mode;
+    header->keysize = filter->keysize;
+    header->count = filter->count;
+    header->blockcount = filter->blockcount;
+    header->victim = filter->victim;
+    header->victimtag = filter->victimtag;
+    header->seed = filter->seed;
+    header->size = total;
+    memcpy(out->data + sizeof(_FilterHeader), filter->blocks.data, bytes);
+    return 0;  // Success
+}
+
+IErr mfilter_load(m_Filter* filter, Void* data, Sz size, m_ItemHasher hasher) {
+    if (!filter || !data) {
+        return M_ERR_NULL_POINTER;
+    }
+    _FilterHeader header;
+    if (size < sizeof(_FilterHeader)) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    memcpy(&header, data, sizeof(_FilterHeader));
+    if (header.magic != M_FILTER_MAGIC || header.version != M_FILTER_VERSION || header.keysize <= 0
+        || header.blockcount <= 0 || (header.mode != M_FILTER_BLOOM && header.mode != M_FILTER_CUCKOO)
+        || (header.mode == M_FILTER_CUCKOO && (header.blockcount & (header.blockcount - 1)) != 0)
+        || header.count < 0 || header.victim < -1 || header.victim >= header.blockcount) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    I32 itemsize = header.mode == M_FILTER_BLOOM ? 32 : 8;
+    if (header.size != sizeof(_FilterHeader) + (Sz)itemsize * header.blockcount || size < header.size) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    IErr err = mb_init(&filter->blocks, itemsize, header.blockcount);
+    if (err != 0) {
+        return err;
+    }
+    memcpy(filter->blocks.data, (U8*)data + sizeof(_FilterHeader), (Sz)itemsize * header.blockcount);
+    filter->mode = (m_FilterMode)header.mode;
+    filter->keysize = header.keysize;
+    filter->count = header.count;
+    filter->blockcount = header.blockcount;
+    filter->victim = header.victim;
+    filter->victimtag = header.victimtag;
+    filter->seed = header.seed;
+    filter->hasher = hasher ? hasher : m_hasher_for_size(header.keysize);
+    return 0;  // Success
+}
+
+// B-tree functions
+// A B+ tree: entries live in leaves linked left to right for cursors, inner nodes hold separators where child i
+// covers [key i-1, key i). Nodes have room for one key past the order so inserts can overflow and then split.
+typedef struct _BTreeNode {
+    I32 count;
+    Bool leaf;
+    struct _BTreeNode* next;    // right sibling, leaves only
+} _BTreeNode;
+
+static U8* _bt_key(m_BTree* tree, _BTreeNode* node, I32 i) {
+    return (U8*)(node + 1) + (Sz)i * tree->keysize;
+}
+
+// Children or values start after the key array, rounded up to 8 bytes
+static Sz _bt_tailoffset(m_BTree* tree) {
+    return sizeof(_BTreeNode) + (((Sz)(tree->order + 1) * tree->keysize + 7) & ~(Sz)7);
+}
+
+static U8* _bt_tail(m_BTree* tree, _BTreeNode* node) {
+    return (U8*)node + _bt_tailoffset(tree);
+}
+
+static U8* _bt_value(m_BTree* tree, _BTreeNode* node, I32 i) {
+    return _bt_tail(tree, node) + (Sz)i * tree->valuesize;
+}
+
+static _BTreeNode** _bt_children(m_BTree* tree, _BTreeNode* node) {
+    return (_BTreeNode**)_bt_tail(tree, node);
+}
+
+static I32 _bt_min(m_BTree* tree, _BTreeNode* node) {
+    return node->leaf ? tree->order / 2 : (tree->order - 1) / 2;
+}
+
+static _BTreeNode* _bt_node(m_BTree* tree, Bool leaf) {
+    Sz tail = leaf ? (Sz)(tree->order + 1) * tree->valuesize : (Sz)(tree->order + 2) * sizeof(_BTreeNode*);
+    _BTreeNode* node = (_BTreeNode*)m_alloc(_bt_tailoffset(tree) + tail);
+    if (node) {
+        node->count = 0;
+        node->leaf = leaf;
+        node->next = NULL;
+    }
+    return node;
+}
+
+static I32 _bt_free(m_BTree* tree, _BTreeNode* node) {
+    I32 count = node->count;
+    if (!node->leaf) {
+        count = 0;
+        for (I32 i = 0; i <= node->count; ++i) {
+            count += _bt_free(tree, _bt_children(tree, node)[i]);
+        }
+    }
+    m_free(node);
+    return count;
+}
+
+// First index whose key is above (upper) or at least (lower) the given key
+static I32 _bt_search(m_BTree* tree, _BTreeNode* node, Void* key, Bool upper) {
+    I32 lo = 0, hi = node->count;
+    while (lo < hi) {
+        I32 mid = (lo + hi) >> 1;
+        I32 cmp = tree->comparer(_bt_key(tree, node, mid), key);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static _BTreeNode* _bt_leaf(m_BTree* tree, Void* key) {
+    _BTreeNode* node = (_BTreeNode*)tree->root;
+    while (node && !node->leaf) {
+        node = _bt_children(tree, node)[key ? _bt_search(tree, node, key, true) : 0];
+    }
+    return node;
+}
+
+static Void _bt_shift(U8* base, I32 size, I32 from, I32 count, I32 by) {
+    memmove(base + (Sz)(from + by) * size, base + (Sz)from * size, (Sz)(count - from) * size);
+}
+
+// Splits an overflowing node, leaving its right half in *right and the separator in tree->scratch
+static IErr _bt_split(m_BTree* tree, _BTreeNode* node, _BTreeNode** right) {
+    _BTreeNode* sibling = _bt_node(tree, node->leaf);
+    if (!sibling) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    I32 half = node->count / 2;
+    if (node->leaf) {
+        sibling->count = node->count - half;
+        memcpy(_bt_key(tree, sibling, 0), _bt_key(tree, node, half), (Sz)sibling->count * tree->keysize);
+        memcpy(_bt_value(tree, sibling, 0), _bt_value(tree, node, half), (Sz)sibling->count * tree->valuesize);
+        memcpy(tree->scratch, _bt_key(tree, sibling, 0), tree->keysize);
+        sibling->next = node->next;
+        node->next = sibling;
+    } else {
+        // The middle key moves up rather than being copied
+        sibling->count = node->count - half - 1;
+        memcpy(tree->scratch, _bt_key(tree, node, half), tree->keysize);
+        memcpy(_bt_key(tree, sibling, 0), _bt_key(tree, node, half + 1), (Sz)sibling->count * tree->keysize);
+        memcpy(_bt_children(tree, sibling), _bt_children(tree, node) + half + 1, (Sz)(sibling->count + 1) * sizeof(_BTreeNode*));
+    }
+    node->count = half;
+    *right = sibling;
+    return 0;  // Success
+}
+
+static IErr _bt_insert(m_BTree* tree, _BTreeNode* node, Void* key, Void* value, _BTreeNode** right) {
+    *right = NULL;
+    if (node->leaf) {
+        I32 i = _bt_search(tree, node, key, false);
+        if (i < node->count && tree->comparer(_bt_key(tree, node, i), key) == 0) {
+            memcpy(_bt_value(tree, node, i), value, tree->valuesize);
+            return 0;  // Success
+        }
+        _bt_shift(_bt_key(tree, node, 0), tree->keysize, i, node->count, 1);
+        _bt_shift(_bt_value(tree, node, 0), tree->valuesize, i, node->count, 1);
+        memcpy(_bt_key(tree, node, i), key, tree->keysize);
+        memcpy(_bt_value(tree, node, i), value, tree->valuesize);
+        node->count++;
+        tree->count++;
+    } else {
+        I32 i = _bt_search(tree, node, key, true);
+        _BTreeNode* child;
+        IErr err = _bt_insert(tree, _bt_children(tree, node)[i], key, value, &child);
+        if (err != 0 || !child) {
+            return err;
+        }
+        _bt_shift(_bt_key(tree, node, 0), tree->keysize, i, node->count, 1);
+        _bt_shift((U8*)_bt_children(tree, node), sizeof(_BTreeNode*), i + 1, node->count + 1, 1);
+        memcpy(_bt_key(tree, node, i), tree->scratch, tree->keysize);
+        _bt_children(tree, node)[i + 1] = child;
+        node->count++;
+    }
+    return node->count > tree->order ? _bt_split(tree, node, right) : 0;
+}
+
+static Bool _bt_short(m_BTree* tree, _BTreeNode* node) {
+    return node->count < _bt_min(tree, node);
+}
+
+static Void _bt_fix(m_BTree* tree, _BTreeNode* parent, I32 i);
+
+// Moves entries between children j and j + 1 so both are half full, or merges them when they fit in one node
+static Void _bt_balance(m_BTree* tree, _BTreeNode* parent, I32 j) {
+    _BTreeNode** children = _bt_children(tree, parent);
+    _BTreeNode* left = children[j];
+    _BTreeNode* right = children[j + 1];
+    U8* sep = _bt_key(tree, parent, j);
+    I32 ks = tree->keysize;
+    if (left->leaf) {
+        I32 vs = tree->valuesize;
+        I32 total = left->count + right->count;
+        I32 k = total <= tree->order ? right->count : total / 2 - left->count;
+        if (k > 0) {
+            memcpy(_bt_key(tree, left, left->count), _bt_key(tree, right, 0), (Sz)k * ks);
+            memcpy(_bt_value(tree, left, left->count), _bt_value(tree, right, 0), (Sz)k * vs);
+            _bt_shift(_bt_key(tree, right, 0), ks, k, right->count, -k);
+            _bt_shift(_bt_value(tree, right, 0), vs, k, right->count, -k);
+        } else if (k < 0) {
+            k = -k;
+            _bt_shift(_bt_key(tree, right, 0), ks, 0, right->count, k);
+            _bt_shift(_bt_value(tree, right, 0), vs, 0, right->count, k);
+            memcpy(_bt_key(tree, right, 0), _bt_key(tree, left, left->count - k), (Sz)k * ks);
+            memcpy(_bt_value(tree, right, 0), _bt_value(tree, left, left->count - k), (Sz)k * vs);
+            k = -k;
+        }
+        left->count += k;
+        right->count -= k;
+        if (right->count == 0) {
+            left->next = right->next;
+        } else {
+            memcpy(sep, _bt_key(tree, right, 0), ks);
+        }
+    } else {
+        // The separator joins the sequence: left keys, separator, right keys
+        I32 total = left->count + right->count + 1;
+        I32 leftcount = left->count;
+        Bool leftlone = left->count == 0, rightlone = right->count == 0;
+        _BTreeNode** lc = _bt_children(tree, left);
+        _BTreeNode** rc = _bt_children(tree, right);
+        I32 k = total <= tree->order ? right->count + 1 : total / 2 - left->count;
+        if (k > 0) {
+            memcpy(_bt_key(tree, left, left->count), sep, ks);
+            memcpy(_bt_key(tree, left, left->count + 1), _bt_key(tree, right, 0), (Sz)(k - 1) * ks);
+            memcpy(lc + left->count + 1, rc, (Sz)k * sizeof(_BTreeNode*));
+            if (k <= right->count) {
+                memcpy(sep, _bt_key(tree, right, k - 1), ks);
+                _bt_shift(_bt_key(tree, right, 0), ks, k, right->count, -k);
+            }
+            _bt_shift((U8*)rc, sizeof(_BTreeNode*), k, right->count + 1, -k);
+            left->count += k;
+            right->count -= k;
+        } else if (k < 0) {
+            k = -k;
+            _bt_shift(_bt_key(tree, right, 0), ks, 0, right->count, k);
+            _bt_shift((U8*)rc, sizeof(_BTreeNode*), 0, right->count + 1, k);
+            memcpy(_bt_key(tree, right, k - 1), sep, ks);
+            memcpy(_bt_key(tree, right, 0), _bt_key(tree, left, left->count - k + 1), (Sz)(k - 1) * ks);
+            memcpy(sep, _bt_key(tree, left, left->count - k), ks);
+            memcpy(rc, lc + left->count - k + 1, (Sz)k * sizeof(_BTreeNode*));
+            left->count -= k;
+            right->count += k;
+        }
+        // A range delete can leave a node whose only child is still short; fix that child where it landed
+        if (leftlone) {
+            _bt_fix(tree, left, 0);
+        }
+        if (rightlone) {
+            if (right->count < 0) _bt_fix(tree, left, leftcount + 1); else _bt_fix(tree, right, right->count);
+        }
+    }
+    if (right->count < 0 || (right->leaf && right->count == 0)) {
+        // Merged: drop the right node and its separator
+        m_free(right);
+        _bt_shift(_bt_key(tree, parent, 0), ks, j + 1, parent->count, -1);
+        _bt_shift((U8*)children, sizeof(_BTreeNode*), j + 2, parent->count + 1, -1);
+        parent->count--;
+    }
+}
+
+static Void _bt_fix(m_BTree* tree, _BTreeNode* parent, I32 i) {
+    // Fixing a lone grandchild can shrink either half again, so repeat until both sides hold; every repeat merges
+    while (parent->count > 0 && i <= parent->count && _bt_short(tree, _bt_children(tree, parent)[i])) {
+        I32 j = i < parent->count ? i : i - 1;
+        _bt_balance(tree, parent, j);
+        i = (j + 1 <= parent->count && !_bt_short(tree, _bt_children(tree, parent)[j])) ? j + 1 : j;
+    }
+}
+
+// Removes the entries in [lo, hi), or [lo, hi] when inclusive, NULL bounds being open. Children wholly inside the
+// range are freed without visiting their entries one by one, then the two boundary children are rebalanced.
+static I32 _bt_remove(m_BTree* tree, _BTreeNode* node, Void* lo, Void* hi, Bool inclusive) {
+    I32 a = lo ? _bt_search(tree, node, lo, !node->leaf) : 0;
+    I32 b = hi ? _bt_search(tree, node, hi, inclusive) : node->count;
+    if (node->leaf) {
+        if (b <= a) {
+            return 0;
+        }
+        _bt_shift(_bt_key(tree, node, 0), tree->keysize, b, node->count, a - b);
+        _bt_shift(_bt_value(tree, node, 0), tree->valuesize, b, node->count, a - b);
+        node->count -= b - a;
+        return b - a;
+    }
+    if (b < a) {
+        return 0;
+    }
+    _BTreeNode** children = _bt_children(tree, node);
+    I32 removed = _bt_remove(tree, children[a], lo, hi, inclusive);
+    if (b > a) {
+        removed += _bt_remove(tree, children[b], lo, hi, inclusive);
+        for (I32 i = a + 1; i < b; ++i) {
+            removed += _bt_free(tree, children[i]);
+        }
+        _BTreeNode* last = children[a];
+        while (!last->leaf) {
+            last = _bt_children(tree, last)[last->count];
+        }
+        _BTreeNode* first = children[b];
+        while (!first->leaf) {
+            first = _bt_children(tree, first)[0];
+        }
+        last->next = first;
+        // Child b keeps the separator just below it
+        _bt_shift(_bt_key(tree, node, 0), tree->keysize, b - 1, node->count, a - b + 1);
+        _bt_shift((U8*)children, sizeof(_BTreeNode*), b, node->count + 1, a - b + 1);
+        node->count -= b - a - 1;
+        _bt_fix(tree, node, a + 1);
+    }
+    _bt_fix(tree, node, a);
+    return removed;
+}
+
+static Void _bt_collapse(m_BTree* tree) {
+    _BTreeNode* root = (_BTreeNode*)tree->root;
+    while (root && !root->leaf && root->count == 0) {
+        tree->root = _bt_children(tree, root)[0];
+        m_free(root);
+        root = (_BTreeNode*)tree->root;
+    }
+    if (root && root->leaf && root->count == 0) {
+        m_free(root);
+        tree->root = NULL;
+    }
+}
+
+m_BTree* mbt_create(I32 keysize, I32 valuesize, m_ItemComparer comparer) {
+    m_BTree* tree = (m_BTree*)m_alloc(sizeof(m_BTree));
+    if (!tree) {
+        return null;
+    }
+    IErr err = mbt_init(tree, keysize, valuesize, comparer);
+    if (err != 0) {
+        m_free(tree);
+        return null;
+    }
+    return tree;
+}
+
+Void mbt_destroy(m_BTree* tree) {
+    if (!tree) {
+        return;
+    }
+    mbt_clear(tree);
+    m_free(tree->scratch);
+    m_free(tree);
+}
+
+IErr mbt_init(m_BTree* tree, I32 keysize, I32 valuesize, m_ItemComparer comparer) {
+    if (!tree || !comparer) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (keysize <= 0 || valuesize < 0) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    tree->scratch = (U8*)m_alloc(keysize);
+    if (!tree->scratch) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    tree->root = NULL;
+    tree->keysize = keysize;
+    tree->valuesize = valuesize;
+    tree->order = m_max(M_BTREE_NODE_BYTES / keysize, 4);
+    tree->count = 0;
+    tree->comparer = comparer;
+    return 0;  // Success
+}
+
+Void mbt_clear(m_BTree* tree) {
+    if (tree->root) {
+        _bt_free(tree, (_BTreeNode*)tree->root);
+    }
+    tree->root = NULL;
+    tree->count = 0;
+}
+
+// Builds the tree bottom up, spreading entries evenly so every node but the root is at least half full
+IErr mbt_load(m_BTree* tree, m_List* keys, m_List* values) {
+    if (!tree || !keys) {
+        return M_ERR_NULL_POINTER;
+    }
+    I32 n = keys->count;
+    if (keys->buffer.itemsize != tree->keysize
+        || (values && (values->count != n || values->buffer.itemsize != tree->valuesize))) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    for (I32 i = 1; i < n; ++i) {
+        if (tree->comparer(ml_get(keys, i - 1), ml_get(keys, i)) >= 0) {
+            return M_ERR_INVALID_OPERATION;   // Keys must be strictly ascending
+        }
+    }
+    mbt_clear(tree);
+    if (n == 0) {
+        return 0;  // Success
+    }
+    I32 count = (n + tree->order - 1) / tree->order;
+    _BTreeNode** nodes = (_BTreeNode**)m_alloc(sizeof(_BTreeNode*) * count);
+    if (!nodes) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    // On failure, nodes[0, built) are this level's finished nodes and nodes[start, count) the unclaimed ones below
+    IErr err = 0;
+    I32 built = 0, start = 0;
+    _BTreeNode* prev = NULL;
+    for (; built < count; ++built) {
+        _BTreeNode* leaf = _bt_node(tree, true);
+        if (!leaf) {
+            err = M_ERR_ALLOCATION_FAILED;
+            start = count;
+            break;
+        }
+        leaf->count = n / count + (built < n % count);
+        memcpy(_bt_key(tree, leaf, 0), ml_get(keys, start), (Sz)leaf->count * tree->keysize);
+        if (values) {
+            memcpy(_bt_value(tree, leaf, 0), ml_get(values, start), (Sz)leaf->count * tree->valuesize);
+        } else {
+            memset(_bt_value(tree, leaf, 0), 0, (Sz)leaf->count * tree->valuesize);
+        }
+        if (prev) prev->next = leaf;
+        prev = leaf;
+        nodes[built] = leaf;
+        start += leaf->count;
+    }
+    while (err == 0 && count > 1) {
+        I32 parents = (count + tree->order) / (tree->order + 1);
+        for (built = 0, start = 0; built < parents; ++built) {
+            _BTreeNode* node = _bt_node(tree, false);
+            if (!node) {
+                err = M_ERR_ALLOCATION_FAILED;
+                break;
+            }
+            I32 fanout = count / parents + (built < count % parents);
+            node->count = fanout - 1;
+            memcpy(_bt_children(tree, node), nodes + start, sizeof(_BTreeNode*) * fanout);
+            for (I32 c = 1; c < fanout; ++c) {
+                _BTreeNode* low = nodes[start + c];
+                while (!low->leaf) {
+                    low = _bt_children(tree, low)[0];
+                }
+                memcpy(_bt_key(tree, node, c - 1), _bt_key(tree, low, 0), tree->keysize);
+            }
+            nodes[built] = node;
+            start += fanout;
+        }
+        if (err == 0) {
+            count = parents;
+        }
+    }
+    if (err != 0) {
+        for (I32 i = 0; i < built; ++i) {
+            _bt_free(tree, nodes[i]);
+        }
+        for (I32 i = start; i < count; ++i) {
+            _bt_free(tree, nodes[i]);
+        }
+        m_free(nodes);
+        return err;
+    }
+    tree->root = nodes[0];
+    tree->count = n;
+    m_free(nodes);
+    return 0;  // Success
+}
+
+Void* mbt_get(m_BTree* tree, Void* key) {
+    _BTreeNode* leaf = _bt_leaf(tree, key);
+    if (!leaf) {
+        return NULL;
+    }
+    I32 i = _bt_search(tree, leaf, key, false);
+    return (i < leaf->count && tree->comparer(_bt_key(tree, leaf, i), key) == 0) ? _bt_value(tree, leaf, i) : NULL;
+}
+
+IErr mbt_put(m_BTree* tree, Void* key, Void* value) {
+    if (!tree->root) {
+        tree->root = _bt_node(tree, true);
+        if (!tree->root) {
+            return M_ERR_ALLOCATION_FAILED;
+        }
+    }
+    _BTreeNode* right;
+    IErr err = _bt_insert(tree, (_BTreeNode*)tree->root, key, value, &right);
+    if (err != 0 || !right) {
+        return err;
+    }
+    _BTreeNode* root = _bt_node(tree, false);
+    if (!root) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    root->count = 1;
+    memcpy(_bt_key(tree, root, 0), tree->scratch, tree->keysize);
+    _bt_children(tree, root)[0] = (_BTreeNode*)tree->root;
+    _bt_children(tree, root)[1] = right;
+    tree->root = root;
+    return 0;  // Success
+}
+
+Bool mbt_has(m_BTree* tree, Void* key) {
+    return mbt_get(tree, key) != NULL;
+}
+
+IErr mbt_remove(m_BTree* tree, Void* key) {
+    if (tree->root) {
+        tree->count -= _bt_remove(tree, (_BTreeNode*)tree->root, key, key, true);
+        _bt_collapse(tree);
+    }
+    return 0;  // Success
+}
+
+I32 mbt_remove_range(m_BTree* tree, Void* lo, Void* hi) {
+    if (!tree->root) {
+        return 0;
+    }
+    I32 removed = _bt_remove(tree, (_BTreeNode*)tree->root, lo, hi, false);
+    tree->count -= removed;
+    _bt_collapse(tree);
+    return removed;
+}
+
+I32 mbt_count(m_BTree* tree) {
+    return tree->count;
+}
+
+static m_BTreeCursor _bt_cursor(m_BTree* tree, Void* key, Bool upper) {
+    m_BTreeCursor cursor = {tree, _bt_leaf(tree, key), 0, NULL};
+    if (cursor.node && key) {
+        cursor.index = _bt_search(tree, (_BTreeNode*)cursor.node, key, upper);
+    }
+    return cursor;
+}
+
+m_BTreeCursor mbt_lower_bound(m_BTree* tree, Void* key) {
+    return _bt_cursor(tree, key, false);
+}
+
+m_BTreeCursor mbt_upper_bound(m_BTree* tree, Void* key) {
+    return _bt_cursor(tree, key, true);
+}
+
+m_BTreeCursor mbt_range(m_BTree* tree, Void* lo, Void* hi) {
+    m_BTreeCursor cursor = _bt_cursor(tree, lo, false);
+    cursor.end = hi;
+    return cursor;
+}
+
+Bool mbt_next(m_BTreeCursor* cursor, Void** key, Void** value) {
+    _BTreeNode* leaf = (_BTreeNode*)cursor->node;
+    while (leaf && cursor->index >= leaf->count) {
+        leaf = leaf->next;
+        cursor->index = 0;
+    }
+    cursor->node = leaf;
+    if (!leaf) {
+        return false;
+    }
+    m_BTree* tree = cursor->tree;
+    U8* at = _bt_key(tree, leaf, cursor->index);
+    if (cursor->end && tree->comparer(at, cursor->end) >= 0) {
+        cursor->node = NULL;
+        return false;
+    }
+    if (key) *key = at;
+    if (value) *value = _bt_value(tree, leaf, cursor->index);
+    cursor->index++;
+    return true;
+}
+
+// Adaptive radix tree functions
+// Inner nodes grow and shrink through 4, 16, 48 and 256 children. Paths without branches are folded into a node
+// prefix, of which the first M_ART_PREFIX bytes are kept inline and the rest is read from any leaf below. A key that
+// ends inside the tree hangs off its node as a terminal leaf, so keys may be prefixes of each other. Leaf pointers
+// carry a tag in the low bit.
+#define M_ART_PREFIX    12
+
+enum { M_ART_NODE4, M_ART_NODE16, M_ART_NODE48, M_ART_NODE256 };
+
+typedef struct _ArtNode {
+    U8 type;
+    U16 count;
+    I32 prefixlen;
+    U8 prefix[M_ART_PREFIX];
+    Void* leaf;                 // tagged leaf whose key ends at this node
+} _ArtNode;
+
+typedef struct _ArtNode4 {
+    _ArtNode node;
+    U8 keys[4];
+    Void* children[4];
+} _ArtNode4;
+
+typedef struct _ArtNode16 {
+    _ArtNode node;
+    U8 keys[16];
+    Void* children[16];
+} _ArtNode16;
+
+typedef struct _ArtNode48 {
+    _ArtNode node;
+    U8 index[256];              // child slot + 1, 0 for none
+    Void* children[48];
+} _ArtNode48;
+
+typedef struct _ArtNode256 {
+    _ArtNode node;
+    Void* children[256];
+} _ArtNode256;
+
+typedef struct _ArtLeaf {
+    I32 keylen;
+    I32 reserved;               // keeps the value that follows 8-byte aligned, the key bytes come after it
+} _ArtLeaf;
+
+static Bool _art_isleaf(Void* ptr) {
+    return ((uintptr_t)ptr & 1) != 0;
+}
+
+static _ArtLeaf* _art_leaf(Void* ptr) {
+    return (_ArtLeaf*)((uintptr_t)ptr - 1);
+}
+
+static U8* _art_leafvalue(_ArtLeaf* leaf) {
+    return (U8*)(leaf + 1);
+}
+
+static Sz _art_keyoffset(m_Art* art) {
+    return sizeof(_ArtLeaf) + (((Sz)art->valuesize + 7) & ~(Sz)7);
+}
+
+static U8* _art_leafkey(m_Art* art, _ArtLeaf* leaf) {
+    return (U8*)leaf + _art_keyoffset(art);
+}
+
+static Bool _art_leafmatch(m_Art* art, _ArtLeaf* leaf, U8* key, I32 keylen) {
+    return leaf->keylen == keylen && memcmp(_art_leafkey(art, leaf), key, keylen) == 0;
+}
+
+static Void* _art_newleaf(m_Art* art, U8* key, I32 keylen, Void* value) {
+    _ArtLeaf* leaf = (_ArtLeaf*)m_alloc(_art_keyoffset(art) + keylen);
+    if (!leaf) {
+        return NULL;
+    }
+    leaf->keylen = keylen;
+    if (art->valuesize) {
+        memcpy(_art_leafvalue(leaf), value, art->valuesize);
+    }
+    memcpy(_art_leafkey(art, leaf), key, keylen);
+    return (Void*)((uintptr_t)leaf + 1);
+}
+
+static _ArtNode* _art_node(U8 type) {
+    static const Sz sizes[] = {sizeof(_ArtNode4), sizeof(_ArtNode16), sizeof(_ArtNode48), sizeof(_ArtNode256)};
+    _ArtNode* node = (_ArtNode*)m_alloc(sizes[type]);
+    if (node) {
+        memset(node, 0, sizes[type]);
+        node->type = type;
+    }
+    return node;
+}
+
+static Void _art_copyheader(_ArtNode* dest, _ArtNode* src) {
+    dest->count = src->count;
+    dest->prefixlen = src->prefixlen;
+    memcpy(dest->prefix, src->prefix, M_ART_PREFIX);
+    dest->leaf = src->leaf;
+}
+
+static Void _art_free(Void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    if (_art_isleaf(ptr)) {
+        m_free(_art_leaf(ptr));
+        return;
+    }
+    _ArtNode* node = (_ArtNode*)ptr;
+    _art_free(node->leaf);
+    switch (node->type) {
+        case M_ART_NODE4:
+            for (I32 i = 0; i < node->count; ++i) _art_free(((_ArtNode4*)node)->children[i]);
+            break;
+        case M_ART_NODE16:
+            for (I32 i = 0; i < node->count; ++i) _art_free(((_ArtNode16*)node)->children[i]);
+            break;
+        case M_ART_NODE48:
+            for (I32 i = 0; i < 48; ++i) _art_free(((_ArtNode48*)node)->children[i]);
+            break;
+        default:
+            for (I32 i = 0; i < 256; ++i) _art_free(((_ArtNode256*)node)->children[i]);
+            break;
+    }
+    m_free(node);
+}
+
+static Void** _art_child(_ArtNode* node, U8 byte) {
+    switch (node->type) {
+        case M_ART_NODE4: {
+            _ArtNode4* n = (_ArtNode4*)node;
+            for (I32 i = 0; i < node->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return NULL;
+        }
+        case M_ART_NODE16: {
+            _ArtNode16* n = (_ArtNode16*)node;
+#ifdef M_SSE2
+            __m128i hits = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte), _mm_loadu_si128((__m128i*)n->keys));
+            I32 mask = _mm_movemask_epi8(hits) & ((1 << node->count) - 1);
+            return mask ? &n->children[__builtin_ctz(mask)] : NULL;
+#else
+            for (I32 i = 0; i < node->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return NULL;
+#endif
+        }
+        case M_ART_NODE48: {
+            _ArtNode48* n = (_ArtNode48*)node;
+            return n->index[byte] ? &n->children[n->index[byte] - 1] : NULL;
+        }
+        default: {
+            _ArtNode256* n = (_ArtNode256*)node;
+            return n->children[byte] ? &n->children[byte] : NULL;
+        }
+    }
+}
+
+// Smallest child in byte order, or NULL
+static Void* _art_first(_ArtNode* node) {
+    switch (node->type) {
+        case M_ART_NODE4:  return node->count ? ((_ArtNode4*)node)->children[0] : NULL;
+        case M_ART_NODE16: return node->count ? ((_ArtNode16*)node)->children[0] : NULL;
+        case M_ART_NODE48: {
+            _ArtNode48* n = (_ArtNode48*)node;
+            for (I32 b = 0; b < 256; ++b) {
+                if (n->index[b]) return n->children[n->index[b] - 1];
+            }
+            return NULL;
+        }
+        default: {
+            _ArtNode256* n = (_ArtNode256*)node;
+            for (I32 b = 0; b < 256; ++b) {
+                if (n->children[b]) return n->children[b];
+            }
+            return NULL;
+        }
+    }
+}
+
+// Any leaf below the node serves for prefix bytes past the inline ones; the terminal leaf is the cheapest
+static _ArtLeaf* _art_anyleaf(_ArtNode* node) {
+    Void* ptr = node;
+    while (!_art_isleaf(ptr)) {
+        node = (_ArtNode*)ptr;
+        ptr = node->leaf ? node->leaf : _art_first(node);
+    }
+    return _art_leaf(ptr);
+}
+
+// Index of the first byte where the node prefix and the key from depth differ, capped at the shorter of the two
+static I32 _art_mismatch(m_Art* art, _ArtNode* node, U8* key, I32 keylen, I32 depth) {
+    I32 limit = m_min(node->prefixlen, keylen - depth);
+    I32 stored = m_min(limit, M_ART_PREFIX);
+    I32 i = 0;
+    for (; i < stored; ++i) {
+        if (node->prefix[i] != key[depth + i]) return i;
+    }
+    if (i < limit) {
+        U8* full = _art_leafkey(art, _art_anyleaf(node));
+        for (; i < limit; ++i) {
+            if (full[depth + i] != key[depth + i]) return i;
+        }
+    }
+    return i;
+}
+
+// Compares only the inline prefix bytes; lookups confirm the whole key at the leaf
+static Bool _art_prefixmatch(_ArtNode* node, U8* key, I32 keylen, I32 depth) {
+    if (depth + node->prefixlen > keylen) {
+        return false;
+    }
+    I32 stored = m_min(node->prefixlen, M_ART_PREFIX);
+    return memcmp(node->prefix, key + depth, stored) == 0;
+}
+
+static IErr _art_addchild(_ArtNode* node, Void** ref, U8 byte, Void* child);
+
+static IErr _art_grow(_ArtNode* node, Void** ref, U8 byte, Void* child) {
+    _ArtNode* bigger = _art_node(node->type + 1);
+    if (!bigger) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    _art_copyheader(bigger, node);
+    if (node->type == M_ART_NODE4) {
+        memcpy(((_ArtNode16*)bigger)->keys, ((_ArtNode4*)node)->keys, 4);
+        memcpy(((_ArtNode16*)bigger)->children, ((_ArtNode4*)node)->children, 4 * sizeof(Void*));
+    } else if (node->type == M_ART_NODE16) {
+        _ArtNode16* n = (_ArtNode16*)node;
+        for (I32 i = 0; i < 16; ++i) {
+            ((_ArtNode48*)bigger)->index[n->keys[i]] = (U8)(i + 1);
+        }
+        memcpy(((_ArtNode48*)bigger)->children, n->children, 16 * sizeof(Void*));
+    } else {
+        _ArtNode48* n = (_ArtNode48*)node;
+        for (I32 b = 0; b < 256; ++b) {
+            if (n->index[b]) ((_ArtNode256*)bigger)->children[b] = n->children[n->index[b] - 1];
+        }
+    }
+    *ref = bigger;
+    m_free(node);
+    return _art_addchild(bigger, ref, byte, child);
+}
+
+// Node4 and node16 keep their keys sorted so iteration is in byte order
+static IErr _art_addchild(_ArtNode* node, Void** ref, U8 byte, Void* child) {
+    switch (node->type) {
+        case M_ART_NODE4:
+        case M_ART_NODE16: {
+            I32 cap = node->type == M_ART_NODE4 ? 4 : 16;
+            if (node->count == cap) {
+                return _art_grow(node, ref, byte, child);
+            }
+            U8* keys = node->type == M_ART_NODE4 ? ((_ArtNode4*)node)->keys : ((_ArtNode16*)node)->keys;
+            Void** children = node->type == M_ART_NODE4 ? ((_ArtNode4*)node)->children : ((_ArtNode16*)node)->children;
+            I32 i = 0;
+            while (i < node->count && keys[i] < byte) {
+                i++;
+            }
+            memmove(keys + i + 1, keys + i, node->count - i);
+            memmove(children + i + 1, children + i, (node->count - i) * sizeof(Void*));
+            keys[i] = byte;
+            children[i] = child;
+            break;
+        }
+        case M_ART_NODE48: {
+            _ArtNode48* n = (_ArtNode48*)node;
+            if (node->count == 48) {
+                return _art_grow(node, ref, byte, child);
+            }
+            I32 slot = 0;
+            while (n->children[slot]) {
+                slot++;
+            }
+            n->children[slot] = child;
+            n->index[byte] = (U8)(slot + 1);
+            break;
+        }
+        default:
+            ((_ArtNode256*)node)->children[byte] = child;
+            break;
+    }
+    node->count++;
+    return 0;  // Success
+}
+
+// Removes a child and shrinks the node once it would fit the next size down with some slack
+static Void _art_removechild(_ArtNode* node, Void** ref, U8 byte) {
+    _ArtNode* smaller = NULL;
+    switch (node->type) {
+        case M_ART_NODE4:
+        case M_ART_NODE16: {
+            U8* keys = node->type == M_ART_NODE4 ? ((_ArtNode4*)node)->keys : ((_ArtNode16*)node)->keys;
+            Void** children = node->type == M_ART_NODE4 ? ((_ArtNode4*)node)->children : ((_ArtNode16*)node)->children;
+            I32 i = 0;
+            while (keys[i] != byte) {
+                i++;
+            }
+            memmove(keys + i, keys + i + 1, node->count - i - 1);
+            memmove(children + i, children + i + 1, (node->count - i - 1) * sizeof(Void*));
+            node->count--;
+            if (node->type == M_ART_NODE16 && node->count == 3 && (smaller = _art_node(M_ART_NODE4))) {
+                _art_copyheader(smaller, node);
+                memcpy(((_ArtNode4*)smaller)->keys, keys, 3);
+                memcpy(((_ArtNode4*)smaller)->children, children, 3 * sizeof(Void*));
+            }
+            break;
+        }
+        case M_ART_NODE48: {
+            _ArtNode48* n = (_ArtNode48*)node;
+            n->children[n->index[byte] - 1] = NULL;
+            n->index[byte] = 0;
+            node->count--;
+            if (node->count == 12 && (smaller = _art_node(M_ART_NODE16))) {
+                _art_copyheader(smaller, node);
+                I32 i = 0;
+                for (I32 b = 0; b < 256; ++b) {
+                    if (n->index[b]) {
+                        ((_ArtNode16*)smaller)->keys[i] = (U8)b;
+                        ((_ArtNode16*)smaller)->children[i++] = n->children[n->index[b] - 1];
+                    }
+                }
+            }
+            break;
+        }
+        default: {
+            _ArtNode256* n = (_ArtNode256*)node;
+            n->children[byte] = NULL;
+            node->count--;
+            if (node->count == 37 && (smaller = _art_node(M_ART_NODE48))) {
+                _art_copyheader(smaller, node);
+                I32 slot = 0;
+                for (I32 b = 0; b < 256; ++b) {
+                    if (n->children[b]) {
+                        ((_ArtNode48*)smaller)->children[slot] = n->children[b];
+                        ((_ArtNode48*)smaller)->index[b] = (U8)(++slot);
+                    }
+                }
+            }
+            break;
+        }
+    }
+    if (smaller) {
+        *ref = smaller;
+        m_free(node);
+    }
+}
+
+// A node left with no children becomes its terminal leaf; a node4 left with one child and no terminal leaf
+// folds itself into that child's prefix
+static Void _art_collapse(Void** ref) {
+    _ArtNode* node = (_ArtNode*)*ref;
+    if (node->count == 0) {
+        *ref = node->leaf;
+        m_free(node);
+        return;
+    }
+    if (node->type != M_ART_NODE4 || node->count != 1 || node->leaf) {
+        return;
+    }
+    _ArtNode4* n = (_ArtNode4*)node;
+    Void* child = n->children[0];
+    if (!_art_isleaf(child)) {
+        _ArtNode* c = (_ArtNode*)child;
+        U8 prefix[M_ART_PREFIX];
+        I32 len = m_min(node->prefixlen, M_ART_PREFIX);
+        memcpy(prefix, node->prefix, len);
+        if (len < M_ART_PREFIX) {
+            prefix[len++] = n->keys[0];
+        }
+        if (len < M_ART_PREFIX) {
+            memcpy(prefix + len, c->prefix, m_min(c->prefixlen, M_ART_PREFIX - len));
+        }
+        c->prefixlen += node->prefixlen + 1;
+        memcpy(c->prefix, prefix, M_ART_PREFIX);
+    }
+    *ref = child;
+    m_free(node);
+}
+
+static IErr _art_insert(m_Art* art, Void** ref, U8* key, I32 keylen, I32 depth, Void* value) {
+    Void* ptr = *ref;
+    if (!ptr) {
+        *ref = _art_newleaf(art, key, keylen, value);
+        if (!*ref) {
+            return M_ERR_ALLOCATION_FAILED;
+        }
+        art->count++;
+        return 0;  // Success
+    }
+    if (_art_isleaf(ptr)) {
+        _ArtLeaf* leaf = _art_leaf(ptr);
+        if (_art_leafmatch(art, leaf, key, keylen)) {
+            memcpy(_art_leafvalue(leaf), value, art->valuesize);
+            return 0;  // Success
+        }
+        // Two keys now share this spot: branch where they part, after their common bytes
+        U8* other = _art_leafkey(art, leaf);
+        I32 end = m_min(leaf->keylen, keylen);
+        I32 split = depth;
+        while (split < end && other[split] == key[split]) {
+            split++;
+        }
+        Void* fresh = _art_newleaf(art, key, keylen, value);
+        _ArtNode* node = _art_node(M_ART_NODE4);
+        if (!fresh || !node) {
+            _art_free(fresh);
+            m_free(node);
+            return M_ERR_ALLOCATION_FAILED;
+        }
+        node->prefixlen = split - depth;
+        memcpy(node->prefix, key + depth, m_min(node->prefixlen, M_ART_PREFIX));
+        *ref = node;
+        if (leaf->keylen == split) node->leaf = ptr; else _art_addchild(node, ref, other[split], ptr);
+        if (keylen == split) node->leaf = fresh; else _art_addchild(node, ref, key[split], fresh);
+        art->count++;
+        return 0;  // Success
+    }
+    _ArtNode* node = (_ArtNode*)ptr;
+    if (node->prefixlen) {
+        I32 diff = _art_mismatch(art, node, key, keylen, depth);
+        if (diff < node->prefixlen) {
+            // The key leaves the compressed path part way: a new node4 takes the shared part
+            Void* fresh = _art_newleaf(art, key, keylen, value);
+            _ArtNode* parent = _art_node(M_ART_NODE4);
+            if (!fresh || !parent) {
+                _art_free(fresh);
+                m_free(parent);
+                return M_ERR_ALLOCATION_FAILED;
+            }
+            parent->prefixlen = diff;
+            memcpy(parent->prefix, node->prefix, m_min(diff, M_ART_PREFIX));
+            U8 byte;
+            if (node->prefixlen <= M_ART_PREFIX) {
+                byte = node->prefix[diff];
+                node->prefixlen -= diff + 1;
+                memmove(node->prefix, node->prefix + diff + 1, node->prefixlen);
+            } else {
+                U8* full = _art_leafkey(art, _art_anyleaf(node));
+                byte = full[depth + diff];
+                node->prefixlen -= diff + 1;
+                memcpy(node->prefix, full + depth + diff + 1, m_min(node->prefixlen, M_ART_PREFIX));
+            }
+            *ref = parent;
+            _art_addchild(parent, ref, byte, node);
+            if (keylen == depth + diff) parent->leaf = fresh; else _art_addchild(parent, ref, key[depth + diff], fresh);
+            art->count++;
+            return 0;  // Success
+        }
+        depth += node->prefixlen;
+    }
+    if (depth == keylen) {
+        if (node->leaf) {
+            memcpy(_art_leafvalue(_art_leaf(node->leaf)), value, art->valuesize);
+            return 0;  // Success
+        }
+        node->leaf = _art_newleaf(art, key, keylen, value);
+        if (!node->leaf) {
+            return M_ERR_ALLOCATION_FAILED;
+        }
+        art->count++;
+        return 0;  // Success
+    }
+    Void** child = _art_child(node, key[depth]);
+    if (child) {
+        return _art_insert(art, child, key, keylen, depth + 1, value);
+    }
+    Void* fresh = _art_newleaf(art, key, keylen, value);
+    if (!fresh) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    IErr err = _art_addchild(node, ref, key[depth], fresh);
+    if (err != 0) {
+        _art_free(fresh);
+        return err;
+    }
+    art->count++;
+    return 0;  // Success
+}
+
+static Bool _art_remove(m_Art* art, Void** ref, U8* key, I32 keylen, I32 depth) {
+    Void* ptr = *ref;
+    if (_art_isleaf(ptr)) {
+        // Only the root is reached as a bare leaf, children are checked from their parent
+        if (!_art_leafmatch(art, _art_leaf(ptr), key, keylen)) {
+            return false;
+        }
+        m_free(_art_leaf(ptr));
+        *ref = NULL;
+        return true;
+    }
+    _ArtNode* node = (_ArtNode*)ptr;
+    if (node->prefixlen) {
+        if (_art_mismatch(art, node, key, keylen, depth) != node->prefixlen) {
+            return false;
+        }
+        depth += node->prefixlen;
+    }
+    if (depth == keylen) {
+        if (!node->leaf || !_art_leafmatch(art, _art_leaf(node->leaf), key, keylen)) {
+            return false;
+        }
+        m_free(_art_leaf(node->leaf));
+        node->leaf = NULL;
+        _art_collapse(ref);
+        return true;
+    }
+    Void** child = _art_child(node, key[depth]);
+    if (!child) {
+        return false;
+    }
+    if (!_art_isleaf(*child)) {
+        return _art_remove(art, child, key, keylen, depth + 1);
+    }
+    if (!_art_leafmatch(art, _art_leaf(*child), key, keylen)) {
+        return false;
+    }
+    m_free(_art_leaf(*child));
+    _art_removechild(node, ref, key[depth]);
+    _art_collapse(ref);
+    return true;
+}
+
+// Visits the subtree in key order: a node's terminal leaf, then its children by byte
+static Bool _art_walk(m_Art* art, Void* ptr, m_ArtVisitor visitor, Void* context, I32* visited) {
+    if (_art_isleaf(ptr)) {
+        _ArtLeaf* leaf = _art_leaf(ptr);
+        (*visited)++;
+        return visitor(_art_leafkey(art, leaf), leaf->keylen, _art_leafvalue(leaf), context);
+    }
+    _ArtNode* node = (_ArtNode*)ptr;
+    if (node->leaf && !_art_walk(art, node->leaf, visitor, context, visited)) {
+        return false;
+    }
+    switch (node->type) {
+        case M_ART_NODE4:
+            for (I32 i = 0; i < node->count; ++i) {
+                if (!_art_walk(art, ((_ArtNode4*)node)->children[i], visitor, context, visited)) return false;
+            }
+            break;
+        case M_ART_NODE16:
+            for (I32 i = 0; i < node->count; ++i) {
+                if (!_art_walk(art, ((_ArtNode16*)node)->children[i], visitor, context, visited)) return false;
+            }
+            break;
+        case M_ART_NODE48: {
+            _ArtNode48* n = (_ArtNode48*)node;
+            for (I32 b = 0; b < 256; ++b) {
+                if (n->index[b] && !_art_walk(art, n->children[n->index[b] - 1], visitor, context, visited)) return false;
+            }
+            break;
+        }
+        default:
+            for (I32 b = 0; b < 256; ++b) {
+                Void* child = ((_ArtNode256*)node)->children[b];
+                if (child && !_art_walk(art, child, visitor, context, visited)) return false;
+            }
+            break;
+    }
+    return true;
+}
+
+m_Art* mart_create(I32 valuesize) {
+    m_Art* art = (m_Art*)m_alloc(sizeof(m_Art));
+    if (!art) {
+        return null;
+    }
+    IErr err = mart_init(art, valuesize);
+    if (err != 0) {
+        m_free(art);
+        return null;
+    }
+    return art;
+}
+
+Void mart_destroy(m_Art* art) {
+    if (!art) {
+        return;
+    }
+    mart_clear(art);
+    m_free(art);
+}
+
+IErr mart_init(m_Art* art, I32 valuesize) {
+    if (!art) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (valuesize < 0) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    art->root = NULL;
+    art->valuesize = valuesize;
+    art->count = 0;
+    return 0;  // Success
+}
+
+Void mart_clear(m_Art* art) {
+    _art_free(art->root);
+    art->root = NULL;
+    art->count = 0;
+}
+
+Void* mart_get(m_Art* art, Void* key, I32 keylen) {
+    U8* bytes = (U8*)key;
+    Void* ptr = art->root;
+    I32 depth = 0;
+    while (ptr) {
+        if (_art_isleaf(ptr)) {
+            _ArtLeaf* leaf = _art_leaf(ptr);
+            return _art_leafmatch(art, leaf, bytes, keylen) ? _art_leafvalue(leaf) : NULL;
+        }
+        _ArtNode* node = (_ArtNode*)ptr;
+        if (!_art_prefixmatch(node, bytes, keylen, depth)) {
+            return NULL;
+        }
+        depth += node->prefixlen;
+        if (depth == keylen) {
+            ptr = node->leaf;   // Confirmed as a leaf on the next pass
+            continue;
+        }
+        Void** child = _art_child(node, bytes[depth++]);
+        ptr = child ? *child : NULL;
+    }
+    return NULL;
+}
+
+IErr mart_put(m_Art* art, Void* key, I32 keylen, Void* value) {
+    if (!key && keylen > 0) {
+        return M_ERR_NULL_POINTER;
+    }
+    return _art_insert(art, &art->root, (U8*)key, keylen, 0, value);
+}
+
+Bool mart_has(m_Art* art, Void* key, I32 keylen) {
+    return mart_get(art, key, keylen) != NULL;
+}
+
+IErr mart_remove(m_Art* art, Void* key, I32 keylen) {
+    if (art->root && _art_remove(art, &art->root, (U8*)key, keylen, 0)) {
+        art->count--;
+    }
+    return 0;  // Success
+}
+
+I32 mart_count(m_Art* art) {
+    return art->count;
+}
+
+// Every stored key that is a prefix of the query lies on the query's path, as a terminal leaf or the final leaf
+Void* mart_longest_prefix(m_Art* art, Void* key, I32 keylen, I32* matchlen) {
+    U8* bytes = (U8*)key;
+    _ArtLeaf* best = NULL;
+    Void* ptr = art->root;
+    I32 depth = 0;
+    while (ptr) {
+        _ArtLeaf* leaf = NULL;
+        _ArtNode* node = NULL;
+        if (_art_isleaf(ptr)) {
+            leaf = _art_leaf(ptr);
+        } else {
+            node = (_ArtNode*)ptr;
+            if (!_art_prefixmatch(node, bytes, keylen, depth)) {
+                break;
+            }
+            depth += node->prefixlen;
+            leaf = node->leaf ? _art_leaf(node->leaf) : NULL;
+        }
+        // Inline prefixes skip bytes, so each candidate is confirmed against the query in full
+        if (leaf && leaf->keylen <= keylen && memcmp(_art_leafkey(art, leaf), bytes, leaf->keylen) == 0) {
+            best = leaf;
+        }
+        if (!node || depth >= keylen) {
+            break;
+        }
+        Void** child = _art_child(node, bytes[depth++]);
+        ptr = child ? *child : NULL;
+    }
+    if (matchlen) {
+        *matchlen = best ? best->keylen : 0;
+    }
+    return best ? _art_leafvalue(best) : NULL;
+}
+
+I32 mart_iter_prefix(m_Art* art, Void* prefix, I32 prefixlen, m_ArtVisitor visitor, Void* context) {
+    U8* bytes = (U8*)prefix;
+    Void* ptr = art->root;
+    I32 depth = 0;
+    I32 visited = 0;
+    while (ptr) {
+        if (_art_isleaf(ptr)) {
+            _ArtLeaf* leaf = _art_leaf(ptr);
+            if (leaf->keylen >= prefixlen && (prefixlen == 0 || memcmp(_art_leafkey(art, leaf), bytes, prefixlen) == 0)) {
+                _art_walk(art, ptr, visitor, context, &visited);
+            }
+            break;
+        }
+        _ArtNode* node = (_ArtNode*)ptr;
+        if (depth == prefixlen) {
+            _art_walk(art, ptr, visitor, context, &visited);
+            break;
+        }
+        if (node->prefixlen) {
+            I32 diff = _art_mismatch(art, node, bytes, prefixlen, depth);
+            if (diff < m_min(node->prefixlen, prefixlen - depth)) {
+                break;
+            }
+            if (depth + node->prefixlen >= prefixlen) {
+                _art_walk(art, ptr, visitor, context, &visited);   // The prefix ends inside this node's path
+                break;
+            }
+            depth += node->prefixlen;
+        }
+        Void** child = _art_child(node, bytes[depth++]);
+        ptr = child ? *child : NULL;
+    }
+    return visited;
+}
+
+// Big-endian bytes, so integer keys iterate in numeric order
+Void mart_key_u64(U64 value, U8* out) {
+    for (I32 i = 7; i >= 0; --i) {
+        out[i] = (U8)value;
+        value >>= 8;
+    }
+}
+
+// Small dictionary functions
+// Up to M_SMALL_DICT_CAP entries live inline in the struct, so a dict on the stack or inside another
+// struct allocates nothing until it overflows into a swiss dict. Bytewise 4- and 8-byte keys are matched
+// against every inline key with SSE2 compares instead of comparer calls.
+static U32 _small_match32(U32* keys, I32 count, U32 key) {
+#ifdef M_SSE2
+    __m128i needle = _mm_set1_epi32((I32)key);
+    U32 mask = 0;
+    for (I32 i = 0; i < count; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + i)), needle);
+        mask |= (U32)_mm_movemask_ps(_mm_castsi128_ps(eq)) << i;
+    }
+#else
+    U32 mask = 0;
+    for (I32 i = 0; i < count; ++i) {
+        mask |= (U32)(keys[i] == key) << i;
+    }
+#endif
+    return mask & (U32)((1ull << count) - 1);
+}
+
+static U32 _small_match64(U64* keys, I32 count, U64 key) {
+#ifdef M_SSE2
+    // SSE2 has no 64-bit compare: both 32-bit halves must match
+    __m128i needle = _mm_set1_epi64x((I64)key);
+    U32 mask = 0;
+    for (I32 i = 0; i < count; i += 2) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + i)), needle);
+        eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+        mask |= (U32)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+    }
+#else
+    U32 mask = 0;
+    for (I32 i = 0; i < count; ++i) {
+        mask |= (U32)(keys[i] == key) << i;
+    }
+#endif
+    return mask & (U32)((1ull << count) - 1);
+}
+
+static I32 _small_find(m_SmallDict* dict, Void* key) {
+    U8* keys = (U8*)dict->keys;
+    if (!dict->comparer && dict->keysize == 4) {
+        U32 k;
+        memcpy(&k, key, 4);
+        U32 mask = _small_match32((U32*)keys, dict->count, k);
+        return mask ? __builtin_ctz(mask) : -1;
+    }
+    if (!dict->comparer && dict->keysize == 8) {
+        U64 k;
+        memcpy(&k, key, 8);
+        U32 mask = _small_match64((U64*)keys, dict->count, k);
+        return mask ? __builtin_ctz(mask) : -1;
+    }
+    for (I32 i = 0; i < dict->count; ++i) {
+        Void* stored = keys + (Sz)i * dict->keysize;
+        if (dict->comparer ? dict->comparer(stored, key) == 0 : memcmp(stored, key, dict->keysize) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Moves the inline entries into a swiss dict; from then on every call forwards to it
+static IErr _small_spill(m_SmallDict* dict) {
+    m_Dict* spill = md_create_swiss(dict->keysize, dict->valuesize, dict->cap * 2, dict->hasher, dict->comparer);
+    if (!spill) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    for (I32 i = 0; i < dict->count; ++i) {
+        IErr err = md_put(spill, (U8*)dict->keys + (Sz)i * dict->keysize, (U8*)dict->values + (Sz)i * dict->valuesize);
+        if (err != 0) {
+            md_destroy(spill);
+            return err;
+        }
+    }
+    dict->spill = spill;
+    dict->count = 0;
+    return 0;  // Success
+}
+
+m_SmallDict* msd_create(I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_SmallDict* dict = (m_SmallDict*)m_alloc(sizeof(m_SmallDict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = msd_init(dict, keysize, valuesize, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+Void msd_destroy(m_SmallDict* dict) {
+    if (!dict) {
+        return;
+    }
+    msd_clear(dict);
+    m_free(dict);
+}
+
+IErr msd_init(m_SmallDict* dict, I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (keysize <= 0 || valuesize < 0) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    dict->keysize = keysize;
+    dict->valuesize = valuesize;
+    dict->count = 0;
+    dict->cap = m_min(M_SMALL_DICT_CAP, M_SMALL_DICT_BYTES / keysize);
+    if (valuesize > 0) {
+        dict->cap = m_min(dict->cap, M_SMALL_DICT_BYTES / valuesize);
+    }
+    dict->hasher = hasher;
+    dict->comparer = comparer;
+    dict->spill = NULL;
+    return 0;  // Success
+}
+
+Void msd_clear(m_SmallDict* dict) {
+    if (dict->spill) {
+        md_destroy(dict->spill);
+        dict->spill = NULL;
+    }
+    dict->count = 0;
+}
+
+Void* msd_get(m_SmallDict* dict, Void* key) {
+    if (dict->spill) {
+        return md_get(dict->spill, key);
+    }
+    I32 index = _small_find(dict, key);
+    return (index >= 0) ? (U8*)dict->values + (Sz)index * dict->valuesize : NULL;
+}
+
+IErr msd_put(m_SmallDict* dict, Void* key, Void* value) {
+    if (!dict->spill) {
+        I32 index = _small_find(dict, key);
+        if (index < 0 && dict->count < dict->cap) {
+            index = dict->count++;
+            memcpy((U8*)dict->keys + (Sz)index * dict->keysize, key, dict->keysize);
+        }
+        if (index >= 0) {
+            memcpy((U8*)dict->values + (Sz)index * dict->valuesize, value, dict->valuesize);
+            return 0;
+        }
+        IErr err = _small_spill(dict);
+        if (err != 0) {
+            return err;
+        }
+    }
+    return md_put(dict->spill, key, value);
+}
+
+Bool msd_has(m_SmallDict* dict, Void* key) {
+    if (dict->spill) {
+        return md_has(dict->spill, key);
+    }
+    return _small_find(dict, key) >= 0;
+}
+
+IErr msd_remove(m_SmallDict* dict, Void* key) {
+    if (dict->spill) {
+        return md_remove(dict->spill, key);
+    }
+    I32 index = _small_find(dict, key);
+    if (index < 0) {
+        return 0;  // No key found, still success
+    }
+    I32 last = --dict->count;
+    if (index != last) {
+        memcpy((U8*)dict->keys + (Sz)index * dict->keysize, (U8*)dict->keys + (Sz)last * dict->keysize, dict->keysize);
+        memcpy((U8*)dict->values + (Sz)index * dict->valuesize, (U8*)dict->values + (Sz)last * dict->valuesize,
+               dict->valuesize);
+    }
+    return 0;  // Success
+}
+
+I32 msd_count(m_SmallDict* dict) {
+    return dict->spill ? md_count(dict->spill) : dict->count;
+}
+
+Bool msd_iter(m_SmallDict* dict, I32* pos, Void** key, Void** value) {
+    if (dict->spill) {
+        return md_iter(dict->spill, pos, key, value);
+    }
+    if (*pos >= dict->count) {
+        return false;
+    }
+    if (key) *key = (U8*)dict->keys + (Sz)*pos * dict->keysize;
+    if (value) *value = (U8*)dict->values + (Sz)*pos * dict->valuesize;
+    (*pos)++;
+    return true;
+}
+
+// Frozen dictionary functions
+// CHD-style minimal perfect hash: keys are split into buckets of about four and every bucket stores a
+// displacement that sends all of its keys to distinct slots of an array exactly count long. Buckets are
+// placed largest first; singletons go last and store their slot directly. A lookup is one hash, one
+// displacement read and one key compare.
+#define M_FROZEN_MAGIC      0x5a52464du     // "MFRZ" little endian
+#define M_FROZEN_VERSION    1u
+#define M_FROZEN_DIRECT     0x80000000u
+#define M_FROZEN_BUCKETSIZE 4
+#define M_FROZEN_MAXTRIES   (1 << 16)       // displacements tried per bucket before reseeding
+#define M_FROZEN_MAXSEEDS   32
+#define M_FROZEN_MAXBUCKET  32              // seeds that crowd more keys than this into one bucket are rejected
+
+typedef struct _FrozenHeader {
+    U32 magic;
+    U32 version;
+    I32 count;
+    I32 keysize;
+    I32 valuesize;
+    I32 bucketcount;
+    U64 seed;
+    U64 size;
+} _FrozenHeader;
+
+static Sz _align8(Sz size) {
+    return (size + 7) & ~(Sz)7;
+}
+
+static U32 _fastrange(U32 x, U32 n) {
+    return (U32)(((U64)x * n) >> 32);
+}
+
+static U32 _frozen_bucket(U64 hash, I32 bucketcount) {
+    return _fastrange((U32)(hash >> 32), (U32)bucketcount);
+}
+
+static U32 _frozen_slot(U64 hash, U32 disp, I32 count) {
+    if (disp & M_FROZEN_DIRECT) {
+        return disp & ~M_FROZEN_DIRECT;
+    }
+    return _fastrange((U32)_wymix(hash ^ disp, _wyp1), (U32)count);
+}
+
+// Offsets of the displacements, keys and values inside the blob; returns the total size
+static Sz _frozen_layout(I32 count, I32 keysize, I32 valuesize, I32 bucketcount, Sz* keysoff, Sz* valuesoff) {
+    Sz offset = _align8(sizeof(_FrozenHeader) + sizeof(U32) * bucketcount);
+    *keysoff = offset;
+    offset = _align8(offset + (Sz)keysize * count);
+    *valuesoff = offset;
+    return _align8(offset + (Sz)valuesize * count);
+}
+
+static IErr _frozen_attach(m_FrozenDict* frozen, Void* data, Sz size) {
+    _FrozenHeader* header = (_FrozenHeader*)data;
+    if (size < sizeof(_FrozenHeader) || header->magic != M_FROZEN_MAGIC || header->version != M_FROZEN_VERSION
+        || header->count < 0 || header->keysize <= 0 || header->valuesize < 0 || header->bucketcount <= 0) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    Sz keysoff, valuesoff;
+    Sz total = _frozen_layout(header->count, header->keysize, header->valuesize, header->bucketcount,
+                              &keysoff, &valuesoff);
+    if (header->size != total || size < total) {
+        return M_ERR_OUT_OF_BOUNDS;
+    }
+    frozen->data = data;
+    frozen->size = total;
+    frozen->disps = (U32*)((U8*)data + sizeof(_FrozenHeader));
+    frozen->keys = (U8*)data + keysoff;
+    frozen->values = (U8*)data + valuesoff;
+    frozen->count = header->count;
+    frozen->keysize = header->keysize;
+    frozen->valuesize = header->valuesize;
+    frozen->bucketcount = header->bucketcount;
+    frozen->seed = header->seed;
+    frozen->file = null;
+    frozen->filesize = 0;
+    return 0;  // Success
+}
+
+// Finds a displacement for every bucket. False means this seed gave two keys the same hash or a bucket
+// too large to place, and the caller retries with another seed.
+static Bool _frozen_place(U64* hashes, I32 count, I32 bucketcount, U32* disps, I32* slotof, I32* scratch, U8* taken) {
+    I32* starts = scratch;                      // bucketcount + 1, bucket b owns members [starts[b], starts[b + 1])
+    I32* cursor = starts + bucketcount + 1;     // bucketcount
+    I32* members = cursor + bucketcount;        // count
+    I32* order = members + count;               // bucketcount, largest buckets first
+    I32 bysize[M_FROZEN_MAXBUCKET + 2] = {0};
+
+    memset(starts, 0, sizeof(I32) * (bucketcount + 1));
+    memset(disps, 0, sizeof(U32) * bucketcount);
+    memset(taken, 0, (U32)count);
+    for (I32 i = 0; i < count; ++i) {
+        starts[_frozen_bucket(hashes[i], bucketcount) + 1]++;
+    }
+    for (I32 b = 0; b < bucketcount; ++b) {
+        I32 size = starts[b + 1];
+        if (size > M_FROZEN_MAXBUCKET) {
+            return false;
+        }
+        bysize[M_FROZEN_MAXBUCKET - size + 1]++;
+        starts[b + 1] += starts[b];
+        cursor[b] = starts[b];
+    }
+    for (I32 i = 0; i < count; ++i) {
+        members[cursor[_frozen_bucket(hashes[i], bucketcount)]++] = i;
+    }
+    // Counting sort of the buckets by descending size
+    for (I32 k = 1; k <= M_FROZEN_MAXBUCKET + 1; ++k) {
+        bysize[k] += bysize[k - 1];
+    }
+    for (I32 b = 0; b < bucketcount; ++b) {
+        order[bysize[M_FROZEN_MAXBUCKET - (starts[b + 1] - starts[b])]++] = b;
+    }
+
+    I32 nextfree = 0;
+    for (I32 k = 0; k < bucketcount; ++k) {
+        I32 b = order[k];
+        I32 first = starts[b];
+        I32 size = starts[b + 1] - first;
+        if (size == 0) {
+            break;  // Only empty buckets remain
+        }
+        if (size == 1) {
+            while (taken[nextfree]) {
+                nextfree++;
+            }
+            taken[nextfree] = 1;
+            slotof[members[first]] = nextfree;
+            disps[b] = M_FROZEN_DIRECT | (U32)nextfree;
+            continue;
+        }
+        Bool placed = false;
+        for (U32 d = 0; d < M_FROZEN_MAXTRIES && !placed; ++d) {
+            I32 j = 0;
+            for (; j < size; ++j) {
+                I32 slot = (I32)_frozen_slot(hashes[members[first + j]], d, count);
+                if (taken[slot]) {
+                    break;
+                }
+                taken[slot] = 1;
+                slotof[members[first + j]] = slot;
+            }
+            if (j == size) {
+                disps[b] = d;
+                placed = true;
+            } else {
+                while (j-- > 0) {
+                    taken[slotof[members[first + j]]] = 0;
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+m_FrozenDict* md_freeze(m_Dict* dict) {
+    if (!dict || dict->mode == M_DICT_STRING) {
+        return null;    // String keys live in the arena, not in fixed-size key slots
+    }
+    I32 count = md_count(dict);
+    I32 keysize = dict->keys.buffer.itemsize;
+    I32 valuesize = dict->values.buffer.itemsize;
+    I32 bucketcount = m_max(1, (count + M_FROZEN_BUCKETSIZE - 1) / M_FROZEN_BUCKETSIZE);
+    m_ItemComparer comparer = dict->keys.comparer == _default_comparer ? NULL : dict->keys.comparer;
+    // List-backed and sorted dicts have no hasher. Hashing key bytes only agrees with a bytewise comparer;
+    // m_compare_str has its own hasher, other comparers give no hasher to match them
+    m_ItemHasher hasher = dict->hasher;
+    if (!hasher && comparer && comparer != m_compare_str) {
+        return null;
+    }
+    hasher = hasher ? hasher : comparer ? m_hash_str : m_hasher_for_size(keysize);
+
+    Sz keysoff, valuesoff;
+    Sz size = _frozen_layout(count, keysize, valuesize, bucketcount, &keysoff, &valuesoff);
+    m_FrozenDict* frozen = (m_FrozenDict*)m_alloc(sizeof(m_FrozenDict));
+    U8* data = (U8*)m_alloc(size);
+    Void** keys = (Void**)m_alloc(sizeof(Void*) * 2 * count + 1);
+    U64* hashes = (U64*)m_alloc(sizeof(U64) * count + 1);
+    I32* scratch = (I32*)m_alloc(sizeof(I32) * (3 * (Sz)bucketcount + 1 + 2 * (Sz)count));
+    U8* taken = (U8*)m_alloc(count + 1);
+    Bool ok = frozen && data && keys && hashes && scratch && taken;
+
+    if (ok) {
+        Void** values = keys + count;
+        I32* slotof = scratch + 3 * bucketcount + 1 + count;
+        I32 pos = 0;
+        I32 n = 0;
+        while (md_iter(dict, &pos, &keys[n], &values[n])) {
+            n++;
+        }
+        _FrozenHeader* header = (_FrozenHeader*)data;
+        memset(data, 0, size);
+        header->magic = M_FROZEN_MAGIC;
+        header->version = M_FROZEN_VERSION;
+        header->count = count;
+        header->keysize = keysize;
+        header->valuesize = valuesize;
+        header->bucketcount = bucketcount;
+        header->size = size;
+        U32* disps = (U32*)(data + sizeof(_FrozenHeader));
+
+        ok = false;
+        for (I32 attempt = 0; attempt < M_FROZEN_MAXSEEDS && !ok; ++attempt) {
+            header->seed = _wymix(dict->seed ^ _wyp2, _wyp3 + (U64)attempt);
+            for (I32 i = 0; i < count; ++i) {
+                hashes[i] = hasher(keys[i], keysize, header->seed);
+            }
+            ok = _frozen_place(hashes, count, bucketcount, disps, slotof, scratch, taken);
+        }
+        for (I32 i = 0; ok && i < count; ++i) {
+            memcpy(data + keysoff + (Sz)slotof[i] * keysize, keys[i], keysize);
+            memcpy(data + valuesoff + (Sz)slotof[i] * valuesize, values[i], valuesize);
+        }
+    }
+    m_free(keys);
+    m_free(hashes);
+    m_free(scratch);
+    m_free(taken);
+    if (!ok) {
+        m_free(data);
+        m_free(frozen);
+        return null;
+    }
+    _frozen_attach(frozen, data, size);
+    frozen->owned = true;
+    frozen->hasher = hasher;
+    frozen->comparer = comparer;
+    return frozen;
+}
+
+m_FrozenDict* mf_load(Void* data, Sz size, m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!data) {
+        return null;
+    }
+    m_FrozenDict* frozen = (m_FrozenDict*)m_alloc(sizeof(m_FrozenDict));
+    if (!frozen) {
+        return null;
+    }
+    if (_frozen_attach(frozen, data, size) != 0) {
+        m_free(frozen);
+        return null;
+    }
+    frozen->owned = false;
+    frozen->hasher = hasher ? hasher : m_hasher_for_size(frozen->keysize);
+    frozen->comparer = comparer;
+    return frozen;
+}
+
+static Void _file_close(Void* base, Sz size);
+
+Void mf_destroy(m_FrozenDict* frozen) {
+    if (!frozen) {
+        return;
+    }
+    if (frozen->owned) {
+        m_free(frozen->data);
+    }
+    if (frozen->file) {
+        _file_close(frozen->file, frozen->filesize);
+    }
+    m_free(frozen);
+}
+
+Void* mf_get(m_FrozenDict* frozen, Void* key) {
+    if (frozen->count == 0) {
+        return null;
+    }
+    U64 hash = frozen->hasher(key, frozen->keysize, frozen->seed);
+    U32 slot = _frozen_slot(hash, frozen->disps[_frozen_bucket(hash, frozen->bucketcount)], frozen->count);
+    if (slot >= (U32)frozen->count) {
+        return null;  // A direct displacement from a corrupt blob; the header checksum does not cover it
+    }
+    Void* stored = frozen->keys + (Sz)slot * frozen->keysize;
+    Bool equal = frozen->comparer ? frozen->comparer(stored, key) == 0 : memcmp(stored, key, frozen->keysize) == 0;
+    return equal ? frozen->values + (Sz)slot * frozen->valuesize : null;
+}
+
+Bool mf_has(m_FrozenDict* frozen, Void* key) {
+    return mf_get(frozen, key) != null;
+}
+
+I32 mf_count(m_FrozenDict* frozen) {
+    return frozen->count;
+}
+
+// Mapped file functions
+// A saved list or dict is one file: a fixed header, padding up to M_FILE_ALIGN, then the payload exactly as
+// it is used in memory. List payloads are the packed items; dict payloads are the frozen blob of md_freeze,
+// which holds offsets rather than pointers, so a mapping at any address serves lookups without a fixup pass.
+// The header checksum is always checked; the payload checksum reads every page, so it is opt-in.
+#define M_FILE_MAGIC        0x4c46474du     // "MGFL" little endian
+#define M_FILE_VERSION      1u
+#define M_FILE_BYTEORDER    0x01020304u
+#define M_FILE_ALIGN        64              // payload offset, keeps SIMD loads over keys aligned
+#define M_FILE_LIST         1u
+#define M_FILE_DICT         2u
+
+typedef struct _FileHeader {
+    U32 magic;
+    U16 version;
+    U16 kind;
+    U32 byteorder;      // reads back swapped on a host of the other endianness
+    I32 itemsize;       // list item size, 0 for dicts
+    U64 count;
+    U64 offset;         // payload start, a multiple of M_FILE_ALIGN
+    U64 size;           // payload bytes
+    U64 checksum;       // payload hash
+    U64 headersum;      // hash of the fields above
+} _FileHeader;
+
+typedef struct _MappedList {
+    m_List list;            // first, so ml_destroy frees the whole block
+    m_Allocator allocator;  // releases the file and refuses to grow it
+    Void* base;
+    Sz size;
+} _MappedList;
+
+static U64 _file_headersum(_FileHeader* header) {
+    return _wyhash((const U8*)header, offsetof(_FileHeader, headersum), M_FILE_MAGIC);
+}
+
+// Writes beside the target and renames over it, so processes still mapping the old file keep valid pages
+static IErr _file_write(CStr path, U16 kind, I32 itemsize, U64 count, Void* payload, Sz size) {
+    _FileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = M_FILE_MAGIC;
+    header.version = M_FILE_VERSION;
+    header.kind = kind;
+    header.byteorder = M_FILE_BYTEORDER;
+    header.itemsize = itemsize;
+    header.count = count;
+    header.offset = M_FILE_ALIGN;
+    header.size = size;
+    header.checksum = _wyhash((const U8*)payload, size, M_FILE_MAGIC);
+    header.headersum = _file_headersum(&header);
+
+    Sz pathlen = strlen(path);
+    Str temp = (Str)m_alloc(pathlen + 5);
+    if (!temp) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    memcpy(temp, path, pathlen);
+    memcpy(temp + pathlen, ".tmp", 5);
+
+    U8 padding[M_FILE_ALIGN - sizeof(_FileHeader)] = {0};
+    FILE* file = fopen(temp, "wb");
+    Bool ok = file
+        && fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(padding, sizeof(padding), 1, file) == 1
+        && (size == 0 || fwrite(payload, size, 1, file) == 1);
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    if (ok && rename(temp, path) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        remove(temp);
+        m_log_error("_file_write: cannot write %s", path);
+    }
+    m_free(temp);
+    return ok ? 0 : M_ERR_INVALID_OPERATION;
+}
+
+// Maps the whole file read only, or reads it into memory where mmap is unavailable
+static Void* _file_open(CStr path, Sz* size) {
+    Void* base = null;
+#ifdef M_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return null;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        base = mmap(NULL, (Sz)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        base = base == MAP_FAILED ? null : base;
+        *size = (Sz)st.st_size;
+    }
+    close(fd);  // The mapping holds its own reference
+#else
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return null;
+    }
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        base = m_alloc((Sz)length);
+        if (base && fread(base, (Sz)length, 1, file) != 1) {
+            m_free(base);
+            base = null;
+        }
+        *size = (Sz)length;
+    }
+    fclose(file);
+#endif
+    return base;
+}
+
+static Void _file_close(Void* base, Sz size) {
+#ifdef M_MMAP
+    munmap(base, size);
+#else
+    m_free(base);
+#endif
+}
+
+// Validates the header against the file size and expected kind; returns it, or NULL for a foreign,
+// truncated or corrupt file
+static _FileHeader* _file_check(Void* base, Sz size, U16 kind, Bool verify) {
+    _FileHeader* header = (_FileHeader*)base;
+    if (size < M_FILE_ALIGN || header->magic != M_FILE_MAGIC || header->version != M_FILE_VERSION
+        || header->byteorder != M_FILE_BYTEORDER || header->kind != kind
+        || header->headersum != _file_headersum(header)) {
+        return null;
+    }
+    if (header->offset % M_FILE_ALIGN != 0 || header->offset > size || header->size > size - header->offset) {
+        return null;
+    }
+    if (verify && _wyhash((const U8*)base + header->offset, header->size, M_FILE_MAGIC) != header->checksum) {
+        return null;
+    }
+    return header;
+}
+
+static Void* _mapped_malloc(Sz size, Void* userdata) {
+    return null;
+}
+
+static Void* _mapped_realloc(Void* ptr, Sz new_size, Void* userdata) {
+    return null;
+}
+
+static Void _mapped_free(Void* ptr, Void* userdata) {
+    _MappedList* mapped = (_MappedList*)userdata;
+    _file_close(mapped->base, mapped->size);
+}
+
+IErr ml_save(m_List* list, CStr path) {
+    if (!list || !path) {
+        return M_ERR_NULL_POINTER;
+    }
+    return _file_write(path, M_FILE_LIST, list->buffer.itemsize, (U64)list->count, list->buffer.data,
+                       (Sz)list->count * list->buffer.itemsize);
+}
+
+m_List* ml_map(CStr path, m_ItemComparer comparer, Bool verify) {
+    if (!path) {
+        return null;
+    }
+    Sz size = 0;
+    Void* base = _file_open(path, &size);
+    if (!base) {
+        return null;
+    }
+    _FileHeader* header = _file_check(base, size, M_FILE_LIST, verify);
+    if (!header || header->itemsize <= 0 || header->count > INT32_MAX
+        || header->size != header->count * (U64)header->itemsize) {
+        _file_close(base, size);
+        return null;
+    }
+    _MappedList* mapped = (_MappedList*)m_alloc(sizeof(_MappedList));
+    if (!mapped) {
+        _file_close(base, size);
+        return null;
+    }
+    mapped->base = base;
+    mapped->size = size;
+    mapped->allocator.malloc = _mapped_malloc;
+    mapped->allocator.realloc = _mapped_realloc;
+    mapped->allocator.free = _mapped_free;
+    mapped->allocator.userdata = mapped;
+    mapped->list.buffer.data = (U8*)base + header->offset;
+    mapped->list.buffer.itemsize = header->itemsize;
+    mapped->list.buffer.itemcap = (I32)header->count;
+    mapped->list.buffer.allocator = &mapped->allocator;
+    mapped->list.count = (I32)header->count;
+    mapped->list.comparer = comparer ? comparer : _default_comparer;
+    mapped->list.growth = 0;
+    return &mapped->list;
+}
+
+IErr md_save(m_Dict* dict, CStr path) {
+    if (!dict || !path) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (dict->keys.comparer == m_compare_str) {
+        return M_ERR_INVALID_OPERATION;  // The keys are CStr pointers, meaningless to another process
+    }
+    m_FrozenDict* frozen = md_freeze(dict);
+    if (!frozen) {
+        return M_ERR_INVALID_OPERATION;
+    }
+    IErr err = _file_write(path, M_FILE_DICT, 0, (U64)frozen->count, frozen->data, frozen->size);
+    mf_destroy(frozen);
+    return err;
+}
+
+m_FrozenDict* md_map(CStr path, m_ItemHasher hasher, m_ItemComparer comparer, Bool verify) {
+    if (!path) {
+        return null;
+    }
+    Sz size = 0;
+    Void* base = _file_open(path, &size);
+    if (!base) {
+        return null;
+    }
+    _FileHeader* header = _file_check(base, size, M_FILE_DICT, verify);
+    m_FrozenDict* frozen = header ? mf_load((U8*)base + header->offset, header->size, hasher, comparer) : null;
+    if (!frozen) {
+        _file_close(base, size);
+        return null;
+    }
+    frozen->file = base;
+    frozen->filesize = size;
+    return frozen;
+}
+
+// Concurrent dictionary functions
+#ifdef M_THREADS
+#define M_CACHE_LINE 64
+
+typedef struct _DictShard {
+    m_Dict dict;
+    union {
+        pthread_mutex_t mutex;
+        pthread_rwlock_t rwlock;
+    } lock;
+} _DictShard;
+
+// Shards are padded to whole cache lines so neighbouring locks never share one
+static Sz _shard_stride(Void) {
+    return (sizeof(_DictShard) + M_CACHE_LINE - 1) & ~(Sz)(M_CACHE_LINE - 1);
+}
+
+static _DictShard* _shard_at(m_ConcurrentDict* dict, I32 index) {
+    return (_DictShard*)((U8*)dict->shards + (Sz)index * _shard_stride());
+}
+
+// Shards take bits above the ones the swiss probing uses, so each shard still sees well spread hashes
+static _DictShard* _shard_for(m_ConcurrentDict* dict, U64 hash) {
+    return _shard_at(dict, (I32)((hash >> 40) & (U64)(dict->shardcount - 1)));
+}
+
+static Void _shard_lock(m_ConcurrentDict* dict, _DictShard* shard, Bool write) {
+    if (!dict->rwlocks) {
+        pthread_mutex_lock(&shard->lock.mutex);
+    } else if (write) {
+        pthread_rwlock_wrlock(&shard->lock.rwlock);
+    } else {
+        pthread_rwlock_rdlock(&shard->lock.rwlock);
+    }
+}
+
+static Void _shard_unlock(m_ConcurrentDict* dict, _DictShard* shard) {
+    if (dict->rwlocks) {
+        pthread_rwlock_unlock(&shard->lock.rwlock);
+    } else {
+        pthread_mutex_unlock(&shard->lock.mutex);
+    }
+}
+
+static Void _shards_release(m_ConcurrentDict* dict, I32 count) {
+    for (I32 i = 0; i < count; ++i) {
+        _DictShard* shard = _shard_at(dict, i);
+        _dict_release(&shard->dict);
+        if (dict->rwlocks) {
+            pthread_rwlock_destroy(&shard->lock.rwlock);
+        } else {
+            pthread_mutex_destroy(&shard->lock.mutex);
+        }
+    }
+    m_free(dict->memory);
+    dict->memory = NULL;
+    dict->shards = NULL;
+}
+
+m_ConcurrentDict* mcd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+                             m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_ConcurrentDict* dict = (m_ConcurrentDict*)m_alloc(sizeof(m_ConcurrentDict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = mcd_init(dict, keysize, valuesize, itemcap, shardcount, rwlocks, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+Void mcd_destroy(m_ConcurrentDict* dict) {
+    if (!dict) {
+        return;
+    }
+    _shards_release(dict, dict->shardcount);
+    m_free(dict);
+}
+
+IErr mcd_init(m_ConcurrentDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+              m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    I32 count = 1;
+    while (count < shardcount) {
+        count *= 2;
+    }
+    dict->memory = m_alloc(_shard_stride() * count + M_CACHE_LINE);
+    if (!dict->memory) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    dict->shards = (Void*)(((uintptr_t)dict->memory + M_CACHE_LINE - 1) & ~(uintptr_t)(M_CACHE_LINE - 1));
+    dict->shardcount = count;
+    dict->keysize = keysize;
+    dict->rwlocks = rwlocks;
+    dict->hasher = hasher ? hasher : m_hasher_for_size(keysize);
+
+    for (I32 i = 0; i < count; ++i) {
+        _DictShard* shard = _shard_at(dict, i);
+        IErr err = _table_init(&shard->dict, keysize, valuesize, itemcap / count, dict->hasher, comparer, M_DICT_SWISS);
+        if (err == 0) {
+            err = (rwlocks ? pthread_rwlock_init(&shard->lock.rwlock, NULL)
+                           : pthread_mutex_init(&shard->lock.mutex, NULL)) == 0 ? 0 : M_ERR_INVALID_OPERATION;
+            if (err != 0) {
+                _dict_release(&shard->dict);
+            }
+        }
+        if (err != 0) {
+            _shards_release(dict, i);
+            return err;
+        }
+    }
+    return 0;  // Success
 }
 
-IErr md_remove(m_Dict* dict, Void* key) {
-    I32 index = ml_find(&dict->keys, key);
-    if (index >= 0) {
-        IErr err = ml_remove_swap(&dict->keys, index);
-        if (err != 0) return err;
-        return ml_remove_swap(&dict->values, index);
+Bool mcd_get(m_ConcurrentDict* dict, Void* key, Void* value) {
+    U64 hash = dict->hasher(key, dict->keysize, 0);
+    _DictShard* shard = _shard_for(dict, hash);
+    _shard_lock(dict, shard, false);
+    I32 slot = _table_find(&shard->dict, key, hash);
+    if (slot >= 0 && value) {
+        memcpy(value, _dict_value_at(&shard->dict, slot), shard->dict.values.buffer.itemsize);
     }
-    return 0; // No key found, still success
+    _shard_unlock(dict, shard);
+    return slot >= 0;
 }
 
-IErr md_remove_ordered(m_Dict* dict, Void* key) {
-    I32 index = ml_find(&dict->keys, key);
-    if (index >= 0) {
-        IErr err = ml_remove(&dict->keys, index);
-        if (err != 0) return err;
-        return ml_remove(&dict->values, index);
+Bool mcd_has(m_ConcurrentDict* dict, Void* key) {
+    return mcd_get(dict, key, NULL);
+}
+
+IErr mcd_put(m_ConcurrentDict* dict, Void* key, Void* value) {
+    U64 hash = dict->hasher(key, dict->keysize, 0);
+    _DictShard* shard = _shard_for(dict, hash);
+    IErr err = 0;
+    _shard_lock(dict, shard, true);
+    I32 slot = _table_find(&shard->dict, key, hash);
+    if (slot >= 0) {
+        if (value) {
+            memcpy(_dict_value_at(&shard->dict, slot), value, shard->dict.values.buffer.itemsize);
+        }
+    } else {
+        err = _table_add(&shard->dict, key, value, hash);
     }
-    return 0; // No key found, still success
+    _shard_unlock(dict, shard);
+    return err;
 }
 
-Void md_clear(m_Dict* dict) {
-    ml_clear(&dict->keys);
-    ml_clear(&dict->values);
+IErr mcd_remove(m_ConcurrentDict* dict, Void* key) {
+    U64 hash = dict->hasher(key, dict->keysize, 0);
+    _DictShard* shard = _shard_for(dict, hash);
+    _shard_lock(dict, shard, true);
+    _table_remove(&shard->dict, key, hash);
+    _shard_unlock(dict, shard);
+    return 0;  // Missing keys are still success, like md_remove
 }
 
-I32 md_count(m_Dict* dict) {
-    return dict->keys.count;
+I32 mcd_count(m_ConcurrentDict* dict) {
+    I32 count = 0;
+    for (I32 i = 0; i < dict->shardcount; ++i) {
+        _DictShard* shard = _shard_at(dict, i);
+        _shard_lock(dict, shard, false);
+        count += shard->dict.keys.count;
+        _shard_unlock(dict, shard);
+    }
+    return count;
+}
+
+// Read-mostly dictionary functions
+// Readers announce the epoch they start in on their own cache line, load the published table and
+// probe it without locks. Writers copy the table, publish the copy and retire the old one, which is
+// freed once every active reader has announced a later epoch.
+typedef struct _ReaderSlot {
+    U64 epoch;          // 0 while the reader is outside a lookup
+    U32 inuse;
+} _ReaderSlot;
+
+typedef struct _RetiredTable {
+    m_Dict* table;
+    U64 epoch;
+} _RetiredTable;
+
+static _ReaderSlot* _reader_at(m_ReadDict* dict, I32 reader) {
+    return (_ReaderSlot*)((U8*)dict->readers + (Sz)reader * M_CACHE_LINE);
+}
+
+static IErr _buffer_clone(m_Buffer* dst, m_Buffer* src) {
+    *dst = *src;
+    if (!src->data) {
+        return 0;
+    }
+    Sz size = (Sz)src->itemsize * src->itemcap;
+    dst->data = (U8*)src->allocator->malloc(size, src->allocator->userdata);
+    if (!dst->data) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    memcpy(dst->data, src->data, size);
+    return 0;  // Success
+}
+
+static m_Dict* _dict_clone(m_Dict* src) {
+    m_Dict* dict = (m_Dict*)m_alloc(sizeof(m_Dict));
+    if (!dict) {
+        return null;
+    }
+    *dict = *src;
+    memset(&dict->keys.buffer, 0, sizeof(m_Buffer));
+    memset(&dict->values.buffer, 0, sizeof(m_Buffer));
+    memset(&dict->slots, 0, sizeof(m_Buffer));
+    memset(&dict->arena.buffer, 0, sizeof(m_Buffer));
+    if (_buffer_clone(&dict->keys.buffer, &src->keys.buffer) != 0
+        || _buffer_clone(&dict->values.buffer, &src->values.buffer) != 0
+        || _buffer_clone(&dict->slots, &src->slots) != 0
+        || _buffer_clone(&dict->arena.buffer, &src->arena.buffer) != 0) {
+        md_destroy(dict);
+        return null;
+    }
+    return dict;
+}
+
+// Frees retired tables no active reader can still be probing. Called with the write lock held.
+static Void _read_reclaim(m_ReadDict* dict) {
+    U64 oldest = __atomic_load_n(&dict->epoch, __ATOMIC_SEQ_CST);
+    for (I32 i = 0; i < dict->maxreaders; ++i) {
+        U64 epoch = __atomic_load_n(&_reader_at(dict, i)->epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    for (I32 i = ml_count(&dict->retired) - 1; i >= 0; --i) {
+        _RetiredTable* retired = (_RetiredTable*)ml_get(&dict->retired, i);
+        if (retired->epoch <= oldest) {
+            md_destroy(retired->table);
+            ml_remove_swap(&dict->retired, i);
+        }
+    }
+}
+
+// Publishes a modified copy and retires the table it replaces. Called with the write lock held.
+static IErr _read_publish(m_ReadDict* dict, m_Dict* table) {
+    // Reserve the retired entry first so a published table is never left without an owner
+    if (dict->retired.count >= dict->retired.buffer.itemcap) {
+        I32 cap = dict->retired.buffer.itemcap;
+        IErr err = ml_setcap(&dict->retired, cap ? cap * 2 : 4);
+        if (err != 0) {
+            md_destroy(table);
+            return err;
+        }
+    }
+    m_Dict* old = (m_Dict*)__atomic_exchange_n(&dict->table, (Void*)table, __ATOMIC_SEQ_CST);
+    _RetiredTable retired = {old, __atomic_add_fetch(&dict->epoch, 1, __ATOMIC_SEQ_CST)};
+    __atomic_store_n(&dict->count, table->keys.count, __ATOMIC_RELAXED);
+    ml_push(&dict->retired, &retired);
+    _read_reclaim(dict);
+    return 0;  // Success
+}
+
+m_ReadDict* mrd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+                       m_ItemHasher hasher, m_ItemComparer comparer) {
+    m_ReadDict* dict = (m_ReadDict*)m_alloc(sizeof(m_ReadDict));
+    if (!dict) {
+        return null;
+    }
+    IErr err = mrd_init(dict, keysize, valuesize, itemcap, maxreaders, hasher, comparer);
+    if (err != 0) {
+        m_free(dict);
+        return null;
+    }
+    return dict;
+}
+
+Void mrd_destroy(m_ReadDict* dict) {
+    if (!dict) {
+        return;
+    }
+    for (I32 i = 0; i < ml_count(&dict->retired); ++i) {
+        md_destroy(((_RetiredTable*)ml_get(&dict->retired, i))->table);
+    }
+    ml_setcap(&dict->retired, 0);
+    md_destroy((m_Dict*)dict->table);
+    pthread_mutex_destroy((pthread_mutex_t*)dict->writelock);
+    m_free(dict->memory);
+    m_free(dict);
+}
+
+IErr mrd_init(m_ReadDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+              m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!dict) {
+        return M_ERR_NULL_POINTER;
+    }
+    // One cache line for the write lock, then one per reader slot, all line aligned
+    Sz lines = (Sz)maxreaders + 1;
+    dict->memory = m_alloc(M_CACHE_LINE * (lines + 1));
+    if (!dict->memory) {
+        return M_ERR_ALLOCATION_FAILED;
+    }
+    U8* base = (U8*)(((uintptr_t)dict->memory + M_CACHE_LINE - 1) & ~(uintptr_t)(M_CACHE_LINE - 1));
+    memset(base, 0, M_CACHE_LINE * lines);
+    dict->writelock = base;
+    dict->readers = base + M_CACHE_LINE;
+    dict->maxreaders = maxreaders;
+    dict->epoch = 1;
+    dict->count = 0;
+    dict->table = NULL;
+
+    IErr err = pthread_mutex_init((pthread_mutex_t*)dict->writelock, NULL) == 0 ? 0 : M_ERR_INVALID_OPERATION;
+    if (err != 0) {
+        m_free(dict->memory);
+        return err;
+    }
+    err = ml_init(&dict->retired, sizeof(_RetiredTable), 4, NULL);
+    if (err == 0) {
+        dict->table = md_create_swiss(keysize, valuesize, itemcap, hasher, comparer);
+        err = dict->table ? 0 : M_ERR_ALLOCATION_FAILED;
+    }
+    if (err != 0) {
+        ml_setcap(&dict->retired, 0);
+        pthread_mutex_destroy((pthread_mutex_t*)dict->writelock);
+        m_free(dict->memory);
+        return err;
+    }
+    return 0;  // Success
+}
+
+I32 mrd_register(m_ReadDict* dict) {
+    for (I32 i = 0; i < dict->maxreaders; ++i) {
+        U32 expected = 0;
+        if (__atomic_compare_exchange_n(&_reader_at(dict, i)->inuse, &expected, 1, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return i;
+        }
+    }
+    return -1;  // All reader slots taken
+}
+
+Void mrd_unregister(m_ReadDict* dict, I32 reader) {
+    __atomic_store_n(&_reader_at(dict, reader)->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&_reader_at(dict, reader)->inuse, 0, __ATOMIC_RELEASE);
+}
+
+Bool mrd_get(m_ReadDict* dict, I32 reader, Void* key, Void* value) {
+    _ReaderSlot* slot = _reader_at(dict, reader);
+    __atomic_store_n(&slot->epoch, __atomic_load_n(&dict->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    m_Dict* table = (m_Dict*)__atomic_load_n(&dict->table, __ATOMIC_SEQ_CST);
+    I32 index = _table_find(table, key, _dict_hash(table, key));
+    if (index >= 0 && value) {
+        memcpy(value, _dict_value_at(table, index), table->values.buffer.itemsize);
+    }
+    __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+    return index >= 0;
+}
+
+Bool mrd_has(m_ReadDict* dict, I32 reader, Void* key) {
+    return mrd_get(dict, reader, key, NULL);
+}
+
+IErr mrd_put_many(m_ReadDict* dict, Void* keys, Void* values, I32 n) {
+    pthread_mutex_lock((pthread_mutex_t*)dict->writelock);
+    m_Dict* table = _dict_clone((m_Dict*)dict->table);
+    IErr err = table ? 0 : M_ERR_ALLOCATION_FAILED;
+    for (I32 i = 0; i < n && err == 0; ++i) {
+        Void* key = (U8*)keys + (Sz)i * table->keys.buffer.itemsize;
+        err = _table_put(table, key, values ? (U8*)values + (Sz)i * table->values.buffer.itemsize : NULL,
+                         _dict_hash(table, key));
+    }
+    if (err == 0) {
+        err = _read_publish(dict, table);
+    } else if (table) {
+        md_destroy(table);
+    }
+    pthread_mutex_unlock((pthread_mutex_t*)dict->writelock);
+    return err;
+}
+
+IErr mrd_put(m_ReadDict* dict, Void* key, Void* value) {
+    return mrd_put_many(dict, key, value, 1);
+}
+
+IErr mrd_remove(m_ReadDict* dict, Void* key) {
+    pthread_mutex_lock((pthread_mutex_t*)dict->writelock);
+    m_Dict* current = (m_Dict*)dict->table;
+    IErr err = 0;
+    if (_table_find(current, key, _dict_hash(current, key)) >= 0) {
+        m_Dict* table = _dict_clone(current);
+        if (table) {
+            _table_remove(table, key, _dict_hash(table, key));
+            err = _read_publish(dict, table);
+        } else {
+            err = M_ERR_ALLOCATION_FAILED;
+        }
+    }
+    pthread_mutex_unlock((pthread_mutex_t*)dict->writelock);
+    return err;
+}
+
+I32 mrd_count(m_ReadDict* dict) {
+    return __atomic_load_n(&dict->count, __ATOMIC_RELAXED);
+}
+
+// Parallel sort functions
+// Each thread sorts one contiguous chunk, then rounds of pairwise merges halve the number of runs until one
+// is left, alternating between the list and one scratch copy taken from the list's allocator. Every round is
+// cut into about nthreads equal pieces of output with merge path: a binary search along the output diagonal
+// finds where a piece starts in both runs, so the pieces merge independently. Merges take from the left run
+// on ties, so with stable chunk sorts the whole sort is stable.
+#define M_PARALLEL_MIN      16384       // items per thread below which threads cost more than they save
+#define M_PARALLEL_MAX      256
+
+typedef struct _SortTask {
+    m_List* list;
+    U8* src;
+    U8* dst;
+    I32 alo, ahi;       // chunk to sort in place, or left run in src
+    I32 blo, bhi;       // right run in src, may be empty
+    I32 out;            // where the merged piece starts in dst
+    Bool stable;
+    IErr err;
+} _SortTask;
+
+typedef struct _SortPool {
+    _SortTask* tasks;
+    I32 count;
+    I32 next;
+    Void (*run)(_SortTask* task);
+} _SortPool;
+
+static Void _sort_chunk(_SortTask* task) {
+    m_List view = *task->list;
+    view.buffer.data = task->src + (Sz)task->alo * view.buffer.itemsize;
+    view.count = task->ahi - task->alo;
+    if (!task->stable) {
+        ml_sort_pdq(&view);
+        return;
+    }
+    I32* order = (I32*)m_alloc(sizeof(I32) * view.count + 1);
+    task->err = !order ? M_ERR_ALLOCATION_FAILED : ml_argsort(&view, order);
+    if (task->err == 0) {
+        task->err = ml_apply_permutation(&view, order);
+    }
+    m_free(order);
+}
+
+static Void _merge_piece(_SortTask* task) {
+    Sz size = task->list->buffer.itemsize;
+    m_ItemComparer comparer = task->list->comparer;
+    U8* a = task->src + (Sz)task->alo * size;
+    U8* aend = task->src + (Sz)task->ahi * size;
+    U8* b = task->src + (Sz)task->blo * size;
+    U8* bend = task->src + (Sz)task->bhi * size;
+    U8* out = task->dst + (Sz)task->out * size;
+    // Runs already in order, as with sorted input, only need the two copies at the end
+    Bool ordered = a == aend || b == bend || comparer(b, aend - size) >= 0;
+    while (!ordered && a < aend && b < bend) {
+        if (comparer(b, a) < 0) {
+            memcpy(out, b, size);
+            b += size;
+        } else {
+            memcpy(out, a, size);
+            a += size;
+        }
+        out += size;
+    }
+    memcpy(out, a, aend - a);
+    memcpy(out + (aend - a), b, bend - b);
+}
+
+// Items of run a that precede the first diagonal items of the merged output; a[i] <= b[j] puts a[i] first
+static I32 _merge_split(m_List* list, U8* a, I32 alen, U8* b, I32 blen, I32 diagonal) {
+    Sz size = list->buffer.itemsize;
+    I32 lo = m_max(0, diagonal - blen);
+    I32 hi = m_min(diagonal, alen);
+    while (lo < hi) {
+        I32 mid = lo + (hi - lo) / 2;
+        if (list->comparer(a + (Sz)mid * size, b + (Sz)(diagonal - mid - 1) * size) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static Void* _sort_worker(Void* arg) {
+    _SortPool* pool = (_SortPool*)arg;
+    for (I32 i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED); i < pool->count;
+         i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) {
+        pool->run(&pool->tasks[i]);
+    }
+    return NULL;
+}
+
+// Runs every task on up to nthreads threads, the calling thread included; a thread that fails to start
+// just leaves more tasks for the others
+static Void _sort_run(_SortPool* pool, pthread_t* threads, I32 nthreads) {
+    pool->next = 0;
+    I32 started = 0;
+    for (I32 t = 1; t < m_min(nthreads, pool->count); ++t) {
+        if (pthread_create(&threads[started], NULL, _sort_worker, pool) == 0) {
+            started++;
+        }
+    }
+    _sort_worker(pool);
+    for (I32 t = 0; t < started; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+IErr ml_sort_parallel(m_List* list, I32 nthreads, Bool stable) {
+    if (!list) {
+        return M_ERR_NULL_POINTER;
+    }
+    if (_bytewise(list)) {
+        return M_ERR_INVALID_OPERATION;  // No comparer to order by
+    }
+    I32 n = list->count;
+    if (nthreads <= 0) {
+        nthreads = (I32)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    nthreads = m_max(1, m_min(m_min(nthreads, M_PARALLEL_MAX), n / M_PARALLEL_MIN));
+
+    Sz size = list->buffer.itemsize;
+    m_Allocator* allocator = list->buffer.allocator;
+    U8* scratch = nthreads > 1 ? (U8*)allocator->malloc((Sz)n * size, allocator->userdata) : NULL;
+    I32* bounds = (I32*)m_alloc(sizeof(I32) * (nthreads + 1));
+    _SortTask* tasks = (_SortTask*)m_alloc(sizeof(_SortTask) * 3 * nthreads);
+    pthread_t* threads = (pthread_t*)m_alloc(sizeof(pthread_t) * nthreads);
+    IErr err = 0;
+    if ((nthreads > 1 && !scratch) || !bounds || !tasks || !threads) {
+        err = M_ERR_ALLOCATION_FAILED;
+    }
+
+    I32 runs = nthreads;
+    for (I32 r = 0; err == 0 && r <= runs; ++r) {
+        bounds[r] = (I32)((I64)n * r / runs);
+    }
+    _SortPool pool = {tasks, runs, 0, _sort_chunk};
+    for (I32 r = 0; err == 0 && r < runs; ++r) {
+        tasks[r] = (_SortTask){list, list->buffer.data, NULL, bounds[r], bounds[r + 1], 0, 0, 0, stable, 0};
+    }
+    if (err == 0) {
+        _sort_run(&pool, threads, nthreads);
+        for (I32 r = 0; r < runs; ++r) {
+            err = err ? err : tasks[r].err;
+        }
+    }
+
+    U8* src = list->buffer.data;
+    U8* dst = scratch;
+    pool.run = _merge_piece;
+    while (err == 0 && runs > 1) {
+        pool.count = 0;
+        for (I32 r = 0; r < runs; r += 2) {
+            I32 alo = bounds[r];
+            I32 blo = bounds[m_min(r + 1, runs)];
+            I32 bhi = bounds[m_min(r + 2, runs)];
+            I32 total = bhi - alo;
+            // Pieces in proportion to the pair's share of the items, so every thread gets about n / nthreads
+            I32 pieces = m_max(1, (I32)(((I64)total * nthreads + n / 2) / n));
+            I32 prev = 0;
+            for (I32 p = 0; p < pieces; ++p) {
+                I32 diagonal = (I32)((I64)total * (p + 1) / pieces);
+                I32 split = _merge_split(list, src + (Sz)alo * size, blo - alo, src + (Sz)blo * size, bhi - blo,
+                                         diagonal);
+                I32 start = (I32)((I64)total * p / pieces);
+                tasks[pool.count++] = (_SortTask){list, src, dst, alo + prev, alo + split,
+                                                  blo + start - prev, blo + diagonal - split, alo + start, stable, 0};
+                prev = split;
+            }
+            bounds[r / 2] = alo;
+        }
+        runs = (runs + 1) / 2;
+        bounds[runs] = n;
+        _sort_run(&pool, threads, nthreads);
+        U8* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (err == 0 && src != list->buffer.data) {
+        memcpy(list->buffer.data, src, (Sz)n * size);
+    }
+    if (scratch) {
+        allocator->free(scratch, allocator->userdata);
+    }
+    m_free(bounds);
+    m_free(tasks);
+    m_free(threads);
+    return err;
+}
+
+#ifdef M_MMAP
+// Process-shared dictionary functions
+// The whole table lives in one named shared memory segment that every process maps wherever it likes, so
+// the header records offsets and each process derives its own pointers. Slots use linear probing over a
+// power-of-two array with a U32 tag per slot (0 = empty, otherwise the high hash bits with bit 0 set, which
+// also give the home slot) and backward-shift deletion, so there are no tombstones and the segment never
+// grows. Writers serialise on a process-shared robust mutex and bump a sequence counter around each change;
+// readers take no lock, copy what they need and retry if the counter moved.
+#define M_SHARED_MAGIC      0x44485347u     // "GSHD" little endian
+#define M_SHARED_VERSION    1u
+#define M_SHARED_MAXLOAD    80              // percent of slots that may hold keys
+#define M_SHARED_SPINS      64              // optimistic read attempts before a reader takes the lock
+
+typedef struct _SharedHeader {
+    U32 magic;          // stored last by the creator, so openers never see a half built table
+    U32 version;
+    I32 keysize;
+    I32 valuesize;
+    I32 cap;
+    I32 count;
+    U32 seq;            // odd while a writer is changing slots
+    U32 reserved;
+    U64 seed;
+    U64 tagsoff;
+    U64 keysoff;
+    U64 valuesoff;
+    U64 size;
+    pthread_mutex_t lock;
+} _SharedHeader;
+
+static _SharedHeader* _shared_header(m_SharedDict* dict) {
+    return (_SharedHeader*)dict->segment;
+}
+
+static Sz _shared_layout(I32 cap, I32 keysize, I32 valuesize, U64* tagsoff, U64* keysoff, U64* valuesoff) {
+    Sz offset = _align8(sizeof(_SharedHeader));
+    *tagsoff = offset;
+    offset = _align8(offset + sizeof(U32) * (Sz)cap);
+    *keysoff = offset;
+    offset = _align8(offset + (Sz)keysize * cap);
+    *valuesoff = offset;
+    return _align8(offset + (Sz)valuesize * cap);
+}
+
+static Void _shared_attach(m_SharedDict* dict, Void* segment, Sz size, m_ItemHasher hasher, m_ItemComparer comparer) {
+    _SharedHeader* header = (_SharedHeader*)segment;
+    dict->segment = segment;
+    dict->size = size;
+    dict->tags = (U32*)((U8*)segment + header->tagsoff);
+    dict->keys = (U8*)segment + header->keysoff;
+    dict->values = (U8*)segment + header->valuesoff;
+    dict->keysize = header->keysize;
+    dict->valuesize = header->valuesize;
+    dict->mask = header->cap - 1;
+    dict->hasher = hasher ? hasher : m_hasher_for_size(header->keysize);
+    dict->comparer = comparer;
+}
+
+static U32 _shared_tag(m_SharedDict* dict, Void* key) {
+    return (U32)(dict->hasher(key, dict->keysize, _shared_header(dict)->seed) >> 32) | 1;
+}
+
+static Bool _shared_equal(m_SharedDict* dict, I32 slot, Void* key) {
+    Void* stored = dict->keys + (Sz)slot * dict->keysize;
+    return dict->comparer ? dict->comparer(stored, key) == 0 : memcmp(stored, key, dict->keysize) == 0;
+}
+
+// Slot holding the key, or the empty slot that ends its probe sequence as ~slot. Bounded by the table
+// size, so a reader racing a writer cannot loop on torn tags.
+static I32 _shared_find(m_SharedDict* dict, U32 tag, Void* key) {
+    I32 slot = (I32)(tag >> 1) & dict->mask;
+    for (I32 probes = 0; probes <= dict->mask; ++probes) {
+        U32 stored = dict->tags[slot];
+        if (stored == 0) {
+            return ~slot;
+        }
+        if (stored == tag && _shared_equal(dict, slot, key)) {
+            return slot;
+        }
+        slot = (slot + 1) & dict->mask;
+    }
+    return ~slot;  // Only reachable on a torn read, which the caller retries
+}
+
+// A holder that died mid-write may have left a shifted run half moved; the table stays usable but the
+// count is recomputed and the sequence made even again
+static Void _shared_lock(m_SharedDict* dict) {
+    _SharedHeader* header = _shared_header(dict);
+    int result = pthread_mutex_lock(&header->lock);
+#ifdef __linux__
+    if (result == EOWNERDEAD) {
+        I32 count = 0;
+        for (I32 i = 0; i <= dict->mask; ++i) {
+            count += dict->tags[i] != 0;
+        }
+        header->count = count;
+        if (header->seq & 1) {
+            __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELEASE);
+        }
+        pthread_mutex_consistent(&header->lock);
+    }
+#else
+    (Void)result;
+#endif
+}
+
+static Void _shared_begin(_SharedHeader* header) {
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static Void _shared_end(_SharedHeader* header) {
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&header->lock);
+}
+
+m_SharedDict* mshd_create(CStr name, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher,
+                          m_ItemComparer comparer) {
+    if (!name || keysize <= 0 || valuesize < 0 || itemcap < 0 || itemcap > (1 << 29)) {
+        return null;
+    }
+    I32 cap = 8;
+    while ((I64)cap * M_SHARED_MAXLOAD / 100 < itemcap) {
+        cap *= 2;
+    }
+    U64 tagsoff, keysoff, valuesoff;
+    Sz size = _shared_layout(cap, keysize, valuesize, &tagsoff, &keysoff, &valuesoff);
+    m_SharedDict* dict = (m_SharedDict*)m_alloc(sizeof(m_SharedDict));
+    if (!dict) {
+        return null;
+    }
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        m_free(dict);
+        return null;
+    }
+    Void* segment = ftruncate(fd, (off_t)size) == 0
+        ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (segment == MAP_FAILED) {
+        shm_unlink(name);
+        m_free(dict);
+        return null;
+    }
+
+    // ftruncate zero fills, so the tags already read as empty
+    _SharedHeader* header = (_SharedHeader*)segment;
+    header->version = M_SHARED_VERSION;
+    header->keysize = keysize;
+    header->valuesize = valuesize;
+    header->cap = cap;
+    header->seed = _wymix((U64)getpid() ^ _wyp0, (U64)(uintptr_t)segment ^ _wyp1);
+    header->tagsoff = tagsoff;
+    header->keysoff = keysoff;
+    header->valuesoff = valuesoff;
+    header->size = size;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+#endif
+    pthread_mutex_init(&header->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    __atomic_store_n(&header->magic, M_SHARED_MAGIC, __ATOMIC_RELEASE);
+
+    _shared_attach(dict, segment, size, hasher, comparer);
+    return dict;
+}
+
+m_SharedDict* mshd_open(CStr name, m_ItemHasher hasher, m_ItemComparer comparer) {
+    if (!name) {
+        return null;
+    }
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return null;
+    }
+    // The creator may still be sizing the segment; give it a moment
+    struct stat st;
+    st.st_size = 0;
+    for (I32 wait = 0; wait < 1000 && fstat(fd, &st) == 0 && (Sz)st.st_size < sizeof(_SharedHeader); ++wait) {
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+    Sz size = (Sz)st.st_size;
+    Void* segment = size >= sizeof(_SharedHeader)
+        ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (segment == MAP_FAILED) {
+        return null;
+    }
+    _SharedHeader* header = (_SharedHeader*)segment;
+    for (I32 wait = 0; wait < 1000 && __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != M_SHARED_MAGIC; ++wait) {
+        struct timespec pause = {0, 1000000};
+        nanosleep(&pause, NULL);
+    }
+    U64 tagsoff, keysoff, valuesoff;
+    Bool valid = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == M_SHARED_MAGIC
+        && header->version == M_SHARED_VERSION && header->keysize > 0 && header->valuesize >= 0
+        && header->cap > 0 && (header->cap & (header->cap - 1)) == 0 && header->size <= size
+        && header->size == _shared_layout(header->cap, header->keysize, header->valuesize, &tagsoff, &keysoff,
+                                          &valuesoff)
+        && header->tagsoff == tagsoff && header->keysoff == keysoff && header->valuesoff == valuesoff;
+    m_SharedDict* dict = valid ? (m_SharedDict*)m_alloc(sizeof(m_SharedDict)) : null;
+    if (!dict) {
+        munmap(segment, size);
+        return null;
+    }
+    _shared_attach(dict, segment, size, hasher, comparer);
+    return dict;
+}
+
+Void mshd_destroy(m_SharedDict* dict) {
+    if (!dict) {
+        return;
+    }
+    munmap(dict->segment, dict->size);
+    m_free(dict);
+}
+
+IErr mshd_unlink(CStr name) {
+    if (!name) {
+        return M_ERR_NULL_POINTER;
+    }
+    return shm_unlink(name) == 0 ? 0 : M_ERR_INVALID_OPERATION;
+}
+
+Bool mshd_get(m_SharedDict* dict, Void* key, Void* value) {
+    _SharedHeader* header = _shared_header(dict);
+    U32 tag = _shared_tag(dict, key);
+    for (I32 attempt = 0; attempt < M_SHARED_SPINS; ++attempt) {
+        U32 seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield();  // A writer is mid-change, let it finish
+            continue;
+        }
+        I32 slot = _shared_find(dict, tag, key);
+        if (slot >= 0 && value) {
+            memcpy(value, dict->values + (Sz)slot * dict->valuesize, dict->valuesize);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&header->seq, __ATOMIC_RELAXED) == seq) {
+            return slot >= 0;
+        }
+    }
+    // Writers keep winning, or one died holding the sequence odd: read under the lock
+    _shared_lock(dict);
+    I32 slot = _shared_find(dict, tag, key);
+    if (slot >= 0 && value) {
+        memcpy(value, dict->values + (Sz)slot * dict->valuesize, dict->valuesize);
+    }
+    pthread_mutex_unlock(&header->lock);
+    return slot >= 0;
+}
+
+Bool mshd_has(m_SharedDict* dict, Void* key) {
+    return mshd_get(dict, key, NULL);
+}
+
+IErr mshd_put(m_SharedDict* dict, Void* key, Void* value) {
+    _SharedHeader* header = _shared_header(dict);
+    U32 tag = _shared_tag(dict, key);
+    _shared_lock(dict);
+    I32 slot = _shared_find(dict, tag, key);
+    if (slot < 0 && (I64)(header->count + 1) * 100 > (I64)header->cap * M_SHARED_MAXLOAD) {
+        pthread_mutex_unlock(&header->lock);
+        return M_ERR_OUT_OF_BOUNDS;  // The segment has a fixed size
+    }
+    _shared_begin(header);
+    if (slot < 0) {
+        slot = ~slot;
+        memcpy(dict->keys + (Sz)slot * dict->keysize, key, dict->keysize);
+        dict->tags[slot] = tag;
+        header->count++;
+        if (!value) {
+            memset(dict->values + (Sz)slot * dict->valuesize, 0, dict->valuesize);
+        }
+    }
+    if (value) {
+        memcpy(dict->values + (Sz)slot * dict->valuesize, value, dict->valuesize);
+    }
+    _shared_end(header);
+    return 0;  // Success
+}
+
+IErr mshd_remove(m_SharedDict* dict, Void* key) {
+    _SharedHeader* header = _shared_header(dict);
+    U32 tag = _shared_tag(dict, key);
+    _shared_lock(dict);
+    I32 hole = _shared_find(dict, tag, key);
+    if (hole < 0) {
+        pthread_mutex_unlock(&header->lock);
+        return 0;  // Missing keys are still success, like md_remove
+    }
+    _shared_begin(header);
+    // Backward shift: pull later entries of the run into the hole unless that would move them before home
+    for (I32 slot = (hole + 1) & dict->mask; dict->tags[slot] != 0; slot = (slot + 1) & dict->mask) {
+        I32 home = (I32)(dict->tags[slot] >> 1) & dict->mask;
+        if (((slot - home) & dict->mask) >= ((slot - hole) & dict->mask)) {
+            dict->tags[hole] = dict->tags[slot];
+            memcpy(dict->keys + (Sz)hole * dict->keysize, dict->keys + (Sz)slot * dict->keysize, dict->keysize);
+            memcpy(dict->values + (Sz)hole * dict->valuesize, dict->values + (Sz)slot * dict->valuesize,
+                   dict->valuesize);
+            hole = slot;
+        }
+    }
+    dict->tags[hole] = 0;
+    header->count--;
+    _shared_end(header);
+    return 0;  // Success
+}
+
+I32 mshd_count(m_SharedDict* dict) {
+    return __atomic_load_n(&_shared_header(dict)->count, __ATOMIC_RELAXED);
 }
+#endif /* M_MMAP */
+#endif /* M_THREADS */
 
 // String buffer functions
 m_StrBuffer* ms_create(I32 itemcap) {
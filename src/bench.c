@@ -0,0 +1,910 @@
+#include "mg.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Benchmarks for the library containers. Build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+static F64 now_ms(Void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static I64 compares = 0;
+
+static I32 u64_comparer(Void* item1, Void* item2) {
+    U64 a = *(U64*)item1;
+    U64 b = *(U64*)item2;
+    compares++;
+    return (a > b) - (a < b);
+}
+
+// Spreads sequential ids over the key space like real ids do
+static U64 bench_key(I32 i) {
+    U64 x = (U64)i * 0x9e3779b97f4a7c15ull;
+    return x ^ (x >> 29);
+}
+
+#pragma region List Benchmarks
+
+M_LIST_DEFINE(I32, IntList)
+
+static Void list_benchmarks(Void) {
+    I32 n = 10000000;
+    printf("--- %d I32 items: m_List vs M_LIST_DEFINE typed list ---\n", n);
+    m_List* list = ml_create(sizeof(I32), 0, NULL);
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        ml_push(list, &i);
+    }
+    F64 push_ms = now_ms() - start;
+    I64 sum = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        sum += *(I32*)ml_get(list, i);
+    }
+    F64 get_ms = now_ms() - start;
+    printf("m_List   push %6.2f ns  get %6.2f ns  (%lld)\n", push_ms * 1e6 / n, get_ms * 1e6 / n, (long long)sum);
+    ml_destroy(list);
+
+    IntList* typed = IntList_create(0);
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        IntList_push(typed, i);
+    }
+    push_ms = now_ms() - start;
+    sum = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        sum += IntList_at(typed, i);
+    }
+    get_ms = now_ms() - start;
+    start = now_ms();
+    I32 index = IntList_find(typed, n - 1);
+    F64 find_ms = now_ms() - start;
+    printf("IntList  push %6.2f ns  get %6.2f ns  find %6.2f ns/item  (%lld, %d)\n", push_ms * 1e6 / n,
+           get_ms * 1e6 / n, find_ms * 1e6 / n, (long long)sum, index);
+    IntList_destroy(typed);
+
+    typedef struct Record {
+        U64 id;
+        U64 time;
+        F64 value;
+        I32 flags;
+        I32 source;
+    } Record;
+    printf("--- %d 32-byte records: ml_push vs ml_emplace vs ml_push_many in 1024-record batches ---\n", n);
+    m_List* records = ml_create(sizeof(Record), 0, NULL);
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        Record record = {bench_key(i), (U64)i, i * 0.5, i & 7, i % 13};
+        ml_push(records, &record);
+    }
+    printf("push     %6.2f ns/record\n", (now_ms() - start) * 1e6 / n);
+    ml_clear(records);
+    ml_setcap(records, 0);  // Every variant pays for its own growth
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        Record* record = (Record*)ml_emplace(records);
+        *record = (Record){bench_key(i), (U64)i, i * 0.5, i & 7, i % 13};
+    }
+    printf("emplace  %6.2f ns/record\n", (now_ms() - start) * 1e6 / n);
+    ml_clear(records);
+    ml_setcap(records, 0);
+    Record* batch = (Record*)m_alloc(sizeof(Record) * 1024);
+    start = now_ms();
+    for (I32 i = 0; i < n; i += 1024) {
+        I32 size = m_min(1024, n - i);
+        for (I32 j = 0; j < size; ++j) {
+            batch[j] = (Record){bench_key(i + j), (U64)(i + j), (i + j) * 0.5, (i + j) & 7, (i + j) % 13};
+        }
+        ml_push_many(records, batch, size);
+    }
+    printf("many     %6.2f ns/record  (%d)\n", (now_ms() - start) * 1e6 / n, ml_count(records));
+    m_free(batch);
+    ml_destroy(records);
+}
+
+typedef struct Row {
+    I64 time;
+    U64 id;
+    F64 value;
+} Row;
+
+static I32 row_comparer(Void* item1, Void* item2) {
+    I64 a = ((Row*)item1)->time;
+    I64 b = ((Row*)item2)->time;
+    return (a > b) - (a < b);
+}
+
+#define row_less(a, b, context) ((a)->time < (b)->time)
+
+M_SORT_DEFINE(Row, sort_rows, row_less)
+
+static Void sort_benchmarks(Void) {
+    I32 n = 10000000;
+    printf("--- sorting %d 24-byte rows by an I64 millisecond timestamp ---\n", n);
+    m_List* rows = ml_create(sizeof(Row), n, row_comparer);
+    Row* source = (Row*)m_alloc(sizeof(Row) * n);
+    for (I32 i = 0; i < n; ++i) {
+        source[i] = (Row){1700000000000ll + (I64)(bench_key(i) % 86400000), (U64)i, i * 0.25};
+    }
+    CStr names[] = {"qsort", "pdq", "argsort", "radix", "inline"};
+    for (I32 variant = 0; variant < 5; ++variant) {
+        ml_clear(rows);
+        ml_push_many(rows, source, n);
+        I32* order = variant == 2 ? (I32*)m_alloc(sizeof(I32) * n) : NULL;
+        F64 start = now_ms();
+        switch (variant) {
+            case 0: ml_sort(rows); break;
+            case 1: ml_sort_pdq(rows); break;
+            case 2: ml_argsort(rows, order); break;
+            case 3: ml_sort_radix(rows, 0, M_RADIX_I64); break;
+            case 4: sort_rows((Row*)rows->buffer.data, n, NULL); break;
+        }
+        F64 ms = now_ms() - start;
+        Bool sorted = true;
+        for (I32 i = 1; i < n && variant != 2; ++i) {
+            sorted &= ((Row*)ml_get(rows, i - 1))->time <= ((Row*)ml_get(rows, i))->time;
+        }
+        printf("%-8s %8.2f ms%s\n", names[variant], ms, sorted ? "" : "  NOT SORTED");
+        m_free(order);
+    }
+
+    // ml_sort_parallel against ml_sort on random, already sorted and few-unique timestamps
+    CStr shapes[] = {"random", "sorted", "few"};
+    I32 threads[] = {1, 2, 4, 8};
+    for (I32 shape = 0; shape < 3; ++shape) {
+        for (I32 i = 0; i < n; ++i) {
+            U64 key = shape == 0 ? bench_key(i) % 86400000 : shape == 1 ? (U64)i : bench_key(i) % 16;
+            source[i] = (Row){1700000000000ll + (I64)key, (U64)i, i * 0.25};
+        }
+        ml_clear(rows);
+        ml_push_many(rows, source, n);
+        F64 start = now_ms();
+        ml_sort(rows);
+        F64 base_ms = now_ms() - start;
+        printf("%-8s ml_sort %8.2f ms\n", shapes[shape], base_ms);
+        for (I32 stable = 0; stable < 2; ++stable) {
+            for (I32 t = 0; t < 4; ++t) {
+                ml_clear(rows);
+                ml_push_many(rows, source, n);
+                start = now_ms();
+                ml_sort_parallel(rows, threads[t], stable);
+                F64 ms = now_ms() - start;
+                Bool sorted = true;
+                for (I32 i = 1; i < n; ++i) {
+                    Row* a = (Row*)ml_get(rows, i - 1);
+                    Row* b = (Row*)ml_get(rows, i);
+                    sorted &= a->time < b->time || (a->time == b->time && (!stable || a->id < b->id));
+                }
+                printf("%-8s %-6s x%d %8.2f ms  %5.2fx%s\n", shapes[shape], stable ? "stable" : "pdq", threads[t], ms,
+                       base_ms / ms, sorted ? "" : "  NOT SORTED");
+            }
+        }
+    }
+    m_free(source);
+    ml_destroy(rows);
+}
+#pragma endregion
+
+#pragma region Dictionary Benchmarks
+
+static Void bench_dict(CStr name, m_Dict* dict, I32 n) {
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &i);
+    }
+    F64 put_ms = now_ms() - start;
+
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        found += md_get(dict, &key) != NULL;
+    }
+    F64 hit_ms = now_ms() - start;
+
+    compares = 0;
+    start = now_ms();
+    for (I32 i = n; i < 2 * n; ++i) {
+        U64 key = bench_key(i);
+        found += md_has(dict, &key);
+    }
+    F64 miss_ms = now_ms() - start;
+
+    printf("%-8s n=%-8d put %9.2f ns  hit %9.2f ns  miss %9.2f ns  compares/miss %8.3f  (%lld)\n",
+           name, n, put_ms * 1e6 / n, hit_ms * 1e6 / n, miss_ms * 1e6 / n, (F64)compares / n, (long long)found);
+}
+
+static Void bench_sorted(I32 n) {
+    U64* keys = (U64*)m_alloc(sizeof(U64) * n);
+    I32* values = (I32*)m_alloc(sizeof(I32) * n);
+    for (I32 i = 0; i < n; ++i) {
+        keys[i] = bench_key(i);
+        values[i] = i;
+    }
+    m_Dict* dict = md_create_sorted(sizeof(U64), sizeof(I32), 0, u64_comparer);
+    F64 start = now_ms();
+    md_build_sorted(dict, keys, values, n);
+    F64 build_ms = now_ms() - start;
+
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        found += md_get(dict, &keys[i]) != NULL;
+    }
+    F64 hit_ms = now_ms() - start;
+    printf("%-8s n=%-8d build %7.2f ns  hit %9.2f ns  (%lld)\n",
+           "sorted", n, build_ms * 1e6 / n, hit_ms * 1e6 / n, (long long)found);
+    md_destroy(dict);
+    m_free(keys);
+    m_free(values);
+}
+
+static Void bench_frozen(I32 n) {
+    m_Dict* dict = md_create_swiss(sizeof(U64), sizeof(I32), n, NULL, u64_comparer);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &i);
+    }
+    F64 start = now_ms();
+    m_FrozenDict* frozen = md_freeze(dict);
+    F64 build_ms = now_ms() - start;
+
+    I64 found = 0;
+    compares = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        found += mf_get(frozen, &key) != NULL;
+    }
+    F64 hit_ms = now_ms() - start;
+    start = now_ms();
+    for (I32 i = n; i < 2 * n; ++i) {
+        U64 key = bench_key(i);
+        found += mf_has(frozen, &key);
+    }
+    F64 miss_ms = now_ms() - start;
+    printf("%-8s n=%-8d build %7.2f ns  hit %9.2f ns  miss %9.2f ns  compares/op %5.3f  bytes/entry %5.2f  (%lld)\n",
+           "frozen", n, build_ms * 1e6 / n, hit_ms * 1e6 / n, miss_ms * 1e6 / n, (F64)compares / (2 * n),
+           (F64)frozen->size / n, (long long)found);
+    mf_destroy(frozen);
+    md_destroy(dict);
+}
+
+static Void dict_benchmarks(Void) {
+    printf("--- m_Dict: U64 keys, I32 values ---\n");
+    I32 sizes[] = {1000, 20000, 200000};
+    for (I32 s = 0; s < m_countof(sizes); ++s) {
+        I32 n = sizes[s];
+        if (n <= 20000) {  // ml_find scans are quadratic to fill, keep them small
+            m_Dict* linear = md_create(sizeof(U64), sizeof(I32), 0, u64_comparer);
+            bench_dict("linear", linear, n);
+            md_destroy(linear);
+            m_Dict* bytes = md_create(sizeof(U64), sizeof(I32), 0, NULL);
+            bench_dict("bytes", bytes, n);
+            md_destroy(bytes);
+        }
+        m_Dict* hashed = md_create_hashed(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+        bench_dict("hashed", hashed, n);
+        md_destroy(hashed);
+
+        m_Dict* swiss = md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+        bench_dict("swiss", swiss, n);
+        md_destroy(swiss);
+
+        m_Dict* compact = md_create_compact(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+        bench_dict("compact", compact, n);
+        md_destroy(compact);
+
+        bench_sorted(n);
+        bench_frozen(n);
+    }
+}
+// Steady-state churn: remove the oldest key and insert a fresh one, like a connection table
+static Void bench_batch(CStr name, m_Dict* dict, I32 n, I32 lookups) {
+    U64* keys = (U64*)m_alloc(sizeof(U64) * lookups);
+    Void** values = (Void**)m_alloc(sizeof(Void*) * 4096);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &i);
+    }
+    for (I32 i = 0; i < lookups; ++i) {
+        keys[i] = bench_key((I32)(bench_key(i) % (U64)(2 * n)));  // Random order, half of them misses
+    }
+    I64 found = 0;
+    F64 start = now_ms();
+    for (I32 i = 0; i < lookups; ++i) {
+        found += md_get(dict, &keys[i]) != NULL;
+    }
+    F64 single_ms = now_ms() - start;
+    start = now_ms();
+    for (I32 i = 0; i < lookups; i += 4096) {
+        found += md_get_many(dict, keys + i, values, m_min(4096, lookups - i));
+    }
+    F64 batch_ms = now_ms() - start;
+    printf("%-8s n=%-8d get %9.2f ns  get_many %9.2f ns  (%lld)\n",
+           name, n, single_ms * 1e6 / lookups, batch_ms * 1e6 / lookups, (long long)found);
+    m_free(keys);
+    m_free(values);
+}
+
+static Void batch_benchmarks(Void) {
+    printf("--- m_Dict batches of 4096 lookups: U64 keys, I32 values ---\n");
+    m_Dict* linear = md_create(sizeof(U64), sizeof(I32), 0, u64_comparer);
+    bench_batch("linear", linear, 20000, 20000);
+    md_destroy(linear);
+    I32 sizes[] = {20000, 4000000};
+    for (I32 s = 0; s < m_countof(sizes); ++s) {
+        m_Dict* hashed = md_create_hashed(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+        bench_batch("hashed", hashed, sizes[s], 1000000);
+        md_destroy(hashed);
+        m_Dict* swiss = md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+        bench_batch("swiss", swiss, sizes[s], 1000000);
+        md_destroy(swiss);
+    }
+}
+
+static Void small_benchmarks(Void) {
+    printf("--- 8 U64 keys per dict: create, 8 puts, 64 gets, destroy ---\n");
+    I32 rounds = 200000;
+    U64 keys[8];
+    for (I32 i = 0; i < 8; ++i) {
+        keys[i] = bench_key(i);
+    }
+    I64 found = 0;
+    for (I32 variant = 0; variant < 3; ++variant) {
+        F64 start = now_ms();
+        for (I32 r = 0; r < rounds; ++r) {
+            if (variant == 0) {
+                m_SmallDict dict;
+                msd_init(&dict, sizeof(U64), sizeof(I32), NULL, NULL);
+                for (I32 i = 0; i < 8; ++i) msd_put(&dict, &keys[i], &i);
+                for (I32 i = 0; i < 64; ++i) found += msd_get(&dict, &keys[(i * 5 + r) & 7]) != NULL;
+                msd_clear(&dict);
+            } else {
+                m_Dict* dict = variant == 1 ? md_create(sizeof(U64), sizeof(I32), 0, u64_comparer)
+                                            : md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, NULL);
+                for (I32 i = 0; i < 8; ++i) md_put(dict, &keys[i], &i);
+                for (I32 i = 0; i < 64; ++i) found += md_get(dict, &keys[(i * 5 + r) & 7]) != NULL;
+                md_destroy(dict);
+            }
+        }
+        F64 ms = now_ms() - start;
+        CStr names[] = {"small", "linear", "swiss"};
+        printf("%-8s %9.2f ns/round  (%lld)\n", names[variant], ms * 1e6 / rounds, (long long)found);
+    }
+}
+
+static Void set_benchmarks(Void) {
+    I32 n = 1000000;
+    printf("--- %d U64 keys: set vs swiss dict with a 1-byte value, then intersect with half ---\n", n);
+    U8 one = 1;
+    I64 found = 0;
+    F64 start = now_ms();
+    m_Dict* dict = md_create_swiss(sizeof(U64), 1, 0, NULL, NULL);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &one);
+    }
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i * 2);
+        found += md_has(dict, &key);
+    }
+    printf("dict     %9.2f ms  (%lld)\n", now_ms() - start, (long long)found);
+    md_destroy(dict);
+    start = now_ms();
+    m_Set* set = mset_create(sizeof(U64), 0, NULL, NULL);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        mset_add(set, &key);
+    }
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i * 2);
+        found += mset_has(set, &key);
+    }
+    printf("set      %9.2f ms  (%lld)\n", now_ms() - start, (long long)found);
+    m_Set* half = mset_create(sizeof(U64), n / 2, NULL, NULL);
+    for (I32 i = 0; i < n; i += 2) {
+        U64 key = bench_key(i);
+        mset_add(half, &key);
+    }
+    start = now_ms();
+    mset_intersect(set, half);
+    printf("intersect %8.2f ms  (%d left)\n", now_ms() - start, mset_count(set));
+    mset_destroy(half);
+    mset_destroy(set);
+}
+
+static Void cache_benchmarks(Void) {
+    I32 cap = 10000, ops = 2000000;
+    printf("--- cache of %d over a skewed key stream with scans, %d gets (put on miss) ---\n", cap, ops);
+    m_CachePolicy policies[] = {M_CACHE_LRU, M_CACHE_CLOCK, M_CACHE_SIEVE};
+    CStr names[] = {"lru", "clock", "sieve"};
+    for (I32 p = 0; p < 3; ++p) {
+        m_Cache* cache = mcache_create(sizeof(U64), sizeof(U64), cap, policies[p], NULL, NULL);
+        U64 state = 42;
+        F64 start = now_ms();
+        for (I32 i = 0; i < ops; ++i) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            U32 r = (U32)(state >> 33);
+            // A hot set of 8k keys most of the time, otherwise a sequential scan of keys seen once
+            U64 key = (r & 7) ? bench_key((I32)(r % 8000)) : bench_key(1000000 + i);
+            if (!mcache_get(cache, &key)) {
+                mcache_put(cache, &key, &key);
+            }
+        }
+        F64 ms = now_ms() - start;
+        printf("%-8s %9.2f ns/op  hit rate %.1f%%\n", names[p], ms * 1e6 / ops,
+               100.0 * (F64)cache->hits / (F64)(cache->hits + cache->misses));
+        mcache_destroy(cache);
+    }
+}
+
+static Void filter_benchmarks(Void) {
+    I32 n = 1000000;
+    printf("--- %d U64 keys, lookups of absent keys: md_has vs a filter in front ---\n", n);
+    m_Dict* dict = md_create_swiss(sizeof(U64), sizeof(U64), n, NULL, NULL);
+    m_Filter* bloom = mfilter_create(M_FILTER_BLOOM, sizeof(U64), n, 0.01, NULL);
+    m_Filter* cuckoo = mfilter_create(M_FILTER_CUCKOO, sizeof(U64), n, 0.01, NULL);
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &key);
+        mfilter_add(bloom, &key);
+        mfilter_add(cuckoo, &key);
+    }
+    I64 found = 0;
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(n + i);
+        found += md_has(dict, &key);
+    }
+    printf("md_has   %9.2f ms  (%lld)\n", now_ms() - start, (long long)found);
+    m_Filter* filters[] = {bloom, cuckoo};
+    CStr names[] = {"bloom", "cuckoo"};
+    for (I32 f = 0; f < 2; ++f) {
+        found = 0;
+        start = now_ms();
+        for (I32 i = 0; i < n; ++i) {
+            U64 key = bench_key(n + i);
+            found += mfilter_test(filters[f], &key) && md_has(dict, &key);
+        }
+        printf("%-8s %9.2f ms  (%lld, %d bytes)\n", names[f], now_ms() - start, (long long)found,
+               filters[f]->blockcount * filters[f]->blocks.itemsize);
+    }
+    mfilter_destroy(bloom);
+    mfilter_destroy(cuckoo);
+    md_destroy(dict);
+}
+
+static Void btree_benchmarks(Void) {
+    I32 n = 200000;
+    printf("--- %d U64 keys in random order: sorted dict vs B-tree ---\n", n);
+    m_Dict* dict = md_create_sorted(sizeof(U64), sizeof(I32), 0, u64_comparer);
+    F64 start = now_ms();
+    for (I32 i = 0; i < n / 4; ++i) {     // A quarter of the keys, each insert is a memmove
+        U64 key = bench_key(i);
+        md_put(dict, &key, &i);
+    }
+    printf("sorted   insert %9.2f ns  (first %d keys)\n", (now_ms() - start) * 1e6 / (n / 4), n / 4);
+    md_destroy(dict);
+    m_BTree* tree = mbt_create(sizeof(U64), sizeof(I32), u64_comparer);
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        mbt_put(tree, &key, &i);
+    }
+    printf("btree    insert %9.2f ns\n", (now_ms() - start) * 1e6 / n);
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        found += mbt_get(tree, &key) != NULL;
+    }
+    printf("btree    get    %9.2f ns  (%lld)\n", (now_ms() - start) * 1e6 / n, (long long)found);
+    U64 lo = 1ull << 62, hi = 3ull << 62;
+    Void* key;
+    found = 0;
+    start = now_ms();
+    m_BTreeCursor cursor = mbt_range(tree, &lo, &hi);
+    while (mbt_next(&cursor, &key, NULL)) {
+        found++;
+    }
+    printf("btree    scan   %9.2f ms  (%lld keys)\n", now_ms() - start, (long long)found);
+    start = now_ms();
+    found = mbt_remove_range(tree, &lo, &hi);
+    printf("btree    range delete %6.2f ms  (%lld keys)\n", now_ms() - start, (long long)found);
+    mbt_destroy(tree);
+}
+
+static Void art_benchmarks(Void) {
+    I32 routes = 2000, lookups = 200000;
+    printf("--- %d route prefixes, %d longest-prefix lookups: list scan vs adaptive radix tree ---\n", routes, lookups);
+    m_List* list = ml_create(sizeof(CStr), routes, NULL);
+    m_Art* art = mart_create(sizeof(I32));
+    Str text = (Str)m_alloc((Sz)routes * 32);
+    for (I32 i = 0; i < routes; ++i) {
+        Str route = text + (Sz)i * 32;
+        snprintf(route, 32, "/svc%d/v%d/", i % 97, i);
+        ml_push(list, &route);
+        mart_put(art, route, (I32)strlen(route), &i);
+    }
+    char path[64];
+    I64 found = 0;
+    F64 start = now_ms();
+    for (I32 q = 0; q < lookups / 20; ++q) {      // The scan is slow, time a twentieth of the queries
+        snprintf(path, sizeof(path), "/svc%d/v%d/items/%d", (q * 7) % routes % 97, (q * 7) % routes, q);
+        I32 best = -1, bestlen = 0, pathlen = (I32)strlen(path);
+        for (I32 i = 0; i < routes; ++i) {
+            CStr route = *(CStr*)ml_get(list, i);
+            I32 len = (I32)strlen(route);
+            if (len <= pathlen && len > bestlen && strncmp(route, path, len) == 0) {
+                best = i;
+                bestlen = len;
+            }
+        }
+        found += best >= 0;
+    }
+    printf("scan     %9.2f ns/lookup  (%lld)\n", (now_ms() - start) * 1e6 / (lookups / 20), (long long)found);
+    found = 0;
+    start = now_ms();
+    for (I32 q = 0; q < lookups; ++q) {
+        snprintf(path, sizeof(path), "/svc%d/v%d/items/%d", (q * 7) % routes % 97, (q * 7) % routes, q);
+        I32 matched;
+        found += mart_longest_prefix(art, path, (I32)strlen(path), &matched) != NULL;
+    }
+    printf("art      %9.2f ns/lookup  (%lld, snprintf included)\n", (now_ms() - start) * 1e6 / lookups, (long long)found);
+    mart_destroy(art);
+    ml_destroy(list);
+    m_free(text);
+}
+
+static Void mapped_benchmarks(Void) {
+    I32 n = 1000000;
+    printf("--- cold start of %d U64 -> I32 entries: parse text and md_put vs md_map ---\n", n);
+    Str text = (Str)m_alloc((Sz)n * 32);
+    Sz length = 0;
+    for (I32 i = 0; i < n; ++i) {
+        length += (Sz)sprintf(text + length, "%llu %d\n", (unsigned long long)bench_key(i), i);
+    }
+    F64 start = now_ms();
+    m_Dict* dict = md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, NULL);
+    for (Str line = text; line < text + length; ) {
+        U64 key = strtoull(line, &line, 10);
+        I32 value = (I32)strtol(line, &line, 10);
+        md_put(dict, &key, &value);
+        line++;
+    }
+    printf("parse    %9.2f ms\n", now_ms() - start);
+
+    CStr path = "bench_mapped.bin";
+    start = now_ms();
+    md_save(dict, path);
+    printf("save     %9.2f ms\n", now_ms() - start);
+    md_destroy(dict);
+
+    start = now_ms();
+    m_FrozenDict* mapped = md_map(path, NULL, NULL, false);
+    F64 map_ms = now_ms() - start;
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        found += mf_get(mapped, &key) != NULL;
+    }
+    printf("map      %9.2f ms  first pass hit %6.2f ns  (%lld)\n", map_ms, (now_ms() - start) * 1e6 / n,
+           (long long)found);
+    mf_destroy(mapped);
+    start = now_ms();
+    mapped = md_map(path, NULL, NULL, true);
+    printf("verify   %9.2f ms\n", now_ms() - start);
+    mf_destroy(mapped);
+    remove(path);
+    m_free(text);
+}
+
+static Void bench_churn(CStr name, m_Dict* dict, I32 live, I32 ops) {
+    for (I32 i = 0; i < live; ++i) {
+        U64 key = bench_key(i);
+        md_put(dict, &key, &i);
+    }
+    F64 start = now_ms();
+    for (I32 i = live; i < live + ops; ++i) {
+        U64 old = bench_key(i - live);
+        U64 key = bench_key(i);
+        md_remove(dict, &old);
+        md_put(dict, &key, &i);
+    }
+    F64 churn_ms = now_ms() - start;
+
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = ops; i < live + ops; ++i) {
+        U64 key = bench_key(i);
+        found += md_get(dict, &key) != NULL;
+    }
+    F64 hit_ms = now_ms() - start;
+
+    m_DictStats stats;
+    md_stats(dict, &stats);
+    printf("%-10s live=%-7d churn %7.2f ns/op  hit %6.2f ns  probes mean %.2f max %d  deleted %d  (%lld)\n",
+           name, live, churn_ms * 1e6 / ops, hit_ms * 1e6 / live, stats.meanprobe, stats.maxprobe,
+           stats.deleted, (long long)found);
+}
+
+static Void churn_benchmarks(Void) {
+    printf("--- m_Dict churn: remove + put per op ---\n");
+    I32 live = 100000;
+    I32 ops = 2000000;
+    m_Dict* hashed = md_create_hashed(sizeof(U64), sizeof(I32), live, NULL, NULL);
+    bench_churn("hashed", hashed, live, ops);
+    md_destroy(hashed);
+
+    m_Dict* swiss = md_create_swiss(sizeof(U64), sizeof(I32), live, NULL, NULL);
+    bench_churn("swiss", swiss, live, ops);
+    md_destroy(swiss);
+
+    m_Dict* robinhood = md_create_robinhood(sizeof(U64), sizeof(I32), live, NULL, NULL);
+    bench_churn("robinhood", robinhood, live, ops);
+    md_destroy(robinhood);
+}
+#pragma endregion
+
+#pragma region Resize Latency Benchmarks
+
+// Times every md_put while a table grows to n entries; resizes show up as the worst single operation
+static Void bench_resize(CStr name, m_Dict* dict, I32 n) {
+    F64 worst = 0;
+    I32 slow = 0;
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        U64 key = bench_key(i);
+        F64 opstart = now_ms();
+        md_put(dict, &key, &i);
+        F64 op = now_ms() - opstart;
+        worst = op > worst ? op : worst;
+        slow += op > 0.1;
+    }
+    F64 total = now_ms() - start;
+    printf("%-14s n=%-8d put %7.2f ns  worst %8.3f ms  ops over 100us %d\n",
+           name, n, total * 1e6 / n, worst, slow);
+}
+
+static Void resize_benchmarks(Void) {
+    printf("--- m_Dict growth: worst single md_put, stop-the-world vs incremental resize ---\n");
+    I32 n = 4000000;
+    m_Dict* swiss = md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+    bench_resize("swiss", swiss, n);
+    md_destroy(swiss);
+    swiss = md_create_swiss(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+    md_setrehashbudget(swiss, 64);
+    bench_resize("swiss/64", swiss, n);
+    md_destroy(swiss);
+
+    m_Dict* hashed = md_create_hashed(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+    bench_resize("hashed", hashed, n);
+    md_destroy(hashed);
+    hashed = md_create_hashed(sizeof(U64), sizeof(I32), 0, NULL, u64_comparer);
+    md_setrehashbudget(hashed, 64);
+    bench_resize("hashed/64", hashed, n);
+    md_destroy(hashed);
+}
+
+#pragma endregion
+
+#pragma region String Key Benchmarks
+
+static Void str_benchmarks(Void) {
+    printf("--- string keys: Str pointer dict vs string dict ---\n");
+    I32 n = 200000;
+    Str* names = (Str*)m_alloc(sizeof(Str) * n);
+    Str* queries = (Str*)m_alloc(sizeof(Str) * n);  // Lookups come from other buffers than the inserts
+    for (I32 i = 0; i < n; ++i) {
+        names[i] = (Str)m_alloc(32);
+        snprintf(names[i], 32, "x-header-%llx", (unsigned long long)bench_key(i));
+    }
+    for (I32 i = 0; i < n; ++i) {
+        queries[i] = (Str)m_alloc(32);
+        strcpy(queries[i], names[(I32)(((I64)i * 7919) % n)]);
+    }
+
+    m_Dict* ptrs = md_create_hashed(sizeof(Str), sizeof(I32), 0, m_hash_str, m_compare_str);
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        md_put(ptrs, &names[i], &i);
+    }
+    F64 put_ms = now_ms() - start;
+    I64 found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        found += md_get(ptrs, &queries[i]) != NULL;
+    }
+    F64 hit_ms = now_ms() - start;
+    printf("%-8s n=%-8d put %9.2f ns  hit %9.2f ns  (%lld)\n", "hashed", n, put_ms * 1e6 / n, hit_ms * 1e6 / n, (long long)found);
+    md_destroy(ptrs);
+
+    m_Dict* strs = md_create_str(sizeof(I32), 0);
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        md_put(strs, names[i], &i);
+    }
+    put_ms = now_ms() - start;
+    found = 0;
+    start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        found += md_get(strs, queries[i]) != NULL;
+    }
+    hit_ms = now_ms() - start;
+    printf("%-8s n=%-8d put %9.2f ns  hit %9.2f ns  (%lld)\n", "str", n, put_ms * 1e6 / n, hit_ms * 1e6 / n, (long long)found);
+    md_destroy(strs);
+
+    for (I32 i = 0; i < n; ++i) {
+        m_free(names[i]);
+        m_free(queries[i]);
+    }
+    m_free(names);
+    m_free(queries);
+}
+#pragma endregion
+
+#pragma region Concurrent Dictionary Benchmarks
+
+typedef struct ThreadBench {
+    m_Dict* dict;               // global-mutex baseline when set
+    pthread_mutex_t* mutex;
+    m_ConcurrentDict* cdict;
+    m_SharedDict* sdict;        // stands in for worker processes sharing one segment
+    I32 keyspace;
+    I32 ops;
+    U64 seed;
+    I64 found;
+} ThreadBench;
+
+// 90% gets, 10% puts over a shared key space
+static Void* thread_bench_worker(Void* arg) {
+    ThreadBench* b = (ThreadBench*)arg;
+    U64 x = b->seed;
+    I64 found = 0;
+    for (I32 i = 0; i < b->ops; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        U64 key = bench_key((I32)(x % (U64)b->keyspace));
+        I32 value = i;
+        Bool write = (x >> 40) % 10 == 0;
+        if (b->cdict) {
+            if (write) {
+                mcd_put(b->cdict, &key, &value);
+            } else {
+                found += mcd_get(b->cdict, &key, &value);
+            }
+        } else if (b->sdict) {
+            if (write) {
+                mshd_put(b->sdict, &key, &value);
+            } else {
+                found += mshd_get(b->sdict, &key, &value);
+            }
+        } else {
+            pthread_mutex_lock(b->mutex);
+            if (write) {
+                md_put(b->dict, &key, &value);
+            } else {
+                found += md_get(b->dict, &key) != NULL;
+            }
+            pthread_mutex_unlock(b->mutex);
+        }
+    }
+    b->found = found;
+    return NULL;
+}
+
+static F64 run_threads(m_Dict* dict, pthread_mutex_t* mutex, m_ConcurrentDict* cdict, m_SharedDict* sdict,
+                       I32 nthreads, I32 ops) {
+    pthread_t threads[32];
+    ThreadBench benches[32];
+    F64 start = now_ms();
+    for (I32 t = 0; t < nthreads; ++t) {
+        benches[t] = (ThreadBench){dict, mutex, cdict, sdict, 1 << 20, ops, 0x9e3779b97f4a7c15ull * (t + 1), 0};
+        pthread_create(&threads[t], NULL, thread_bench_worker, &benches[t]);
+    }
+    for (I32 t = 0; t < nthreads; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    F64 ms = now_ms() - start;
+    return (F64)nthreads * ops / ms / 1e3;  // Mops/s
+}
+
+static Void concurrent_benchmarks(Void) {
+    printf("--- concurrent dicts: 90%% get / 10%% put, Mops/s by thread count ---\n");
+    I32 ops = 500000;
+    I32 counts[] = {1, 2, 4, 8, 16, 32};
+    printf("%-18s", "threads");
+    for (I32 c = 0; c < m_countof(counts); ++c) {
+        printf("%8d", counts[c]);
+    }
+    printf("\n");
+    for (I32 variant = 0; variant < 4; ++variant) {
+        CStr names[] = {"global mutex", "sharded mutex", "sharded rwlock", "shared segment"};
+        printf("%-18s", names[variant]);
+        for (I32 c = 0; c < m_countof(counts); ++c) {
+            F64 mops;
+            if (variant == 0) {
+                pthread_mutex_t mutex;
+                pthread_mutex_init(&mutex, NULL);
+                m_Dict* dict = md_create_swiss(sizeof(U64), sizeof(I32), 1 << 20, NULL, NULL);
+                mops = run_threads(dict, &mutex, NULL, NULL, counts[c], ops);
+                md_destroy(dict);
+                pthread_mutex_destroy(&mutex);
+            } else if (variant == 3) {
+                m_SharedDict* sdict = mshd_create("/mg_bench_shared", sizeof(U64), sizeof(I32), 1 << 20, NULL, NULL);
+                mops = run_threads(NULL, NULL, NULL, sdict, counts[c], ops);
+                mshd_destroy(sdict);
+                mshd_unlink("/mg_bench_shared");
+            } else {
+                m_ConcurrentDict* cdict = mcd_create(sizeof(U64), sizeof(I32), 1 << 20, 64, variant == 2, NULL, NULL);
+                mops = run_threads(NULL, NULL, cdict, NULL, counts[c], ops);
+                mcd_destroy(cdict);
+            }
+            printf("%8.2f", mops);
+        }
+        printf("\n");
+    }
+}
+#pragma endregion
+
+#pragma region Hash Benchmarks
+
+static Void bench_hasher(CStr name, m_ItemHasher hasher, Void* items, I32 itemsize, I32 n) {
+    U64 acc = 0;
+    F64 start = now_ms();
+    for (I32 i = 0; i < n; ++i) {
+        acc += hasher((U8*)items + (Sz)(i & 1023) * itemsize, itemsize, acc);
+    }
+    F64 ms = now_ms() - start;
+    printf("%-12s %9.2f ns/hash  (%llx)\n", name, ms * 1e6 / n, (unsigned long long)(acc & 0xff));
+}
+
+static Void hash_benchmarks(Void) {
+    printf("--- hashers ---\n");
+    static U8 items[1024 * 64];
+    static Str strs[1024];
+    for (I32 i = 0; i < (I32)sizeof(items); ++i) {
+        items[i] = (U8)bench_key(i);
+    }
+    for (I32 i = 0; i < 1024; ++i) {
+        strs[i] = "x-forwarded-for-header" + (i % 16);
+    }
+    I32 n = 10000000;
+    bench_hasher("u32", m_hash_u32, items, 4, n);
+    bench_hasher("bytes(4)", m_hash_bytes, items, 4, n);
+    bench_hasher("u64", m_hash_u64, items, 8, n);
+    bench_hasher("bytes(8)", m_hash_bytes, items, 8, n);
+    bench_hasher("u128", m_hash_u128, items, 16, n);
+    bench_hasher("bytes(64)", m_hash_bytes, items, 64, n);
+    bench_hasher("str", m_hash_str, strs, sizeof(Str), n);
+}
+#pragma endregion
+
+int main(int argc, char** argv) {
+    hash_benchmarks();
+    list_benchmarks();
+    sort_benchmarks();
+    dict_benchmarks();
+    batch_benchmarks();
+    small_benchmarks();
+    set_benchmarks();
+    cache_benchmarks();
+    filter_benchmarks();
+    btree_benchmarks();
+    art_benchmarks();
+    mapped_benchmarks();
+    churn_benchmarks();
+    resize_benchmarks();
+    str_benchmarks();
+    concurrent_benchmarks();
+    return 0;
+}
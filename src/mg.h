@@ -1,9 +1,25 @@
 #ifndef _MG_H
 #define _MG_H
 
+// POSIX.1-2008 with XSI, so rwlocks, robust mutexes, ftruncate and nanosleep stay visible under -std=c99
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
+
+// Threaded containers need pthreads, so they are built on POSIX targets unless M_DISABLE_THREADS is defined
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(M_DISABLE_THREADS)
+#define M_THREADS
+#endif
+
+// Files and shared memory are mapped with mmap on the same targets unless M_DISABLE_MMAP is defined
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(M_DISABLE_MMAP)
+#define M_MMAP
+#endif
 
 #ifndef M_DISABLE_ASSERTS
 #include <assert.h>
@@ -72,23 +88,208 @@ typedef struct m_Buffer {
 } m_Buffer;
 
 typedef I32 (*m_ItemComparer)(Void* item1, Void* item2);
+typedef U64 (*m_ItemHasher)(Void* item, I32 itemsize, U64 seed);
 
 typedef struct m_List {
     m_Buffer buffer;
     I32 count;
     m_ItemComparer comparer;
+    I32 growth;         // capacity after growing, in percent of the old one; 0 means 200
 } m_List;
 
-typedef struct m_Dict {
-    m_List keys;
-    m_List values;
-} m_Dict;
+typedef enum m_RadixKey {
+    M_RADIX_U32,
+    M_RADIX_I32,
+    M_RADIX_F32,
+    M_RADIX_U64,
+    M_RADIX_I64,
+    M_RADIX_F64,
+} m_RadixKey;
 
 typedef struct m_StrBuffer {
     m_Buffer buffer;
     I32 length;
 } m_StrBuffer;
 
+typedef enum m_DictMode {
+    M_DICT_LINEAR,      // keys/values are dense lists, lookups scan with the comparer
+    M_DICT_HASHED,      // keys/values are slot arrays indexed by an open-addressing table
+    M_DICT_SWISS,       // like M_DICT_HASHED, probed 16 control bytes at a time
+    M_DICT_ROBINHOOD,   // like M_DICT_HASHED, with Robin Hood displacement and backward-shift deletion
+    M_DICT_STRING,      // swiss table keyed by C strings copied into an owned arena
+    M_DICT_SORTED,      // keys/values are dense lists kept in key order, lookups binary search
+    M_DICT_COMPACT,     // keys/values are dense lists in insertion order, found through an I32 hash index
+} m_DictMode;
+
+typedef struct m_Dict {
+    m_List keys;
+    m_List values;
+    m_DictMode mode;
+    m_ItemHasher hasher;
+    U64 seed;
+    m_Buffer slots;     // per-slot hash tags or control bytes for the hashed modes, dense indexes for compact
+    I32 used;           // live + deleted slots
+    I32 maxload;        // max load factor in percent
+    m_StrBuffer arena;  // key bytes for the string mode
+    struct m_Dict* old; // table still being drained by an incremental resize, NULL otherwise
+    I32 cleared;        // bytes of the new slot array zeroed so far; the new table is used once all are
+    I32 migrated;       // old slots drained so far, counted from migratestart
+    I32 migratestart;
+    I32 rehashbudget;   // old slots drained per write, 0 resizes in one go
+} m_Dict;
+
+#define M_PROBE_HIST_SIZE 16
+
+typedef struct m_DictStats {
+    I32 count;
+    I32 slots;
+    I32 deleted;                        // tombstones waiting for the next rehash
+    I32 maxprobe;                       // slots (groups for swiss) visited to reach the farthest key
+    F64 meanprobe;
+    I32 probehist[M_PROBE_HIST_SIZE];   // keys by probe length, the last bucket counts longer probes too
+} m_DictStats;
+
+typedef struct m_FrozenDict {
+    Void* data;         // header, displacements, keys and values in one position independent blob
+    Sz size;
+    Bool owned;         // false when the blob belongs to the caller, e.g. a mapped file
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+    U32* disps;         // views into data
+    U8* keys;
+    U8* values;
+    I32 count;
+    I32 keysize;
+    I32 valuesize;
+    I32 bucketcount;
+    U64 seed;
+    Void* file;         // whole file behind md_map, released by mf_destroy; NULL otherwise
+    Sz filesize;
+} m_FrozenDict;
+
+typedef struct m_Set {
+    m_Dict dict;        // swiss table with no value storage
+} m_Set;
+
+typedef enum m_CachePolicy {
+    M_CACHE_LRU,        // evicts the least recently used entry
+    M_CACHE_CLOCK,      // second chance around a ring, a hit only sets a visited bit
+    M_CACHE_SIEVE,      // second chance over insertion order, survivors keep their place
+} m_CachePolicy;
+
+typedef Void (*m_CacheEvictor)(Void* key, Void* value, Void* context);
+
+typedef struct m_Cache {
+    m_Dict index;       // key -> entry, Robin Hood so deletes leave no tombstones
+    m_Buffer keys;
+    m_Buffer values;
+    m_Buffer links;     // newer/older I32 pairs for LRU and SIEVE, newest at head
+    m_Buffer marks;     // visited bits for CLOCK and SIEVE
+    I32 count;
+    I32 cap;
+    I32 head;
+    I32 tail;
+    I32 hand;
+    m_CachePolicy policy;
+    m_CacheEvictor evictor;
+    Void* context;
+    I64 hits;
+    I64 misses;
+    I64 evictions;
+} m_Cache;
+
+typedef enum m_FilterMode {
+    M_FILTER_BLOOM,     // split block Bloom filter, 32-byte blocks of eight U32 words, no removal
+    M_FILTER_CUCKOO,    // cuckoo filter, buckets of four U16 fingerprints, supports removal
+} m_FilterMode;
+
+typedef struct m_Filter {
+    m_Buffer blocks;    // Bloom blocks or cuckoo buckets, zeroed on init
+    m_FilterMode mode;
+    I32 keysize;
+    I32 count;
+    I32 blockcount;
+    I32 victim;         // cuckoo bucket of a fingerprint that found no room, -1 if none
+    U32 victimtag;
+    U64 seed;
+    m_ItemHasher hasher;
+} m_Filter;
+
+#define M_BTREE_NODE_BYTES  256     // key bytes per node, four cache lines
+
+typedef struct m_BTree {
+    Void* root;         // NULL while empty
+    I32 keysize;
+    I32 valuesize;
+    I32 order;          // max keys per node
+    I32 count;
+    m_ItemComparer comparer;
+    U8* scratch;        // one key, carries separators up through splits
+} m_BTree;
+
+typedef struct m_BTreeCursor {
+    m_BTree* tree;
+    Void* node;         // current leaf, NULL once past the end
+    I32 index;
+    Void* end;          // exclusive upper key, NULL for none
+} m_BTreeCursor;
+
+typedef struct m_Art {
+    Void* root;         // NULL while empty
+    I32 valuesize;
+    I32 count;
+} m_Art;
+
+typedef Bool (*m_ArtVisitor)(Void* key, I32 keylen, Void* value, Void* context);
+
+#define M_SMALL_DICT_CAP    16
+#define M_SMALL_DICT_BYTES  128     // inline bytes for keys and again for values
+
+typedef struct m_SmallDict {
+    I32 keysize;
+    I32 valuesize;
+    I32 count;
+    I32 cap;            // inline entries that fit, at most M_SMALL_DICT_CAP
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+    m_Dict* spill;      // swiss dict holding every entry after an overflow, NULL while inline
+    U64 keys[M_SMALL_DICT_BYTES / sizeof(U64)];
+    U64 values[M_SMALL_DICT_BYTES / sizeof(U64)];
+} m_SmallDict;
+
+typedef struct m_ConcurrentDict {
+    Void* shards;       // shardcount cache-line aligned (m_Dict, lock) pairs
+    Void* memory;
+    I32 shardcount;
+    I32 keysize;
+    Bool rwlocks;
+    m_ItemHasher hasher;
+} m_ConcurrentDict;
+
+typedef struct m_ReadDict {
+    Void* table;        // published m_Dict snapshot, replaced atomically by writers
+    U64 epoch;
+    I32 count;
+    I32 maxreaders;
+    Void* readers;      // one cache line per registered reader
+    Void* writelock;
+    Void* memory;
+    m_List retired;     // replaced tables waiting for readers to leave their epoch
+} m_ReadDict;
+
+typedef struct m_SharedDict {
+    Void* segment;      // POSIX shared memory: header, slot tags, keys and values, found through offsets
+    Sz size;
+    U32* tags;          // views into this process's mapping of the segment
+    U8* keys;
+    U8* values;
+    I32 keysize;
+    I32 valuesize;
+    I32 mask;
+    m_ItemHasher hasher;
+    m_ItemComparer comparer;
+} m_SharedDict;
+
 typedef enum m_LogLevel {
     M_LOG_TRACE,
     M_LOG_INFO,
@@ -117,6 +318,11 @@ IErr ml_init(m_List* list, I32 itemsize, I32 itemcap, m_ItemComparer comparer);
 IErr ml_setcap(m_List* list, I32 newcap);
 Void ml_clear(m_List* list);
 IErr ml_push(m_List* list, Void* item);
+IErr ml_push_many(m_List* list, Void* items, I32 n);
+Void* ml_emplace(m_List* list);
+Void* ml_extend_uninit(m_List* list, I32 n);
+IErr ml_reserve(m_List* list, I32 n);
+IErr ml_setgrowth(m_List* list, I32 percent);
 Void* ml_pop(m_List* list);
 Void* ml_get(m_List* list, I32 index);
 IErr ml_put(m_List* list, I32 index, Void* item);
@@ -126,7 +332,247 @@ IErr ml_remove_range(m_List* list, I32 startindex, I32 count);
 IErr ml_remove_swap(m_List* list, I32 index);
 I32 ml_count(m_List* list);
 I32 ml_find(m_List* list, Void* item);
+I32 ml_find_bytes(m_List* list, Void* item);
+IErr ml_find_all(m_List* list, Void* item, m_List* indexes);
+I32 ml_count_eq(m_List* list, Void* item);
 Void ml_sort(m_List* list);
+Void ml_sort_pdq(m_List* list);
+IErr ml_sort_radix(m_List* list, I32 keyoffset, m_RadixKey keytype);
+IErr ml_argsort(m_List* list, I32* order);
+IErr ml_apply_permutation(m_List* list, I32* order);
+
+// Sort functions
+// M_SORT_DEFINE(T, name, less) defines static Void name(T* items, I32 n, Void* context), a pattern-defeating
+// quicksort (Orson Peters' pdqsort) with less(T* a, T* b, Void* context) expanded at every comparison.
+// Median-of-3 pivots (ninther above 128 items), insertion sort below 24, a partial insertion sort after
+// partitions that moved nothing, so sorted and reversed runs finish in linear time, an equal-keys partition
+// when the pivot repeats, and heapsort after log2(n) badly balanced partitions. Not stable.
+#define M_SORT_DEFINE(T, name, less)                                                            \
+static inline Void name##_swap(T* a, I32 i, I32 j) {                                            \
+    T tmp = a[i];                                                                               \
+    a[i] = a[j];                                                                                \
+    a[j] = tmp;                                                                                 \
+}                                                                                               \
+static inline Void name##_sort2(T* a, I32 i, I32 j, Void* context) {                            \
+    if (less(&a[j], &a[i], context)) {                                                          \
+        name##_swap(a, i, j);                                                                   \
+    }                                                                                           \
+}                                                                                               \
+static inline Void name##_sort3(T* a, I32 i, I32 j, I32 k, Void* context) {                     \
+    name##_sort2(a, i, j, context);                                                             \
+    name##_sort2(a, j, k, context);                                                             \
+    name##_sort2(a, i, j, context);                                                             \
+}                                                                                               \
+static Bool name##_insertion(T* a, I32 lo, I32 hi, I32 limit, Void* context) {                  \
+    I32 moved = 0;                                                                              \
+    for (I32 i = lo + 1; i < hi; ++i) {                                                         \
+        if (less(&a[i], &a[i - 1], context)) {                                                  \
+            T tmp = a[i];                                                                       \
+            I32 j = i;                                                                          \
+            do {                                                                                \
+                a[j] = a[j - 1];                                                                \
+                --j;                                                                            \
+            } while (j > lo && less(&tmp, &a[j - 1], context));                                 \
+            a[j] = tmp;                                                                         \
+            moved += i - j;                                                                     \
+            if (moved > limit) {                                                                \
+                return false;                                                                   \
+            }                                                                                   \
+        }                                                                                       \
+    }                                                                                           \
+    return true;                                                                                \
+}                                                                                               \
+static Void name##_siftdown(T* h, I32 root, I32 n, Void* context) {                             \
+    for (I32 child = 2 * root + 1; child < n; child = 2 * root + 1) {                           \
+        if (child + 1 < n && less(&h[child], &h[child + 1], context)) {                         \
+            child++;                                                                            \
+        }                                                                                       \
+        if (!less(&h[root], &h[child], context)) {                                              \
+            return;                                                                             \
+        }                                                                                       \
+        name##_swap(h, root, child);                                                            \
+        root = child;                                                                           \
+    }                                                                                           \
+}                                                                                               \
+static Void name##_heapsort(T* h, I32 n, Void* context) {                                       \
+    for (I32 i = n / 2 - 1; i >= 0; --i) {                                                      \
+        name##_siftdown(h, i, n, context);                                                      \
+    }                                                                                           \
+    for (I32 i = n - 1; i > 0; --i) {                                                           \
+        name##_swap(h, 0, i);                                                                   \
+        name##_siftdown(h, 0, i, context);                                                      \
+    }                                                                                           \
+}                                                                                               \
+static I32 name##_partition_right(T* a, I32 lo, I32 hi, Bool* partitioned, Void* context) {     \
+    T pivot = a[lo];                                                                            \
+    I32 first = lo;                                                                             \
+    I32 last = hi;                                                                              \
+    while (++first, less(&a[first], &pivot, context));                                          \
+    if (first - 1 == lo) {                                                                      \
+        while (first < last && (--last, !less(&a[last], &pivot, context)));                     \
+    } else {                                                                                    \
+        while (--last, !less(&a[last], &pivot, context));                                       \
+    }                                                                                           \
+    *partitioned = first >= last;                                                               \
+    while (first < last) {                                                                      \
+        name##_swap(a, first, last);                                                            \
+        while (++first, less(&a[first], &pivot, context));                                      \
+        while (--last, !less(&a[last], &pivot, context));                                       \
+    }                                                                                           \
+    a[lo] = a[first - 1];                                                                       \
+    a[first - 1] = pivot;                                                                       \
+    return first - 1;                                                                           \
+}                                                                                               \
+static I32 name##_partition_left(T* a, I32 lo, I32 hi, Void* context) {                         \
+    T pivot = a[lo];                                                                            \
+    I32 first = lo;                                                                             \
+    I32 last = hi;                                                                              \
+    while (--last, less(&pivot, &a[last], context));                                            \
+    if (last + 1 == hi) {                                                                       \
+        while (first < last && (++first, !less(&pivot, &a[first], context)));                   \
+    } else {                                                                                    \
+        while (++first, !less(&pivot, &a[first], context));                                     \
+    }                                                                                           \
+    while (first < last) {                                                                      \
+        name##_swap(a, first, last);                                                            \
+        while (--last, less(&pivot, &a[last], context));                                        \
+        while (++first, !less(&pivot, &a[first], context));                                     \
+    }                                                                                           \
+    a[lo] = a[last];                                                                            \
+    a[last] = pivot;                                                                            \
+    return last;                                                                                \
+}                                                                                               \
+static Void name##_loop(T* a, I32 lo, I32 hi, I32 bad, Bool leftmost, Void* context) {          \
+    for (;;) {                                                                                  \
+        I32 size = hi - lo;                                                                     \
+        if (size < 24) {                                                                        \
+            name##_insertion(a, lo, hi, size * size, context);                                  \
+            return;                                                                             \
+        }                                                                                       \
+        I32 half = size / 2;                                                                    \
+        if (size > 128) {                                                                       \
+            name##_sort3(a, lo, lo + half, hi - 1, context);                                    \
+            name##_sort3(a, lo + 1, lo + half - 1, hi - 2, context);                            \
+            name##_sort3(a, lo + 2, lo + half + 1, hi - 3, context);                            \
+            name##_sort3(a, lo + half - 1, lo + half, lo + half + 1, context);                  \
+            name##_swap(a, lo, lo + half);                                                      \
+        } else {                                                                                \
+            name##_sort3(a, lo + half, lo, hi - 1, context);                                    \
+        }                                                                                       \
+        if (!leftmost && !less(&a[lo - 1], &a[lo], context)) {                                  \
+            lo = name##_partition_left(a, lo, hi, context) + 1;                                 \
+            continue;                                                                           \
+        }                                                                                       \
+        Bool partitioned;                                                                       \
+        I32 pos = name##_partition_right(a, lo, hi, &partitioned, context);                     \
+        I32 lsize = pos - lo;                                                                   \
+        I32 rsize = hi - pos - 1;                                                               \
+        if (lsize < size / 8 || rsize < size / 8) {                                             \
+            if (--bad == 0) {                                                                   \
+                name##_heapsort(a + lo, size, context);                                         \
+                return;                                                                         \
+            }                                                                                   \
+            if (lsize >= 24) {                                                                  \
+                name##_swap(a, lo, lo + lsize / 4);                                             \
+                name##_swap(a, pos - 1, pos - lsize / 4);                                       \
+            }                                                                                   \
+            if (rsize >= 24) {                                                                  \
+                name##_swap(a, pos + 1, pos + 1 + rsize / 4);                                   \
+                name##_swap(a, hi - 1, hi - rsize / 4);                                         \
+            }                                                                                   \
+        } else if (partitioned && name##_insertion(a, lo, pos, 8, context)                      \
+                   && name##_insertion(a, pos + 1, hi, 8, context)) {                           \
+            return;                                                                             \
+        }                                                                                       \
+        if (lsize < rsize) {                                                                    \
+            name##_loop(a, lo, pos, bad, leftmost, context);                                    \
+            lo = pos + 1;                                                                       \
+            leftmost = false;                                                                   \
+        } else {                                                                                \
+            name##_loop(a, pos + 1, hi, bad, false, context);                                   \
+            hi = pos;                                                                           \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+static Void name(T* items, I32 n, Void* context) {                                              \
+    I32 bad = 1;                                                                                \
+    for (I32 m = n; m > 1; m >>= 1) {                                                           \
+        bad++;                                                                                  \
+    }                                                                                           \
+    if (n > 1) {                                                                                \
+        name##_loop(items, 0, n, bad, true, context);                                           \
+    }                                                                                           \
+}
+
+// Typed list functions
+// M_LIST_DEFINE(I32, IntList) declares IntList, a wrapper around m_List that any ml_ function accepts
+// through &l->list, plus static inline IntList_push/get/at/put/find/count whose item size is a compile-time
+// constant and whose comparer is expanded in place. cmp takes two T* and returns 0 when they are equal;
+// M_LIST_DEFINE compares bytes, so use M_LIST_DEFINE_CMP for floats or padded structs. M_LIST_DEFINE leaves
+// the list's runtime comparer NULL, so ml_find matches bytes with SIMD; ml_sort and the other ordering
+// functions need M_LIST_DEFINE_CMP with a cmp that returns a sign.
+#define M_LIST_CMP_BYTES(a, b)      memcmp((a), (b), sizeof(*(a)))
+#define M_LIST_DEFINE(T, Name)      M_LIST_DEFINE_IMPL(T, Name, M_LIST_CMP_BYTES, NULL)
+#define M_LIST_DEFINE_CMP(T, Name, cmp) M_LIST_DEFINE_IMPL(T, Name, cmp, Name##_comparer)
+
+#define M_LIST_DEFINE_IMPL(T, Name, cmp, runtime)                                               \
+typedef struct Name {                                                                           \
+    m_List list;                                                                                \
+} Name;                                                                                         \
+static inline I32 Name##_comparer(Void* item1, Void* item2) {                                   \
+    return (I32)cmp((T*)item1, (T*)item2);                                                      \
+}                                                                                               \
+static inline IErr Name##_init(Name* l, I32 itemcap) {                                          \
+    return ml_init(&l->list, (I32)sizeof(T), itemcap, runtime);                                 \
+}                                                                                               \
+static inline Name* Name##_create(I32 itemcap) {                                                \
+    return (Name*)ml_create((I32)sizeof(T), itemcap, runtime);                                  \
+}                                                                                               \
+static inline Void Name##_destroy(Name* l) {                                                    \
+    ml_destroy(&l->list);                                                                       \
+}                                                                                               \
+static inline T* Name##_items(Name* l) {                                                        \
+    return (T*)l->list.buffer.data;                                                             \
+}                                                                                               \
+static inline I32 Name##_count(Name* l) {                                                       \
+    return l->list.count;                                                                       \
+}                                                                                               \
+static inline IErr Name##_push(Name* l, T item) {                                               \
+    if (l->list.count >= l->list.buffer.itemcap) {                                              \
+        IErr err = ml_reserve(&l->list, 1);                                                     \
+        if (err != 0) {                                                                         \
+            return err;                                                                         \
+        }                                                                                       \
+    }                                                                                           \
+    ((T*)l->list.buffer.data)[l->list.count++] = item;                                          \
+    return 0;                                                                                   \
+}                                                                                               \
+static inline T* Name##_get(Name* l, I32 index) {                                               \
+    if (index < 0 || index >= l->list.count) {                                                  \
+        return NULL;                                                                            \
+    }                                                                                           \
+    return (T*)l->list.buffer.data + index;                                                     \
+}                                                                                               \
+static inline T Name##_at(Name* l, I32 index) {                                                 \
+    m_assert(index >= 0 && index < l->list.count);                                              \
+    return ((T*)l->list.buffer.data)[index];                                                    \
+}                                                                                               \
+static inline IErr Name##_put(Name* l, I32 index, T item) {                                     \
+    if (index < 0 || index >= l->list.count) {                                                  \
+        return M_ERR_OUT_OF_BOUNDS;                                                             \
+    }                                                                                           \
+    ((T*)l->list.buffer.data)[index] = item;                                                    \
+    return 0;                                                                                   \
+}                                                                                               \
+static inline I32 Name##_find(Name* l, T item) {                                                \
+    T* items = (T*)l->list.buffer.data;                                                         \
+    for (I32 i = 0; i < l->list.count; ++i) {                                                   \
+        if (cmp(&items[i], &item) == 0) {                                                       \
+            return i;                                                                           \
+        }                                                                                       \
+    }                                                                                           \
+    return -1;                                                                                  \
+}
 
 // Dictionary functions
 m_Dict* md_create(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
@@ -140,6 +586,184 @@ Bool md_has(m_Dict* dict, Void* key);
 IErr md_remove(m_Dict* dict, Void* key);
 IErr md_remove_ordered(m_Dict* dict, Void* key);
 I32 md_count(m_Dict* dict);
+Bool md_iter(m_Dict* dict, I32* pos, Void** key, Void** value);
+I32 md_get_many(m_Dict* dict, Void* keys, Void** values, I32 n);
+I32 md_has_many(m_Dict* dict, Void* keys, Bool* found, I32 n);
+IErr md_put_many(m_Dict* dict, Void* keys, Void* values, I32 n);
+IErr md_remove_many(m_Dict* dict, Void* keys, I32 n);
+
+// Hashed dictionary functions
+m_Dict* md_create_hashed(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_hashed(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_swiss(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_swiss(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+
+m_Dict* md_create_robinhood(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_robinhood(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_compact(I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+IErr md_init_compact(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+m_Dict* md_create_str(I32 valuesize, I32 itemcap);
+IErr md_init_str(m_Dict* dict, I32 valuesize, I32 itemcap);
+IErr md_setseed(m_Dict* dict, U64 seed);
+IErr md_setrehashbudget(m_Dict* dict, I32 budget);
+Bool md_rehash_step(m_Dict* dict, I32 slots);
+IErr md_stats(m_Dict* dict, m_DictStats* stats);
+
+// Sorted dictionary functions
+m_Dict* md_create_sorted(I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
+IErr md_init_sorted(m_Dict* dict, I32 keysize, I32 valuesize, I32 itemcap, m_ItemComparer comparer);
+IErr md_build_sorted(m_Dict* dict, Void* keys, Void* values, I32 n);
+I32 md_lower_bound(m_Dict* dict, Void* key);
+I32 md_upper_bound(m_Dict* dict, Void* key);
+
+// Set functions
+m_Set* mset_create(I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mset_destroy(m_Set* set);
+IErr mset_init(m_Set* set, I32 keysize, I32 itemcap, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mset_clear(m_Set* set);
+IErr mset_add(m_Set* set, Void* key);
+Bool mset_has(m_Set* set, Void* key);
+IErr mset_remove(m_Set* set, Void* key);
+I32 mset_count(m_Set* set);
+Bool mset_iter(m_Set* set, I32* pos, Void** key);
+IErr mset_union(m_Set* set, m_Set* other);
+IErr mset_intersect(m_Set* set, m_Set* other);
+IErr mset_difference(m_Set* set, m_Set* other);
+
+// Cache functions
+m_Cache* mcache_create(I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcache_destroy(m_Cache* cache);
+IErr mcache_init(m_Cache* cache, I32 keysize, I32 valuesize, I32 cap, m_CachePolicy policy, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcache_setevictor(m_Cache* cache, m_CacheEvictor evictor, Void* context);
+Void mcache_clear(m_Cache* cache);
+Void* mcache_get(m_Cache* cache, Void* key);
+IErr mcache_put(m_Cache* cache, Void* key, Void* value);
+Bool mcache_has(m_Cache* cache, Void* key);
+IErr mcache_remove(m_Cache* cache, Void* key);
+I32 mcache_count(m_Cache* cache);
+
+// Filter functions
+m_Filter* mfilter_create(m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher);
+Void mfilter_destroy(m_Filter* filter);
+IErr mfilter_init(m_Filter* filter, m_FilterMode mode, I32 keysize, I32 itemcap, F64 fpr, m_ItemHasher hasher);
+Void mfilter_clear(m_Filter* filter);
+IErr mfilter_add(m_Filter* filter, Void* key);
+Bool mfilter_test(m_Filter* filter, Void* key);
+IErr mfilter_remove(m_Filter* filter, Void* key);
+IErr mfilter_save(m_Filter* filter, m_Buffer* out);
+IErr mfilter_load(m_Filter* filter, Void* data, Sz size, m_ItemHasher hasher);
+
+// B-tree functions
+m_BTree* mbt_create(I32 keysize, I32 valuesize, m_ItemComparer comparer);
+Void mbt_destroy(m_BTree* tree);
+IErr mbt_init(m_BTree* tree, I32 keysize, I32 valuesize, m_ItemComparer comparer);
+Void mbt_clear(m_BTree* tree);
+IErr mbt_load(m_BTree* tree, m_List* keys, m_List* values);
+Void* mbt_get(m_BTree* tree, Void* key);
+IErr mbt_put(m_BTree* tree, Void* key, Void* value);
+Bool mbt_has(m_BTree* tree, Void* key);
+IErr mbt_remove(m_BTree* tree, Void* key);
+I32 mbt_remove_range(m_BTree* tree, Void* lo, Void* hi);
+I32 mbt_count(m_BTree* tree);
+m_BTreeCursor mbt_lower_bound(m_BTree* tree, Void* key);
+m_BTreeCursor mbt_upper_bound(m_BTree* tree, Void* key);
+m_BTreeCursor mbt_range(m_BTree* tree, Void* lo, Void* hi);
+Bool mbt_next(m_BTreeCursor* cursor, Void** key, Void** value);
+
+// Adaptive radix tree functions
+m_Art* mart_create(I32 valuesize);
+Void mart_destroy(m_Art* art);
+IErr mart_init(m_Art* art, I32 valuesize);
+Void mart_clear(m_Art* art);
+Void* mart_get(m_Art* art, Void* key, I32 keylen);
+IErr mart_put(m_Art* art, Void* key, I32 keylen, Void* value);
+Bool mart_has(m_Art* art, Void* key, I32 keylen);
+IErr mart_remove(m_Art* art, Void* key, I32 keylen);
+I32 mart_count(m_Art* art);
+Void* mart_longest_prefix(m_Art* art, Void* key, I32 keylen, I32* matchlen);
+I32 mart_iter_prefix(m_Art* art, Void* prefix, I32 prefixlen, m_ArtVisitor visitor, Void* context);
+Void mart_key_u64(U64 value, U8* out);
+
+// Small dictionary functions
+m_SmallDict* msd_create(I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer);
+Void msd_destroy(m_SmallDict* dict);
+IErr msd_init(m_SmallDict* dict, I32 keysize, I32 valuesize, m_ItemHasher hasher, m_ItemComparer comparer);
+Void msd_clear(m_SmallDict* dict);
+Void* msd_get(m_SmallDict* dict, Void* key);
+IErr msd_put(m_SmallDict* dict, Void* key, Void* value);
+Bool msd_has(m_SmallDict* dict, Void* key);
+IErr msd_remove(m_SmallDict* dict, Void* key);
+I32 msd_count(m_SmallDict* dict);
+Bool msd_iter(m_SmallDict* dict, I32* pos, Void** key, Void** value);
+
+// Frozen dictionary functions
+m_FrozenDict* md_freeze(m_Dict* dict);
+m_FrozenDict* mf_load(Void* data, Sz size, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mf_destroy(m_FrozenDict* frozen);
+Void* mf_get(m_FrozenDict* frozen, Void* key);
+Bool mf_has(m_FrozenDict* frozen, Void* key);
+I32 mf_count(m_FrozenDict* frozen);
+
+// Mapped file functions
+IErr ml_save(m_List* list, CStr path);
+m_List* ml_map(CStr path, m_ItemComparer comparer, Bool verify);
+IErr md_save(m_Dict* dict, CStr path);
+m_FrozenDict* md_map(CStr path, m_ItemHasher hasher, m_ItemComparer comparer, Bool verify);
+
+// Hash functions
+U64 m_hash_bytes(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u32(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u64(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_u128(Void* item, I32 itemsize, U64 seed);
+U64 m_hash_str(Void* item, I32 itemsize, U64 seed);
+m_ItemHasher m_hasher_for_size(I32 itemsize);
+I32 m_compare_str(Void* item1, Void* item2);
+
+#ifdef M_THREADS
+// Concurrent dictionary functions
+m_ConcurrentDict* mcd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+                             m_ItemHasher hasher, m_ItemComparer comparer);
+Void mcd_destroy(m_ConcurrentDict* dict);
+IErr mcd_init(m_ConcurrentDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 shardcount, Bool rwlocks,
+              m_ItemHasher hasher, m_ItemComparer comparer);
+Bool mcd_get(m_ConcurrentDict* dict, Void* key, Void* value);
+IErr mcd_put(m_ConcurrentDict* dict, Void* key, Void* value);
+Bool mcd_has(m_ConcurrentDict* dict, Void* key);
+IErr mcd_remove(m_ConcurrentDict* dict, Void* key);
+I32 mcd_count(m_ConcurrentDict* dict);
+
+// Read-mostly dictionary functions
+m_ReadDict* mrd_create(I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+                       m_ItemHasher hasher, m_ItemComparer comparer);
+Void mrd_destroy(m_ReadDict* dict);
+IErr mrd_init(m_ReadDict* dict, I32 keysize, I32 valuesize, I32 itemcap, I32 maxreaders,
+              m_ItemHasher hasher, m_ItemComparer comparer);
+I32 mrd_register(m_ReadDict* dict);
+Void mrd_unregister(m_ReadDict* dict, I32 reader);
+Bool mrd_get(m_ReadDict* dict, I32 reader, Void* key, Void* value);
+Bool mrd_has(m_ReadDict* dict, I32 reader, Void* key);
+IErr mrd_put(m_ReadDict* dict, Void* key, Void* value);
+IErr mrd_put_many(m_ReadDict* dict, Void* keys, Void* values, I32 n);
+IErr mrd_remove(m_ReadDict* dict, Void* key);
+I32 mrd_count(m_ReadDict* dict);
+
+// Parallel sort functions
+IErr ml_sort_parallel(m_List* list, I32 nthreads, Bool stable);
+
+#ifdef M_MMAP
+// Process-shared dictionary functions
+m_SharedDict* mshd_create(CStr name, I32 keysize, I32 valuesize, I32 itemcap, m_ItemHasher hasher,
+                          m_ItemComparer comparer);
+m_SharedDict* mshd_open(CStr name, m_ItemHasher hasher, m_ItemComparer comparer);
+Void mshd_destroy(m_SharedDict* dict);
+IErr mshd_unlink(CStr name);
+Bool mshd_get(m_SharedDict* dict, Void* key, Void* value);
+IErr mshd_put(m_SharedDict* dict, Void* key, Void* value);
+Bool mshd_has(m_SharedDict* dict, Void* key);
+IErr mshd_remove(m_SharedDict* dict, Void* key);
+I32 mshd_count(m_SharedDict* dict);
+#endif
+#endif
 
 // String Buffer functions
 m_StrBuffer* ms_create(I32 itemcap);
@@ -1,5 +1,9 @@
 #include "utest.h"
 
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #ifdef UNIT_TESTS
 #include "mg.h"
 #else
@@ -93,6 +97,248 @@ UTEST(List, InsertAndRemove) {
     ASSERT_EQ(*item, 2);                  // Check remaining value
     ml_destroy(list);                     // Clean up
 }
+
+UTEST(List, BulkAppend) {
+    m_List* list = ml_create(sizeof(I32), 0, int_comparer);
+    I32 values[100];
+    for (I32 i = 0; i < 100; ++i) {
+        values[i] = i;
+    }
+    ASSERT_EQ(ml_push_many(list, values, 100), 0);
+    ASSERT_EQ(list->buffer.itemcap, 100); // One growth to the exact size
+    ASSERT_EQ(ml_push_many(list, values, 0), 0);
+    I32* slot = (I32*)ml_emplace(list);   // Built in place
+    ASSERT_NE(slot, NULL);
+    *slot = 1000;
+    I32* run = (I32*)ml_extend_uninit(list, 10);
+    for (I32 i = 0; i < 10; ++i) {
+        run[i] = 2000 + i;
+    }
+    ASSERT_EQ(list->count, 111);
+    ASSERT_EQ(*(I32*)ml_get(list, 99), 99);
+    ASSERT_EQ(*(I32*)ml_get(list, 100), 1000);
+    ASSERT_EQ(*(I32*)ml_get(list, 110), 2009);
+    ASSERT_EQ(ml_extend_uninit(list, -1), NULL);
+    ml_destroy(list);                     // Clean up
+}
+
+UTEST(List, ReserveAndGrowth) {
+    m_List* list = ml_create(sizeof(I32), 0, NULL);
+    ASSERT_EQ(ml_reserve(list, 10), 0);
+    ASSERT_EQ(list->buffer.itemcap, 10);
+    ASSERT_EQ(ml_reserve(list, 5), 0);    // Already room, nothing changes
+    ASSERT_EQ(list->buffer.itemcap, 10);
+    ASSERT_NE(ml_setgrowth(list, 100), 0);
+    ASSERT_EQ(ml_setgrowth(list, 150), 0);
+    ml_extend_uninit(list, 10);
+    I32 value = 1;
+    ml_push(list, &value);                // Full, grows by half
+    ASSERT_EQ(list->buffer.itemcap, 15);
+    ASSERT_EQ(ml_reserve(list, 100), 0);  // A large request wins over the growth factor
+    ASSERT_EQ(list->buffer.itemcap, 111);
+    ASSERT_EQ(ml_reserve(list, INT32_MAX), M_ERR_OUT_OF_BOUNDS);
+    ml_destroy(list);                     // Clean up
+}
+
+typedef struct Event {
+    I64 time;
+    I32 id;
+    F32 score;
+    I32 source;
+} Event;
+
+static I32 event_comparer(Void* item1, Void* item2) {
+    I64 a = ((Event*)item1)->time;
+    I64 b = ((Event*)item2)->time;
+    return (a > b) - (a < b);
+}
+
+UTEST(List, FindBytes) {
+    m_List* list = ml_create(sizeof(U64), 0, NULL);
+    for (I32 i = 0; i < 1000; ++i) {
+        U64 value = (U64)(i % 100) << 32;   // Only the high half differs, which a 32-bit compare alone would miss
+        ml_push(list, &value);
+    }
+    U64 needle = 42ull << 32;
+    ASSERT_EQ(ml_find(list, &needle), 42);
+    ASSERT_EQ(ml_find_bytes(list, &needle), 42);
+    ASSERT_EQ(ml_count_eq(list, &needle), 10);
+    m_List* indexes = ml_create(sizeof(I32), 0, NULL);
+    ASSERT_EQ(ml_find_all(list, &needle, indexes), 0);
+    ASSERT_EQ(ml_count(indexes), 10);
+    ASSERT_EQ(*(I32*)ml_get(indexes, 9), 942);   // In the scalar tail after the last block of 32
+    needle = 100ull << 32;
+    ASSERT_EQ(ml_find(list, &needle), -1);
+    ASSERT_EQ(ml_count_eq(list, &needle), 0);
+    ml_destroy(list);
+
+    m_List* ints = ml_create(sizeof(I32), 0, int_comparer);
+    for (I32 i = 0; i < 100; ++i) {
+        I32 value = i % 7;
+        ml_push(ints, &value);
+    }
+    I32 three = 3;
+    ASSERT_EQ(ml_count_eq(ints, &three), 14);     // The comparer still decides when there is one
+    ml_clear(indexes);
+    ASSERT_EQ(ml_find_all(ints, &three, indexes), 0);
+    ASSERT_EQ(*(I32*)ml_get(indexes, 1), 10);
+    ml_destroy(ints);
+    ml_destroy(indexes);                  // Clean up
+}
+
+UTEST(List, SortPdqAndArgsort) {
+    m_List* list = ml_create(sizeof(I32), 0, int_comparer);
+    for (I32 i = 0; i < 1000; ++i) {
+        I32 value = (i * 7919) % 1000 - 500;
+        ml_push(list, &value);
+    }
+    ml_sort_pdq(list);
+    for (I32 i = 0; i < 1000; ++i) {
+        ASSERT_EQ(*(I32*)ml_get(list, i), i - 500);
+    }
+    ml_destroy(list);
+
+    m_List* events = ml_create(sizeof(Event), 0, event_comparer);
+    for (I32 i = 0; i < 200; ++i) {
+        Event event = {(I64)(i % 10) * 1000, i, 0.0f};
+        ml_push(events, &event);
+    }
+    I32 order[200];
+    ASSERT_EQ(ml_argsort(events, order), 0);
+    ASSERT_EQ(order[0], 0);
+    ASSERT_EQ(order[1], 10);              // Equal times keep their original order
+    ASSERT_EQ(order[199], 199);
+    ASSERT_EQ(ml_apply_permutation(events, order), 0);
+    ASSERT_EQ(((Event*)ml_get(events, 20))->id, 1);
+    ml_sort_pdq(events);
+    ASSERT_EQ(((Event*)ml_get(events, 199))->time, 9000);
+    ml_destroy(events);
+
+    m_List* unordered = ml_create(sizeof(I32), 0, NULL);
+    for (I32 i = 0; i < 1000; ++i) {
+        I32 value = (i * 7919) % 1000;
+        ml_push(unordered, &value);
+    }
+    ml_sort_pdq(unordered);               // Returns instead of spinning on address comparisons
+    ASSERT_EQ(*(I32*)ml_get(unordered, 1), 7919 % 1000);
+    I32* indexes = (I32*)malloc(sizeof(I32) * 1000);
+    ASSERT_EQ(ml_argsort(unordered, indexes), M_ERR_INVALID_OPERATION);
+    ASSERT_EQ(ml_sort_parallel(unordered, 2, false), M_ERR_INVALID_OPERATION);
+    free(indexes);
+    ml_destroy(unordered);                // Clean up
+}
+
+UTEST(List, SortRadix) {
+    m_List* events = ml_create(sizeof(Event), 0, NULL);
+    for (I32 i = 0; i < 5000; ++i) {
+        Event event = {1700000000000ll + (I64)((i * 2654435761u) % 3000) - 1000, i, (F32)((i * 37) % 101) - 50.0f};
+        ml_push(events, &event);
+    }
+    ASSERT_EQ(ml_sort_radix(events, offsetof(Event, time), M_RADIX_I64), 0);
+    for (I32 i = 1; i < 5000; ++i) {
+        Event* a = (Event*)ml_get(events, i - 1);
+        Event* b = (Event*)ml_get(events, i);
+        ASSERT_TRUE(a->time < b->time || (a->time == b->time && a->id < b->id)); // Stable
+    }
+    ASSERT_EQ(ml_sort_radix(events, offsetof(Event, score), M_RADIX_F32), 0);
+    ASSERT_EQ(((Event*)ml_get(events, 0))->score, -50.0f);
+    ASSERT_EQ(((Event*)ml_get(events, 4999))->score, 50.0f);
+    ASSERT_EQ(ml_sort_radix(events, sizeof(Event) - 4, M_RADIX_I64), M_ERR_OUT_OF_BOUNDS);
+    ml_destroy(events);                   // Clean up
+}
+
+UTEST(List, SortParallel) {
+    m_List* list = ml_create(sizeof(I32), 0, int_comparer);
+    for (I32 i = 0; i < 100000; ++i) {
+        I32 value = (I32)((I64)i * 35761 % 100000);   // A permutation of 0..99999
+        ml_push(list, &value);
+    }
+    ASSERT_EQ(ml_sort_parallel(list, 3, false), 0);  // Odd run count leaves one run unpaired
+    for (I32 i = 0; i < 100000; ++i) {
+        ASSERT_EQ(*(I32*)ml_get(list, i), i);
+    }
+    ml_destroy(list);
+
+    m_List* events = ml_create(sizeof(Event), 0, event_comparer);
+    for (I32 i = 0; i < 150000; ++i) {
+        Event event = {(I64)((i * 2654435761u) % 97), i, 0.0f};
+        ml_push(events, &event);
+    }
+    ASSERT_EQ(ml_sort_parallel(events, 8, true), 0);
+    for (I32 i = 1; i < 150000; ++i) {
+        Event* a = (Event*)ml_get(events, i - 1);
+        Event* b = (Event*)ml_get(events, i);
+        ASSERT_TRUE(a->time < b->time || (a->time == b->time && a->id < b->id)); // Stable
+    }
+    ASSERT_EQ(ml_sort_parallel(events, 0, false), 0);
+    ASSERT_EQ(((Event*)ml_get(events, 149999))->time, 96);
+    ml_destroy(events);                   // Clean up
+}
+#pragma endregion
+
+#pragma region Typed List Tests
+// Tests for lists declared with M_LIST_DEFINE and M_LIST_DEFINE_CMP
+
+typedef struct Point {
+    F32 x;
+    F32 y;
+} Point;
+
+#define point_cmp(a, b) (((a)->x == (b)->x && (a)->y == (b)->y) ? 0 : 1)
+#define int_sign(a, b) ((*(a) > *(b)) - (*(a) < *(b)))
+
+M_LIST_DEFINE(I32, IntList)
+M_LIST_DEFINE_CMP(Point, PointList, point_cmp)
+M_LIST_DEFINE_CMP(I32, OrderedIntList, int_sign)
+
+UTEST(TypedList, PushGetFind) {
+    IntList* list = IntList_create(0);
+    ASSERT_NE(list, NULL);
+    for (I32 i = 0; i < 100; ++i) {
+        ASSERT_EQ(IntList_push(list, i * 3), 0);
+    }
+    ASSERT_EQ(IntList_count(list), 100);
+    ASSERT_EQ(IntList_at(list, 10), 30);
+    ASSERT_EQ(*IntList_get(list, 99), 297);
+    ASSERT_EQ(IntList_get(list, 100), NULL);
+    ASSERT_EQ(IntList_put(list, 5, -1), 0);
+    ASSERT_EQ(IntList_put(list, 100, 0), M_ERR_OUT_OF_BOUNDS);
+    ASSERT_EQ(IntList_find(list, -1), 5);
+    ASSERT_EQ(IntList_find(list, 1), -1);
+    I32 needle = -1;
+    ASSERT_EQ(ml_find(&list->list, &needle), 5); // Bytewise, through the SIMD search
+    IntList_destroy(list);                // Clean up
+}
+
+UTEST(TypedList, SortNeedsSignedComparer) {
+    OrderedIntList* list = OrderedIntList_create(0);
+    I32 values[] = {256, 1, -1, 2};
+    for (I32 i = 0; i < 4; ++i) {
+        OrderedIntList_push(list, values[i]);
+    }
+    ml_sort(&list->list);
+    ASSERT_EQ(OrderedIntList_at(list, 0), -1);
+    ASSERT_EQ(OrderedIntList_at(list, 1), 1);
+    ASSERT_EQ(OrderedIntList_at(list, 3), 256);
+    OrderedIntList_destroy(list);         // Clean up
+}
+
+UTEST(TypedList, SharesLayoutWithList) {
+    PointList points;
+    ASSERT_EQ(PointList_init(&points, 4), 0);
+    for (I32 i = 0; i < 10; ++i) {
+        Point p = {(F32)i, -0.0f};
+        PointList_push(&points, p);
+    }
+    Point p = {3.0f, 0.0f};               // Equal to {3, -0} under point_cmp but not bytewise
+    ASSERT_EQ(PointList_find(&points, p), 3);
+    ASSERT_EQ(ml_find(&points.list, &p), 3); // The generated comparer backs the untyped functions
+    ASSERT_EQ(ml_count(&points.list), 10);
+    ASSERT_EQ(((Point*)ml_get(&points.list, 9))->x, 9.0f);
+    ml_remove(&points.list, 0);
+    ASSERT_EQ(PointList_items(&points)[0].x, 1.0f);
+    ml_setcap(&points.list, 0);           // Clean up
+}
 #pragma endregion
 
 #pragma region Dictionary Tests
@@ -140,6 +386,1481 @@ UTEST(Dict, UpdateExistingKey) {
 }
 #pragma endregion
 
+#pragma region Hashed Dictionary Tests
+// Tests for the hashed m_Dict mode, an open-addressing table behind the md_* API
+
+UTEST(HashedDict, PutGetAndRemove) {
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(I32), 4, NULL, NULL);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    for (I32 i = 0; i < 1000; ++i) {
+        I32 value = i * 10;
+        ASSERT_EQ(md_put(dict, &i, &value), 0); // Grows past the initial capacity
+    }
+    ASSERT_EQ(md_count(dict), 1000);      // Verify count
+    for (I32 i = 0; i < 1000; i += 2) {
+        md_remove(dict, &i);              // Remove every even key
+    }
+    ASSERT_EQ(md_count(dict), 500);
+    for (I32 i = 0; i < 1000; ++i) {
+        I32* value = (I32*)md_get(dict, &i);
+        if (i % 2 == 0) {
+            ASSERT_EQ(value, NULL);       // Removed keys are gone
+        } else {
+            ASSERT_NE(value, NULL);
+            ASSERT_EQ(*value, i * 10);    // Remaining keys keep their values
+        }
+    }
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(HashedDict, UpdateAndComparer) {
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(Str), 10, NULL, int_comparer);
+    I32 key = 7;
+    Str value1 = "seven";
+    Str value2 = "sieben";
+    md_put(dict, &key, &value1);          // Add initial value
+    md_put(dict, &key, &value2);          // Update value for same key
+    ASSERT_EQ(md_count(dict), 1);         // Still a single entry
+    ASSERT_TRUE(md_has(dict, &key));
+    ASSERT_EQ(*(Str*)md_get(dict, &key), "sieben"); // Verify updated value
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(HashedDict, ChurnKeepsTableBounded) {
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(I32), 64, NULL, NULL);
+    I32 slotcap = dict->slots.itemcap;
+    for (I32 i = 0; i < 100000; ++i) {
+        md_put(dict, &i, &i);             // Insert and remove a fresh key each round
+        md_remove(dict, &i);
+    }
+    ASSERT_EQ(md_count(dict), 0);
+    ASSERT_EQ(dict->slots.itemcap, slotcap); // Tombstones are purged, not grown into
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(HashedDict, Iterate) {
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(I32), 10, NULL, NULL);
+    I64 sum = 0;
+    for (I32 i = 1; i <= 100; ++i) {
+        md_put(dict, &i, &i);
+    }
+    I32 pos = 0;
+    Void *key, *value;
+    I32 seen = 0;
+    while (md_iter(dict, &pos, &key, &value)) {
+        ASSERT_EQ(*(I32*)key, *(I32*)value);
+        sum += *(I32*)value;
+        seen++;
+    }
+    ASSERT_EQ(seen, 100);                 // Every entry is visited once
+    ASSERT_EQ(sum, 5050);
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
+#pragma region Swiss Dictionary Tests
+// Tests for the swiss m_Dict mode, which filters candidates with 7-bit control byte fingerprints
+
+static I32 counted_compares = 0;
+
+static I32 counting_comparer(Void* item1, Void* item2) {
+    counted_compares++;
+    return int_comparer(item1, item2);
+}
+
+UTEST(SwissDict, PutGetAndRemove) {
+    m_Dict* dict = md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    for (I32 i = 0; i < 5000; ++i) {
+        I32 value = -i;
+        ASSERT_EQ(md_put(dict, &i, &value), 0);
+    }
+    for (I32 i = 0; i < 5000; i += 3) {
+        md_remove(dict, &i);              // Remove every third key
+    }
+    for (I32 i = 0; i < 5000; ++i) {
+        I32* value = (I32*)md_get(dict, &i);
+        if (i % 3 == 0) {
+            ASSERT_EQ(value, NULL);       // Removed keys are gone
+        } else {
+            ASSERT_NE(value, NULL);
+            ASSERT_EQ(*value, -i);        // Remaining keys keep their values
+        }
+    }
+    ASSERT_EQ(md_count(dict), 5000 - 1667);
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(SwissDict, MissesRarelyCompareKeys) {
+    m_Dict* dict = md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, counting_comparer);
+    for (I32 i = 0; i < 10000; ++i) {
+        md_put(dict, &i, &i);
+    }
+    counted_compares = 0;
+    for (I32 i = 10000; i < 20000; ++i) {
+        ASSERT_FALSE(md_has(dict, &i));   // Absent keys
+    }
+    ASSERT_LT(counted_compares, 1000);    // Most misses are rejected by the fingerprints alone
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
+#pragma region Robin Hood Dictionary Tests
+// Tests for the Robin Hood m_Dict mode, which deletes by shifting probe chains back instead of leaving tombstones
+
+UTEST(RobinHoodDict, PutGetAndRemove) {
+    m_Dict* dict = md_create_robinhood(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    for (I32 i = 0; i < 5000; ++i) {
+        I32 value = i + 1;
+        ASSERT_EQ(md_put(dict, &i, &value), 0);
+    }
+    for (I32 i = 0; i < 5000; i += 2) {
+        md_remove(dict, &i);              // Remove every even key
+    }
+    for (I32 i = 0; i < 5000; ++i) {
+        I32* value = (I32*)md_get(dict, &i);
+        if (i % 2 == 0) {
+            ASSERT_EQ(value, NULL);       // Removed keys are gone
+        } else {
+            ASSERT_NE(value, NULL);
+            ASSERT_EQ(*value, i + 1);     // Shifted entries keep their values
+        }
+    }
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(RobinHoodDict, ChurnLeavesNoTombstones) {
+    m_Dict* dict = md_create_robinhood(sizeof(I32), sizeof(I32), 1000, NULL, NULL);
+    for (I32 i = 0; i < 1000; ++i) {
+        md_put(dict, &i, &i);
+    }
+    for (I32 i = 1000; i < 100000; ++i) {
+        I32 old = i - 1000;
+        md_remove(dict, &old);            // Keep 1000 live keys while cycling through fresh ones
+        md_put(dict, &i, &i);
+    }
+    m_DictStats stats;
+    ASSERT_EQ(md_stats(dict, &stats), 0);
+    ASSERT_EQ(stats.count, 1000);
+    ASSERT_EQ(stats.deleted, 0);          // Backward shifting leaves no tombstones
+    ASSERT_LT(stats.maxprobe, 32);        // Probe lengths stay bounded under churn
+    ASSERT_LT(stats.meanprobe, 4.0);
+    I32 total = 0;
+    for (I32 i = 0; i < M_PROBE_HIST_SIZE; ++i) {
+        total += stats.probehist[i];
+    }
+    ASSERT_EQ(total, 1000);               // Histogram covers every key
+    for (I32 i = 99000; i < 100000; ++i) {
+        ASSERT_TRUE(md_has(dict, &i));
+    }
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
+#pragma region Compact Dictionary Tests
+// Tests for the compact m_Dict mode: dense insertion-ordered lists plus an I32 hash index
+
+UTEST(CompactDict, KeepsInsertionOrder) {
+    m_Dict* dict = md_create_compact(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    for (I32 i = 0; i < 100; ++i) {
+        I32 key = 1000 - i * 7;
+        md_put(dict, &key, &i);
+    }
+    ASSERT_EQ(md_count(dict), 100);
+    for (I32 i = 0; i < 100; ++i) {
+        ASSERT_EQ(*(I32*)ml_get(&dict->keys, i), 1000 - i * 7); // Dense keys in insertion order
+        ASSERT_EQ(*(I32*)ml_get(&dict->values, i), i);
+    }
+    I32 key = 1000 - 42 * 7;
+    ASSERT_EQ(md_remove_ordered(dict, &key), 0);
+    ASSERT_EQ(*(I32*)ml_get(&dict->values, 42), 43); // Later entries shift down
+    for (I32 i = 0; i < 100; ++i) {
+        key = 1000 - i * 7;
+        I32* value = (I32*)md_get(dict, &key);
+        if (i == 42) {
+            ASSERT_EQ(value, NULL);
+        } else {
+            ASSERT_EQ(*value, i);         // The index follows the shifted positions
+        }
+    }
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(CompactDict, RemoveSwapPatchesIndex) {
+    m_Dict* dict = md_create_compact(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    for (I32 i = 0; i < 1000; ++i) {
+        md_put(dict, &i, &i);
+    }
+    for (I32 i = 0; i < 1000; i += 2) {
+        md_remove(dict, &i);              // Each removal moves the last entry into the hole
+    }
+    ASSERT_EQ(md_count(dict), 500);
+    for (I32 i = 0; i < 1000; ++i) {
+        I32* value = (I32*)md_get(dict, &i);
+        ASSERT_EQ(value != NULL, i % 2 == 1);
+        if (value) ASSERT_EQ(*value, i);
+    }
+    m_DictStats stats;
+    md_stats(dict, &stats);
+    ASSERT_EQ(stats.count, 500);
+    ASSERT_EQ(stats.deleted, dict->used - 500);
+    md_clear(dict);
+    I32 key = 1;
+    ASSERT_FALSE(md_has(dict, &key));
+    md_put(dict, &key, &key);
+    ASSERT_EQ(*(I32*)md_get(dict, &key), 1);
+    md_destroy(dict);                     // Clean up
+}
+
+#pragma endregion
+
+#pragma region String Dictionary Tests
+// Tests for the string m_Dict mode, which owns copies of its keys in one arena
+
+UTEST(StrDict, OwnsKeyCopies) {
+    m_Dict* dict = md_create_str(sizeof(I32), 0);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    char key[32];
+    for (I32 i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "header-%d", i);
+        ASSERT_EQ(md_put(dict, key, &i), 0); // The same stack buffer is reused for every key
+    }
+    ASSERT_EQ(md_count(dict), 1000);
+    for (I32 i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof(key), "header-%d", i);
+        I32* value = (I32*)md_get(dict, key);
+        ASSERT_NE(value, NULL);
+        ASSERT_EQ(*value, i);             // Each key kept its own copy
+    }
+    ASSERT_FALSE(md_has(dict, "header-"));   // Prefixes and extensions do not match
+    ASSERT_FALSE(md_has(dict, "header-10000"));
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(StrDict, RemoveAndReclaim) {
+    m_Dict* dict = md_create_str(sizeof(I32), 16);
+    char key[32];
+    for (I32 i = 0; i < 20000; ++i) {
+        snprintf(key, sizeof(key), "label-%d", i);
+        md_put(dict, key, &i);
+        if (i >= 16) {
+            snprintf(key, sizeof(key), "label-%d", i - 16);
+            md_remove(dict, key);         // Keep 16 live keys
+        }
+    }
+    ASSERT_EQ(md_count(dict), 16);
+    ASSERT_LT(dict->arena.buffer.itemcap, 4096); // Removed keys are compacted away on growth
+
+    I32 pos = 0;
+    Void *k, *v;
+    I32 seen = 0;
+    while (md_iter(dict, &pos, &k, &v)) {
+        snprintf(key, sizeof(key), "label-%d", *(I32*)v);
+        ASSERT_EQ(strcmp((Str)k, key), 0); // Iteration yields the key strings
+        seen++;
+    }
+    ASSERT_EQ(seen, 16);
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
+#pragma region Sorted Dictionary Tests
+// Tests for the sorted m_Dict mode, which binary searches keys kept in comparer order
+
+UTEST(SortedDict, PutKeepsKeysOrdered) {
+    m_Dict* dict = md_create_sorted(sizeof(I32), sizeof(I32), 0, int_comparer);
+    I32 keys[] = {50, 10, 40, 20, 30, 10};
+    for (I32 i = 0; i < m_countof(keys); ++i) {
+        md_put(dict, &keys[i], &i);       // Insert out of order, 10 twice
+    }
+    ASSERT_EQ(md_count(dict), 5);
+    for (I32 i = 0; i < 5; ++i) {
+        ASSERT_EQ(*(I32*)ml_get(&dict->keys, i), (i + 1) * 10); // Keys are ascending
+    }
+    I32 key = 10;
+    ASSERT_EQ(*(I32*)md_get(dict, &key), 5); // Latest value for the duplicate key
+    md_remove(dict, &key);
+    ASSERT_FALSE(md_has(dict, &key));
+    ASSERT_EQ(*(I32*)ml_get(&dict->keys, 0), 20); // Removal keeps the order
+    md_destroy(dict);                     // Clean up
+}
+
+static I32 misaligned_keys = 0;
+
+static I32 aligned_u64_comparer(Void* item1, Void* item2) {
+    misaligned_keys += ((uintptr_t)item1 & 7) != 0 || ((uintptr_t)item2 & 7) != 0;
+    U64 a = *(U64*)item1;
+    U64 b = *(U64*)item2;
+    return (a > b) - (a < b);
+}
+
+UTEST(SortedDict, BuildSortedAlignsKeys) {
+    m_Dict* dict = md_create_sorted(sizeof(U64), sizeof(I32), 0, aligned_u64_comparer);
+    U64 keys[100];
+    I32 values[100];
+    for (I32 i = 0; i < 100; ++i) {
+        keys[i] = (U64)((i * 37) % 100);
+        values[i] = i;
+    }
+    misaligned_keys = 0;
+    ASSERT_EQ(md_build_sorted(dict, keys, values, 100), 0);
+    ASSERT_EQ(misaligned_keys, 0);        // 12-byte (key, value) records would put every other key off by 4
+    ASSERT_EQ(*(U64*)ml_get(&dict->keys, 99), 99ull);
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(SortedDict, BuildSortedAndBounds) {
+    m_Dict* dict = md_create_sorted(sizeof(I32), sizeof(I32), 0, int_comparer);
+    I32 existing = 25;
+    md_put(dict, &existing, &existing);
+    I32 keys[1000];
+    I32 values[1000];
+    for (I32 i = 0; i < 1000; ++i) {
+        keys[i] = ((i * 7919) % 500) * 2; // Even keys 0..998, each twice
+        values[i] = i;
+    }
+    ASSERT_EQ(md_build_sorted(dict, keys, values, 1000), 0);
+    ASSERT_EQ(md_count(dict), 501);       // 500 unique keys plus the existing one
+    for (I32 i = 1; i < md_count(dict); ++i) {
+        ASSERT_LT(*(I32*)ml_get(&dict->keys, i - 1), *(I32*)ml_get(&dict->keys, i));
+    }
+    I32 key = 25;
+    ASSERT_EQ(*(I32*)md_get(dict, &key), 25); // Existing entry survives the merge
+    key = 40;
+    I32* value = (I32*)md_get(dict, &key);
+    ASSERT_NE(value, NULL);
+    ASSERT_EQ(keys[*value], 40);          // Latest of the duplicates wins
+    ASSERT_GE(*value, 500);
+
+    I32 lo = 100, hi = 200;
+    I32 first = md_lower_bound(dict, &lo);
+    I32 last = md_upper_bound(dict, &hi);
+    ASSERT_EQ(last - first, 51);          // Range scan over 100..200 inclusive
+    ASSERT_EQ(*(I32*)ml_get(&dict->keys, first), 100);
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
+#pragma region Incremental Rehash Tests
+// Tests for md_setrehashbudget, which spreads table growth across later operations
+
+UTEST(IncrementalRehash, LookupsSpanBothTables) {
+    m_Dict* dicts[] = {
+        md_create_hashed(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+        md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+        md_create_robinhood(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+    };
+    for (I32 d = 0; d < m_countof(dicts); ++d) {
+        m_Dict* dict = dicts[d];
+        ASSERT_EQ(md_setrehashbudget(dict, 16), 0);
+        static Bool live[20000];
+        memset(live, 0, sizeof(live));
+        Bool sawresize = false;
+        for (I32 i = 0; i < 20000; ++i) {
+            md_put(dict, &i, &i);
+            live[i] = true;
+            if (i % 3 == 0) {
+                I32 gone = i / 2;
+                md_remove(dict, &gone);   // Removes hit keys on either side of the resize
+                live[gone] = false;
+            }
+            sawresize |= dict->old != NULL;
+        }
+        ASSERT_TRUE(sawresize);
+        I32 expected = 0;
+        for (I32 i = 0; i < 20000; ++i) {
+            I32* value = (I32*)md_get(dict, &i);
+            ASSERT_EQ(value != NULL, live[i]);
+            if (value) ASSERT_EQ(*value, i);
+            expected += live[i];
+        }
+        ASSERT_EQ(md_count(dict), expected);
+        I32 pos = 0, seen = 0;
+        while (md_iter(dict, &pos, NULL, NULL)) {
+            seen++;                       // Iteration covers the undrained old slots too
+        }
+        ASSERT_EQ(seen, expected);
+        md_destroy(dict);
+    }
+}
+
+UTEST(IncrementalRehash, StepDrainsOldTable) {
+    m_Dict* dict = md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    ASSERT_EQ(md_setrehashbudget(dict, 16), 0);
+    I32 i = 0;
+    while (!dict->old) {
+        md_put(dict, &i, &i);
+        i++;
+    }
+    ASSERT_GT(dict->old->keys.count, 0);  // The resize left entries behind
+    ASSERT_EQ(md_count(dict), i);
+    while (md_rehash_step(dict, 4)) {
+    }
+    ASSERT_EQ(dict->old, NULL);
+    ASSERT_EQ(dict->keys.count, i);       // Everything now lives in the new table
+    m_Dict* linear = md_create(sizeof(I32), sizeof(I32), 0, int_comparer);
+    ASSERT_EQ(md_setrehashbudget(linear, 16), M_ERR_INVALID_OPERATION);
+    md_destroy(linear);
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(IncrementalRehash, LookupsKeepPointersValid) {
+    m_Dict* dict = md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    ASSERT_EQ(md_setrehashbudget(dict, 16), 0);
+    I32 n = 0;
+    while (!dict->old) {
+        md_put(dict, &n, &n);
+        n++;
+    }
+    I32 keys[4096];
+    Void* values[4096];
+    for (I32 i = 0; i < 4096; ++i) {
+        keys[i] = i % n;
+    }
+    ASSERT_EQ(md_get_many(dict, keys, values, 4096), 4096);
+    for (I32 i = 0; i < 4096; ++i) {
+        ASSERT_EQ(*(I32*)values[i], i % n); // No later key in the batch drained the old table
+    }
+    I32 pos = 0, seen = 0;
+    I32* key;
+    I32* value;
+    while (md_iter(dict, &pos, (Void**)&key, (Void**)&value)) {
+        ASSERT_NE(md_get(dict, key), NULL);
+        ASSERT_EQ(*value, *key);          // Lookups while iterating leave the entry in place
+        seen++;
+    }
+    ASSERT_EQ(seen, n);
+    ASSERT_NE(dict->old, NULL);           // Only writes and md_rehash_step drain
+    md_destroy(dict);                     // Clean up
+}
+
+#pragma endregion
+
+#pragma region Batched Dictionary Tests
+// Tests for md_get_many, md_has_many, md_put_many and md_remove_many across the dict modes
+
+UTEST(BatchDict, LinearScansOnce) {
+    m_Dict* dict = md_create(sizeof(I32), sizeof(I32), 0, int_comparer);
+    I32 keys[] = {5, 3, 9, 3, 7};
+    I32 values[] = {50, 30, 90, 31, 70};
+    ASSERT_EQ(md_put_many(dict, keys, values, 5), 0);
+    ASSERT_EQ(md_count(dict), 4);         // 3 appears twice in the batch
+    ASSERT_EQ(*(I32*)md_get(dict, &keys[1]), 31); // Later duplicates win
+
+    I32 more[] = {7, 1};
+    I32 morevalues[] = {71, 10};
+    md_put_many(dict, more, morevalues, 2);
+    I32 queries[] = {1, 2, 3, 7, 7};
+    Void* found[5];
+    ASSERT_EQ(md_get_many(dict, queries, found, 5), 4);
+    ASSERT_EQ(*(I32*)found[0], 10);
+    ASSERT_EQ(found[1], NULL);            // Missing keys come back NULL
+    ASSERT_EQ(*(I32*)found[3], 71);       // Existing key updated in place
+    ASSERT_EQ(found[3], found[4]);
+
+    ASSERT_EQ(md_remove_many(dict, queries, 5), 0);
+    ASSERT_EQ(md_count(dict), 2);         // 5 and 9 remain
+    Bool has[5];
+    ASSERT_EQ(md_has_many(dict, keys, has, 5), 2);
+    ASSERT_TRUE(has[0] && has[2] && !has[1] && !has[4]);
+    md_destroy(dict);                     // Clean up
+}
+
+UTEST(BatchDict, LinearWideKeys) {
+    m_Dict* dicts[] = {
+        md_create(sizeof(U64), sizeof(I32), 0, aligned_u64_comparer),
+        md_create(sizeof(U64), sizeof(I32), 0, NULL), // Batches sort by key bytes
+    };
+    for (I32 d = 0; d < m_countof(dicts); ++d) {
+        U64 keys[64];
+        I32 values[64];
+        for (I32 i = 0; i < 64; ++i) {
+            keys[i] = (U64)i << 33;
+            values[i] = i;
+        }
+        misaligned_keys = 0;
+        ASSERT_EQ(md_put_many(dicts[d], keys, values, 64), 0);
+        keys[5] = 7;                      // A miss among hits
+        Void* found[64];
+        ASSERT_EQ(md_get_many(dicts[d], keys, found, 64), 63);
+        ASSERT_EQ(found[5], NULL);
+        ASSERT_EQ(*(I32*)found[63], 63);
+        ASSERT_EQ(md_remove_many(dicts[d], keys, 32), 0);
+        ASSERT_EQ(md_count(dicts[d]), 33);
+        ASSERT_EQ(misaligned_keys, 0);    // (key, index) records keep U64 keys aligned
+        md_destroy(dicts[d]);
+    }
+}
+
+UTEST(BatchDict, TablesMatchSingleOps) {
+    m_Dict* dicts[] = {
+        md_create_hashed(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+        md_create_swiss(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+        md_create_robinhood(sizeof(I32), sizeof(I32), 0, NULL, NULL),
+        md_create_sorted(sizeof(I32), sizeof(I32), 0, int_comparer),
+    };
+    I32 keys[1000];
+    I32 values[1000];
+    for (I32 i = 0; i < 1000; ++i) {
+        keys[i] = (i * 7919) % 1000;
+        values[i] = i;
+    }
+    for (I32 d = 0; d < m_countof(dicts); ++d) {
+        m_Dict* dict = dicts[d];
+        ASSERT_EQ(md_put_many(dict, keys, values, 1000), 0);
+        ASSERT_EQ(md_count(dict), 1000);
+        ASSERT_EQ(md_remove_many(dict, keys, 500), 0); // Batches larger than one prefetch chunk
+        ASSERT_EQ(md_count(dict), 500);
+        Void* found[1000];
+        ASSERT_EQ(md_get_many(dict, keys, found, 1000), 500);
+        for (I32 i = 0; i < 1000; ++i) {
+            ASSERT_EQ(found[i], md_get(dict, &keys[i]));
+        }
+        md_destroy(dict);
+    }
+
+    m_Dict* names = md_create_str(sizeof(I32), 0);
+    CStr strs[] = {"alpha", "beta", "gamma"};
+    I32 ids[] = {1, 2, 3};
+    md_put_many(names, strs, ids, 3); // String dicts take an array of CStr keys
+    Bool has[3];
+    md_remove_many(names, strs + 1, 1);
+    ASSERT_EQ(md_has_many(names, strs, has, 3), 2);
+    ASSERT_FALSE(has[1]);
+    md_destroy(names);                    // Clean up
+}
+
+#pragma endregion
+
+#pragma region Cache Tests
+// Tests for m_Cache and its eviction policies
+
+static Void count_evicted(Void* key, Void* value, Void* context) {
+    (void)key;
+    *(I32*)context += *(I32*)value;
+}
+
+UTEST(Cache, LeastRecentlyUsed) {
+    m_Cache* cache = mcache_create(sizeof(I32), sizeof(I32), 3, M_CACHE_LRU, NULL, NULL);
+    I32 evicted = 0;
+    mcache_setevictor(cache, count_evicted, &evicted);
+    for (I32 i = 1; i <= 3; ++i) {
+        mcache_put(cache, &i, &i);
+    }
+    I32 key = 1;
+    ASSERT_EQ(*(I32*)mcache_get(cache, &key), 1);  // 2 is now the oldest
+    I32 four = 4;
+    mcache_put(cache, &four, &four);
+    key = 2;
+    ASSERT_FALSE(mcache_has(cache, &key));
+    ASSERT_EQ(mcache_get(cache, &key), NULL);
+    ASSERT_EQ(evicted, 2);
+    ASSERT_EQ(cache->hits, 1);
+    ASSERT_EQ(cache->misses, 1);
+    ASSERT_EQ(cache->evictions, 1);
+    key = 1;
+    mcache_remove(cache, &key);            // The last entry moves into the hole
+    ASSERT_EQ(mcache_count(cache), 2);
+    ASSERT_EQ(evicted, 3);
+    I32 five = 5, six = 6;
+    mcache_put(cache, &five, &five);
+    mcache_put(cache, &six, &six);         // Evicts 3, the oldest left
+    key = 3;
+    ASSERT_FALSE(mcache_has(cache, &key));
+    ASSERT_EQ(*(I32*)mcache_get(cache, &four), 4);
+    mcache_destroy(cache);                 // Clean up
+    ASSERT_EQ(evicted, 3 + 3 + 4 + 5 + 6); // Destroy hands back the remaining values
+}
+
+UTEST(Cache, SecondChance) {
+    m_CachePolicy policies[] = {M_CACHE_CLOCK, M_CACHE_SIEVE};
+    for (I32 p = 0; p < 2; ++p) {
+        m_Cache* cache = mcache_create(sizeof(I32), sizeof(I32), 8, policies[p], NULL, NULL);
+        for (I32 i = 0; i < 8; ++i) {
+            mcache_put(cache, &i, &i);
+        }
+        for (I32 round = 0; round < 10; ++round) {
+            for (I32 hot = 0; hot < 4; ++hot) {
+                ASSERT_NE(mcache_get(cache, &hot), NULL);   // A hot working set survives
+            }
+            for (I32 i = 0; i < 4; ++i) {
+                I32 cold = 100 + round * 4 + i;  // while a scan streams through
+                mcache_put(cache, &cold, &cold);
+            }
+        }
+        ASSERT_EQ(mcache_count(cache), 8);
+        ASSERT_EQ(cache->hits, 40);
+        ASSERT_EQ(cache->evictions, 40);
+        mcache_destroy(cache);             // Clean up
+    }
+}
+
+UTEST(Cache, RandomChurn) {
+    m_CachePolicy policies[] = {M_CACHE_LRU, M_CACHE_CLOCK, M_CACHE_SIEVE};
+    for (I32 p = 0; p < 3; ++p) {
+        m_Cache* cache = mcache_create(sizeof(I32), sizeof(I32), 64, policies[p], NULL, NULL);
+        U32 state = 1;
+        for (I32 i = 0; i < 20000; ++i) {
+            state = state * 1103515245u + 12345u;
+            I32 key = (I32)((state >> 16) % 200);
+            if (i % 7 == 0) {
+                mcache_remove(cache, &key);
+            } else if (!mcache_get(cache, &key)) {
+                mcache_put(cache, &key, &key);
+            }
+        }
+        ASSERT_LE(mcache_count(cache), 64);
+        for (I32 e = 0; e < mcache_count(cache); ++e) {
+            I32 key = ((I32*)cache->keys.data)[e];
+            ASSERT_EQ(*(I32*)md_get(&cache->index, &key), e);     // Index and entries agree
+            ASSERT_EQ(((I32*)cache->values.data)[e], key);
+        }
+        ASSERT_EQ(md_count(&cache->index), mcache_count(cache));
+        I32 linked = 0;
+        for (I32 e = cache->head; e >= 0 && policies[p] != M_CACHE_CLOCK; e = ((I32*)cache->links.data)[e * 2 + 1]) {
+            linked++;
+        }
+        ASSERT_EQ(linked, policies[p] == M_CACHE_CLOCK ? 0 : mcache_count(cache));
+        mcache_destroy(cache);             // Clean up
+    }
+}
+
+#pragma endregion
+
+#pragma region Filter Tests
+// Tests for m_Filter in Bloom and cuckoo mode
+
+UTEST(Filter, BloomRate) {
+    m_Filter* filter = mfilter_create(M_FILTER_BLOOM, sizeof(U64), 10000, 0.01, NULL);
+    for (U64 i = 0; i < 10000; ++i) {
+        mfilter_add(filter, &i);
+    }
+    I32 positives = 0;
+    for (U64 i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(mfilter_test(filter, &i));   // No false negatives
+        U64 other = i + 1000000;
+        positives += mfilter_test(filter, &other);
+    }
+    ASSERT_LT(positives, 200);                   // Within twice the requested 1%
+    U64 key = 5;
+    ASSERT_EQ(mfilter_remove(filter, &key), M_ERR_INVALID_OPERATION);
+    mfilter_destroy(filter);                     // Clean up
+}
+
+UTEST(Filter, CuckooRemove) {
+    m_Filter* filter = mfilter_create(M_FILTER_CUCKOO, sizeof(U32), 4000, 0.001, NULL);
+    for (U32 i = 0; i < 4000; ++i) {
+        ASSERT_EQ(mfilter_add(filter, &i), 0);
+    }
+    for (U32 i = 0; i < 4000; i += 2) {
+        mfilter_remove(filter, &i);
+    }
+    ASSERT_EQ(filter->count, 2000);
+    I32 positives = 0;
+    for (U32 i = 0; i < 4000; ++i) {
+        if (i & 1) ASSERT_TRUE(mfilter_test(filter, &i));
+        else positives += mfilter_test(filter, &i);
+    }
+    ASSERT_LT(positives, 10);                    // Removed keys are gone apart from rare collisions
+    mfilter_clear(filter);
+    U32 key = 1;
+    ASSERT_FALSE(mfilter_test(filter, &key));
+    mfilter_destroy(filter);                     // Clean up
+}
+
+UTEST(Filter, SaveLoad) {
+    m_FilterMode modes[] = {M_FILTER_BLOOM, M_FILTER_CUCKOO};
+    for (I32 m = 0; m < 2; ++m) {
+        m_Filter* filter = mfilter_create(modes[m], sizeof(U64), 1000, 0.01, NULL);
+        for (U64 i = 0; i < 1000; ++i) {
+            mfilter_add(filter, &i);
+        }
+        m_Buffer image;
+        mb_init(&image, 1, 0);
+        ASSERT_EQ(mfilter_save(filter, &image), 0);
+        m_Filter loaded;
+        ASSERT_EQ(mfilter_load(&loaded, image.data, (Sz)image.itemcap, NULL), 0);
+        ASSERT_EQ(loaded.count, 1000);
+        for (U64 i = 0; i < 2000; ++i) {
+            ASSERT_EQ(mfilter_test(&loaded, &i), mfilter_test(filter, &i));
+        }
+        image.data[0] ^= 1;                      // A damaged header is rejected
+        m_Filter broken;
+        ASSERT_EQ(mfilter_load(&broken, image.data, (Sz)image.itemcap, NULL), M_ERR_INVALID_OPERATION);
+        image.data[0] ^= 1;
+        I32 victim = loaded.blockcount;          // The victim bucket sits after magic, version, mode, keysize,
+        memcpy(image.data + 24, &victim, 4);     // count and blockcount; one past the end must be rejected
+        ASSERT_EQ(mfilter_load(&broken, image.data, (Sz)image.itemcap, NULL), M_ERR_INVALID_OPERATION);
+        I32 count = -1;
+        victim = -1;
+        memcpy(image.data + 24, &victim, 4);
+        memcpy(image.data + 16, &count, 4);
+        ASSERT_EQ(mfilter_load(&broken, image.data, (Sz)image.itemcap, NULL), M_ERR_INVALID_OPERATION);
+        mb_setcap(&image, 0);                    // Clean up
+        mb_setcap(&loaded.blocks, 0);
+        mfilter_destroy(filter);
+    }
+}
+
+#pragma endregion
+
+#pragma region B-Tree Tests
+// Tests for m_BTree, its cursors and range deletes
+
+UTEST(BTree, PutGetRemove) {
+    m_BTree* tree = mbt_create(sizeof(I32), sizeof(I32), int_comparer);
+    for (I32 i = 0; i < 5000; ++i) {
+        I32 key = (i * 7919) % 5000;     // Every key once, out of order
+        I32 value = key * 2;
+        ASSERT_EQ(mbt_put(tree, &key, &value), 0);
+    }
+    ASSERT_EQ(mbt_count(tree), 5000);
+    for (I32 key = 0; key < 5000; key += 2) {
+        mbt_remove(tree, &key);
+    }
+    ASSERT_EQ(mbt_count(tree), 2500);
+    for (I32 key = 0; key < 5000; ++key) {
+        I32* value = (I32*)mbt_get(tree, &key);
+        if (key & 1) ASSERT_EQ(*value, key * 2);
+        else ASSERT_EQ(value, NULL);
+    }
+    m_BTreeCursor cursor = mbt_lower_bound(tree, NULL);
+    Void* key;
+    I32 expected = 1;
+    while (mbt_next(&cursor, &key, NULL)) {
+        ASSERT_EQ(*(I32*)key, expected);  // Ascending order
+        expected += 2;
+    }
+    ASSERT_EQ(expected, 5001);
+    mbt_destroy(tree);                    // Clean up
+}
+
+UTEST(BTree, BoundsAndRanges) {
+    m_BTree* tree = mbt_create(sizeof(I32), sizeof(I32), int_comparer);
+    for (I32 key = 0; key < 1000; key += 10) {
+        mbt_put(tree, &key, &key);
+    }
+    I32 probe = 25;
+    Void* key;
+    m_BTreeCursor cursor = mbt_lower_bound(tree, &probe);
+    ASSERT_TRUE(mbt_next(&cursor, &key, NULL));
+    ASSERT_EQ(*(I32*)key, 30);
+    probe = 30;
+    cursor = mbt_lower_bound(tree, &probe);
+    ASSERT_TRUE(mbt_next(&cursor, &key, NULL));
+    ASSERT_EQ(*(I32*)key, 30);
+    cursor = mbt_upper_bound(tree, &probe);
+    ASSERT_TRUE(mbt_next(&cursor, &key, NULL));
+    ASSERT_EQ(*(I32*)key, 40);
+    probe = 990;
+    cursor = mbt_upper_bound(tree, &probe);
+    ASSERT_FALSE(mbt_next(&cursor, &key, NULL));
+    I32 lo = 100, hi = 200, seen = 0;
+    cursor = mbt_range(tree, &lo, &hi);
+    while (mbt_next(&cursor, &key, NULL)) {
+        seen++;
+    }
+    ASSERT_EQ(seen, 10);                  // 100 to 190
+    lo = 95;
+    hi = 905;
+    ASSERT_EQ(mbt_remove_range(tree, &lo, &hi), 81);
+    ASSERT_EQ(mbt_count(tree), 19);
+    probe = 90;
+    cursor = mbt_upper_bound(tree, &probe);
+    ASSERT_TRUE(mbt_next(&cursor, &key, NULL));
+    ASSERT_EQ(*(I32*)key, 910);           // The leaf chain skips the removed span
+    ASSERT_EQ(mbt_remove_range(tree, NULL, NULL), 19);
+    ASSERT_EQ(tree->root, NULL);
+    mbt_destroy(tree);                    // Clean up
+}
+
+UTEST(BTree, BulkLoad) {
+    m_List* keys = ml_create(sizeof(I32), 0, NULL);
+    m_List* values = ml_create(sizeof(I32), 0, NULL);
+    for (I32 i = 0; i < 10000; ++i) {
+        I32 key = i * 3, value = -i;
+        ml_push(keys, &key);
+        ml_push(values, &value);
+    }
+    m_BTree* tree = mbt_create(sizeof(I32), sizeof(I32), int_comparer);
+    ASSERT_EQ(mbt_load(tree, keys, values), 0);
+    ASSERT_EQ(mbt_count(tree), 10000);
+    for (I32 i = 0; i < 10000; i += 37) {
+        I32 key = i * 3;
+        ASSERT_EQ(*(I32*)mbt_get(tree, &key), -i);
+        key++;
+        ASSERT_FALSE(mbt_has(tree, &key));
+    }
+    I32 key = 1, value = 5;
+    mbt_put(tree, &key, &value);          // The loaded tree takes inserts
+    ASSERT_EQ(*(I32*)mbt_get(tree, &key), 5);
+    ((I32*)keys->buffer.data)[0] = 7;     // Out of order
+    ASSERT_EQ(mbt_load(tree, keys, values), M_ERR_INVALID_OPERATION);
+    ASSERT_EQ(mbt_count(tree), 10001);    // A rejected load leaves the tree alone
+    mbt_destroy(tree);                    // Clean up
+    ml_destroy(keys);
+    ml_destroy(values);
+}
+
+#pragma endregion
+
+#pragma region Adaptive Radix Tree Tests
+// Tests for m_Art with string and integer keys
+
+static Bool collect_keys(Void* key, I32 keylen, Void* value, Void* context) {
+    (void)value;
+    ms_cat((m_StrBuffer*)context, "%.*s,", keylen, (CStr)key);
+    return true;
+}
+
+UTEST(Art, StringKeys) {
+    m_Art* art = mart_create(sizeof(I32));
+    CStr words[] = {"romane", "romanus", "romulus", "rubens", "ruber", "rubicon", "rubicundus", "rom", "r"};
+    for (I32 i = 0; i < 9; ++i) {
+        ASSERT_EQ(mart_put(art, (Void*)words[i], (I32)strlen(words[i]), &i), 0);
+    }
+    ASSERT_EQ(mart_count(art), 9);
+    ASSERT_EQ(*(I32*)mart_get(art, "rom", 3), 7);   // A key that is a prefix of others
+    ASSERT_FALSE(mart_has(art, "roma", 4));
+    ASSERT_FALSE(mart_has(art, "rubiconx", 8));
+    m_StrBuffer* seen = ms_create(64);
+    ASSERT_EQ(mart_iter_prefix(art, "rub", 3, collect_keys, seen), 4);
+    ASSERT_STREQ(ms_getstr(seen), "rubens,ruber,rubicon,rubicundus,");   // In byte order
+    mart_remove(art, "rom", 3);
+    mart_remove(art, "romanus", 7);
+    ASSERT_EQ(mart_count(art), 7);
+    ASSERT_EQ(*(I32*)mart_get(art, "romane", 6), 0);
+    ASSERT_FALSE(mart_has(art, "rom", 3));
+    ms_destroy(seen);                              // Clean up
+    mart_destroy(art);
+}
+
+UTEST(Art, LongestPrefix) {
+    m_Art* art = mart_create(sizeof(I32));
+    CStr routes[] = {"/", "/api/", "/api/v1/", "/api/v1/users/", "/static/"};
+    for (I32 i = 0; i < 5; ++i) {
+        mart_put(art, (Void*)routes[i], (I32)strlen(routes[i]), &i);
+    }
+    I32 matched;
+    CStr path = "/api/v1/users/42";
+    ASSERT_EQ(*(I32*)mart_longest_prefix(art, (Void*)path, (I32)strlen(path), &matched), 3);
+    ASSERT_EQ(matched, 14);
+    path = "/api/v2/items";
+    ASSERT_EQ(*(I32*)mart_longest_prefix(art, (Void*)path, (I32)strlen(path), &matched), 1);
+    path = "/favicon.ico";
+    ASSERT_EQ(*(I32*)mart_longest_prefix(art, (Void*)path, (I32)strlen(path), &matched), 0);
+    ASSERT_EQ(mart_longest_prefix(art, "api", 3, &matched), NULL);
+    ASSERT_EQ(matched, 0);
+    mart_destroy(art);                             // Clean up
+}
+
+static Bool check_ascending(Void* key, I32 keylen, Void* value, Void* context) {
+    U64* last = (U64*)context;
+    U8 expected[8];
+    mart_key_u64(*(U64*)value, expected);
+    if (keylen != 8 || memcmp(key, expected, 8) != 0 || *(U64*)value < *last) {
+        return false;
+    }
+    *last = *(U64*)value + 1;
+    return true;
+}
+
+UTEST(Art, IntegerKeysInOrder) {
+    m_Art* art = mart_create(sizeof(U64));
+    U8 key[8];
+    for (U64 i = 0; i < 3000; ++i) {
+        U64 value = (i * 2654435761u) % 100000;    // Scattered, so inner nodes grow to 48 and 256 children
+        mart_key_u64(value, key);
+        mart_put(art, key, 8, &value);
+    }
+    U64 next = 0;
+    ASSERT_EQ(mart_iter_prefix(art, NULL, 0, check_ascending, &next), mart_count(art));  // Big-endian keys walk in numeric order
+    mart_clear(art);
+    ASSERT_EQ(mart_count(art), 0);
+    ASSERT_EQ(art->root, NULL);
+    mart_destroy(art);                             // Clean up
+}
+
+#pragma endregion
+
+#pragma region Small Dictionary Tests
+// Tests for m_SmallDict, which keeps a few entries inline and spills to a swiss dict
+
+UTEST(SmallDict, InlineU32Keys) {
+    m_SmallDict dict;
+    ASSERT_EQ(msd_init(&dict, sizeof(U32), sizeof(I32), NULL, NULL), 0);
+    ASSERT_EQ(dict.cap, 16);
+    for (I32 i = 0; i < 16; ++i) {
+        U32 key = 100 + i * 3;
+        msd_put(&dict, &key, &i);
+    }
+    ASSERT_EQ(dict.spill, NULL);          // Sixteen entries still fit inline
+    for (I32 i = 0; i < 16; ++i) {
+        U32 key = 100 + i * 3;
+        ASSERT_EQ(*(I32*)msd_get(&dict, &key), i);
+        key++;
+        ASSERT_FALSE(msd_has(&dict, &key));
+    }
+    U32 key = 100;
+    msd_remove(&dict, &key);
+    ASSERT_EQ(msd_count(&dict), 15);
+    ASSERT_FALSE(msd_has(&dict, &key));
+    key = 145;
+    ASSERT_EQ(*(I32*)msd_get(&dict, &key), 15); // The last entry moved into the hole
+    msd_clear(&dict);                     // Clean up
+}
+
+UTEST(SmallDict, SpillsToSwiss) {
+    m_SmallDict* dict = msd_create(sizeof(U64), sizeof(U64), NULL, NULL);
+    for (U64 i = 0; i < 100; ++i) {
+        U64 key = i << 32;                // Keys that differ only in the high half
+        U64 value = i;
+        msd_put(dict, &key, &value);
+        if (i < 16) ASSERT_EQ(dict->spill, NULL);
+    }
+    ASSERT_NE(dict->spill, NULL);
+    ASSERT_EQ(msd_count(dict), 100);
+    for (U64 i = 0; i < 100; ++i) {
+        U64 key = i << 32;
+        ASSERT_EQ(*(U64*)msd_get(dict, &key), i);
+    }
+    I32 pos = 0, seen = 0;
+    while (msd_iter(dict, &pos, NULL, NULL)) {
+        seen++;
+    }
+    ASSERT_EQ(seen, 100);
+    msd_destroy(dict);                    // Clean up
+}
+
+UTEST(SmallDict, ComparerKeys) {
+    m_SmallDict dict;
+    msd_init(&dict, sizeof(CStr), sizeof(I32), m_hash_str, m_compare_str);
+    char buffer[8] = "b";
+    CStr keys[] = {"a", "b", "c"};
+    for (I32 i = 0; i < 3; ++i) {
+        msd_put(&dict, &keys[i], &i);
+    }
+    CStr query = buffer;                  // Same text at a different address
+    ASSERT_EQ(*(I32*)msd_get(&dict, &query), 1);
+    msd_clear(&dict);                     // Clean up
+}
+
+#pragma endregion
+
+#pragma region Set Tests
+// Tests for m_Set, a swiss table that stores keys only
+
+UTEST(Set, AddHasRemove) {
+    m_Set* set = mset_create(sizeof(I32), 4, NULL, NULL);
+    for (I32 i = 0; i < 1000; ++i) {
+        ASSERT_EQ(mset_add(set, &i), 0);
+    }
+    I32 again = 7;
+    mset_add(set, &again);                // Adding twice keeps one copy
+    ASSERT_EQ(mset_count(set), 1000);
+    ASSERT_EQ(set->dict.values.buffer.data, NULL); // No value storage behind the keys
+    for (I32 i = 0; i < 1000; i += 2) {
+        mset_remove(set, &i);
+    }
+    for (I32 i = 0; i < 1000; ++i) {
+        ASSERT_EQ(mset_has(set, &i), (i & 1) != 0);
+    }
+    I32 pos = 0, seen = 0;
+    Void* key;
+    while (mset_iter(set, &pos, &key)) {
+        ASSERT_TRUE(*(I32*)key & 1);
+        seen++;
+    }
+    ASSERT_EQ(seen, 500);
+    mset_destroy(set);                    // Clean up
+}
+
+UTEST(Set, Algebra) {
+    m_Set* a = mset_create(sizeof(U64), 0, NULL, NULL);
+    m_Set* b = mset_create(sizeof(U64), 0, NULL, NULL);
+    m_Set* c = mset_create(sizeof(U64), 0, NULL, NULL);
+    for (U64 i = 0; i < 300; ++i) {
+        if (i < 200) mset_add(a, &i);     // a = [0, 200)
+        if (i >= 100) mset_add(b, &i);    // b = [100, 300)
+    }
+    mset_union(c, a);
+    mset_intersect(c, b);                 // c = [100, 200)
+    ASSERT_EQ(mset_count(c), 100);
+    mset_difference(a, b);                // a = [0, 100)
+    ASSERT_EQ(mset_count(a), 100);
+    mset_union(a, c);                     // a = [0, 200)
+    ASSERT_EQ(mset_count(a), 200);
+    for (U64 i = 0; i < 300; ++i) {
+        ASSERT_EQ(mset_has(a, &i), i < 200);
+        ASSERT_EQ(mset_has(c, &i), i >= 100 && i < 200);
+    }
+    mset_difference(b, c);                // Probes from the smaller side, b = [200, 300)
+    ASSERT_EQ(mset_count(b), 100);
+    U64 key = 150;
+    ASSERT_FALSE(mset_has(b, &key));
+    mset_destroy(a);                      // Clean up
+    mset_destroy(b);
+    mset_destroy(c);
+}
+
+#pragma endregion
+
+#pragma region Frozen Dictionary Tests
+// Tests for md_freeze and the minimal perfect hash tables it builds
+
+UTEST(FrozenDict, FreezeFindsEveryKey) {
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    for (I32 i = 0; i < 10000; ++i) {
+        I32 key = i * 3;
+        I32 value = -i;
+        md_put(dict, &key, &value);
+    }
+    m_FrozenDict* frozen = md_freeze(dict);
+    md_destroy(dict);                     // The frozen copy owns its keys and values
+    ASSERT_NE(frozen, NULL);
+    ASSERT_EQ(mf_count(frozen), 10000);
+    for (I32 i = 0; i < 10000; ++i) {
+        I32 key = i * 3;
+        I32* value = (I32*)mf_get(frozen, &key);
+        ASSERT_NE(value, NULL);
+        ASSERT_EQ(*value, -i);
+        key++;
+        ASSERT_FALSE(mf_has(frozen, &key)); // Keys that were never put miss after the one compare
+    }
+    mf_destroy(frozen);                   // Clean up
+}
+
+UTEST(FrozenDict, LoadFromCopiedBlob) {
+    m_Dict* dict = md_create(sizeof(I32), sizeof(F32), 0, NULL);
+    for (I32 i = 0; i < 5; ++i) {
+        F32 value = i * 0.5f;
+        md_put(dict, &i, &value);
+    }
+    m_FrozenDict* frozen = md_freeze(dict);
+    ASSERT_NE(frozen, NULL);
+    Void* copy = malloc(frozen->size);    // Stands in for a file written out and mapped back in
+    memcpy(copy, frozen->data, frozen->size);
+    m_FrozenDict* loaded = mf_load(copy, frozen->size, NULL, NULL);
+    ASSERT_NE(loaded, NULL);
+    for (I32 i = 0; i < 5; ++i) {
+        ASSERT_EQ(*(F32*)mf_get(loaded, &i), i * 0.5f);
+    }
+    ASSERT_EQ(mf_load(copy, frozen->size - 8, NULL, NULL), NULL); // Truncated blobs are rejected
+    for (I32 b = 0; b < loaded->bucketcount; ++b) {
+        loaded->disps[b] = 0x80000000u | 1000u; // Direct slots past the end, as a corrupt blob could hold
+    }
+    for (I32 i = 0; i < 5; ++i) {
+        ASSERT_EQ(mf_get(loaded, &i), NULL);
+    }
+    mf_destroy(loaded);
+    free(copy);                           // mf_load does not take ownership
+    mf_destroy(frozen);
+    md_destroy(dict);
+
+    m_Dict* empty = md_create_str(sizeof(I32), 0);
+    ASSERT_EQ(md_freeze(empty), NULL);    // String keys are not supported
+    md_destroy(empty);
+
+    m_Dict* ordered = md_create(sizeof(I32), sizeof(I32), 0, int_comparer);
+    ASSERT_EQ(md_freeze(ordered), NULL);  // No hasher known to agree with int_comparer
+    md_destroy(ordered);
+}
+
+UTEST(FrozenDict, StrPointerKeys) {
+    m_Dict* dict = md_create_sorted(sizeof(CStr), sizeof(I32), 0, m_compare_str);
+    CStr names[] = {"alpha", "beta", "gamma"};
+    for (I32 i = 0; i < 3; ++i) {
+        md_put(dict, &names[i], &i);
+    }
+    m_FrozenDict* frozen = md_freeze(dict);
+    ASSERT_NE(frozen, NULL);
+    char buffer[8];
+    strcpy(buffer, "beta");
+    CStr other = buffer;                  // Same text through another pointer
+    ASSERT_EQ(*(I32*)md_get(dict, &other), 1);
+    ASSERT_EQ(*(I32*)mf_get(frozen, &other), 1);
+    ASSERT_EQ(md_save(dict, "unused.bin"), M_ERR_INVALID_OPERATION); // Pointers cannot be saved
+    mf_destroy(frozen);
+    md_destroy(dict);                     // Clean up
+}
+
+#pragma endregion
+
+#pragma region Mapped File Tests
+// Tests for ml_save/ml_map and md_save/md_map round trips through a file
+
+static Str mapped_path(Str buffer, CStr name) {
+    sprintf(buffer, "%s_%d.bin", name, (int)getpid()); // Unique per process, unit and e2e runs may overlap
+    return buffer;
+}
+
+UTEST(MappedFile, ListRoundTrip) {
+    char path[64];
+    mapped_path(path, "mapped_list");
+    m_List* list = ml_create(sizeof(I32), 0, int_comparer);
+    for (I32 i = 0; i < 1000; ++i) {
+        I32 value = i * 7;
+        ml_push(list, &value);
+    }
+    ASSERT_EQ(ml_save(list, path), 0);
+    ml_destroy(list);
+
+    m_List* mapped = ml_map(path, int_comparer, true);
+    ASSERT_NE(mapped, NULL);
+    ASSERT_EQ(ml_count(mapped), 1000);
+    ASSERT_EQ(*(I32*)ml_get(mapped, 999), 999 * 7);
+    I32 needle = 700;
+    ASSERT_EQ(ml_find(mapped, &needle), 100);
+    I32 extra = 1;
+    ASSERT_NE(ml_push(mapped, &extra), 0); // The mapping is read only and cannot grow
+    ml_destroy(mapped);                   // Unmaps the file
+    remove(path);
+}
+
+UTEST(MappedFile, DictRoundTrip) {
+    char path[64];
+    mapped_path(path, "mapped_dict");
+    m_Dict* dict = md_create_swiss(sizeof(I64), sizeof(I32), 0, NULL, NULL);
+    for (I64 i = 0; i < 20000; ++i) {
+        I64 key = i * 1000003;
+        I32 value = (I32)i;
+        md_put(dict, &key, &value);
+    }
+    ASSERT_EQ(md_save(dict, path), 0);
+    md_destroy(dict);
+
+    m_FrozenDict* mapped = md_map(path, NULL, NULL, true);
+    ASSERT_NE(mapped, NULL);
+    ASSERT_EQ(mf_count(mapped), 20000);
+    for (I64 i = 0; i < 20000; ++i) {
+        I64 key = i * 1000003;
+        I32* value = (I32*)mf_get(mapped, &key);
+        ASSERT_NE(value, NULL);
+        ASSERT_EQ(*value, (I32)i);
+        key++;
+        ASSERT_FALSE(mf_has(mapped, &key));
+    }
+    mf_destroy(mapped);                   // Clean up
+    ASSERT_EQ(ml_map(path, NULL, false), NULL); // A dict file is not a list
+    remove(path);
+}
+
+UTEST(MappedFile, RejectsCorruptFiles) {
+    char path[64];
+    mapped_path(path, "mapped_corrupt");
+    m_Dict* dict = md_create_hashed(sizeof(I32), sizeof(I32), 0, NULL, NULL);
+    for (I32 i = 0; i < 100; ++i) {
+        md_put(dict, &i, &i);
+    }
+    ASSERT_EQ(md_save(dict, path), 0);
+    md_destroy(dict);
+
+    FILE* file = fopen(path, "r+b");
+    ASSERT_NE(file, NULL);
+    fseek(file, 200, SEEK_SET);           // Inside the payload
+    int byte = fgetc(file);
+    fseek(file, 200, SEEK_SET);
+    fputc(byte ^ 0xff, file);
+    fclose(file);
+    ASSERT_EQ(md_map(path, NULL, NULL, true), NULL); // The payload checksum catches the flipped byte
+
+    file = fopen(path, "r+b");
+    fputc('X', file);                     // Break the magic
+    fclose(file);
+    ASSERT_EQ(md_map(path, NULL, NULL, false), NULL);
+    ASSERT_EQ(md_map("no_such_file.bin", NULL, NULL, false), NULL);
+    remove(path);                         // Clean up
+}
+
+#pragma endregion
+
+#pragma region Concurrent Dictionary Tests
+// Tests for m_ConcurrentDict, a set of independently locked dict shards
+
+typedef struct ConcurrentWork {
+    m_ConcurrentDict* dict;
+    I32 first;
+    I32 count;
+} ConcurrentWork;
+
+static Void* concurrent_worker(Void* arg) {
+    ConcurrentWork* work = (ConcurrentWork*)arg;
+    for (I32 i = work->first; i < work->first + work->count; ++i) {
+        I32 value = i * 2;
+        mcd_put(work->dict, &i, &value);
+        I32 found = 0;
+        if (!mcd_get(work->dict, &i, &found) || found != value) {
+            return (Void*)1;              // Report a lost write
+        }
+    }
+    return NULL;
+}
+
+UTEST(ConcurrentDict, SingleThreadBasics) {
+    m_ConcurrentDict* dict = mcd_create(sizeof(I32), sizeof(I32), 0, 8, false, NULL, NULL);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    ASSERT_EQ(dict->shardcount, 8);
+    I32 key = 3, value = 30, out = 0;
+    ASSERT_EQ(mcd_put(dict, &key, &value), 0);
+    ASSERT_TRUE(mcd_get(dict, &key, &out)); // Values are copied out under the shard lock
+    ASSERT_EQ(out, 30);
+    mcd_remove(dict, &key);
+    ASSERT_FALSE(mcd_has(dict, &key));
+    ASSERT_EQ(mcd_count(dict), 0);
+    mcd_destroy(dict);                    // Clean up
+}
+
+UTEST(ConcurrentDict, ParallelWriters) {
+    for (I32 rw = 0; rw < 2; ++rw) {      // Mutex shards, then reader/writer lock shards
+        m_ConcurrentDict* dict = mcd_create(sizeof(I32), sizeof(I32), 0, 16, rw == 1, NULL, NULL);
+        pthread_t threads[4];
+        ConcurrentWork work[4];
+        for (I32 t = 0; t < 4; ++t) {
+            work[t] = (ConcurrentWork){dict, t * 20000, 20000};
+            pthread_create(&threads[t], NULL, concurrent_worker, &work[t]);
+        }
+        for (I32 t = 0; t < 4; ++t) {
+            Void* result = NULL;
+            pthread_join(threads[t], &result);
+            ASSERT_EQ(result, NULL);      // Every thread read back its own writes
+        }
+        ASSERT_EQ(mcd_count(dict), 80000);
+        mcd_destroy(dict);                // Clean up
+    }
+}
+#pragma endregion
+
+#pragma region Read-Mostly Dictionary Tests
+// Tests for m_ReadDict, whose readers never lock while writers publish copies
+
+typedef struct ReadWork {
+    m_ReadDict* dict;
+    I32* stop;
+    I64 reads;
+} ReadWork;
+
+static Void* read_worker(Void* arg) {
+    ReadWork* work = (ReadWork*)arg;
+    I32 reader = mrd_register(work->dict);
+    if (reader < 0) {
+        return (Void*)1;
+    }
+    Void* result = NULL;
+    while (!__atomic_load_n(work->stop, __ATOMIC_RELAXED)) {
+        for (I32 key = 0; key < 64; ++key) {
+            I32 value = -1;
+            if (mrd_get(work->dict, reader, &key, &value) && value % 1000 != key) {
+                result = (Void*)1;        // A torn or freed table would show up here
+            }
+            work->reads++;
+        }
+    }
+    mrd_unregister(work->dict, reader);
+    return result;
+}
+
+UTEST(ReadDict, Basics) {
+    m_ReadDict* dict = mrd_create(sizeof(I32), sizeof(I32), 0, 4, NULL, NULL);
+    ASSERT_NE(dict, NULL);                // Ensure dictionary is created
+    I32 reader = mrd_register(dict);
+    ASSERT_GE(reader, 0);
+    I32 key = 5, value = 50, out = 0;
+    ASSERT_EQ(mrd_put(dict, &key, &value), 0);
+    ASSERT_TRUE(mrd_get(dict, reader, &key, &out));
+    ASSERT_EQ(out, 50);
+    ASSERT_EQ(mrd_count(dict), 1);
+    ASSERT_EQ(mrd_remove(dict, &key), 0);
+    ASSERT_FALSE(mrd_has(dict, reader, &key));
+    mrd_unregister(dict, reader);
+    mrd_destroy(dict);                    // Clean up
+}
+
+UTEST(ReadDict, ReadersDuringWrites) {
+    m_ReadDict* dict = mrd_create(sizeof(I32), sizeof(I32), 64, 8, NULL, NULL);
+    I32 stop = 0;
+    pthread_t threads[3];
+    ReadWork work[3];
+    for (I32 t = 0; t < 3; ++t) {
+        work[t] = (ReadWork){dict, &stop, 0};
+        pthread_create(&threads[t], NULL, read_worker, &work[t]);
+    }
+    for (I32 version = 0; version < 300; ++version) {
+        for (I32 key = version % 8; key < 64; key += 8) {
+            I32 value = version * 1000 + key; // Readers check the low digits against the key
+            ASSERT_EQ(mrd_put(dict, &key, &value), 0);
+        }
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    for (I32 t = 0; t < 3; ++t) {
+        Void* result = NULL;
+        pthread_join(threads[t], &result);
+        ASSERT_EQ(result, NULL);          // Readers only ever saw whole tables
+    }
+    I32 key = 0, value = 0;
+    mrd_put(dict, &key, &value);          // With no reader active, every retired table is reclaimed
+    ASSERT_EQ(ml_count(&dict->retired), 0);
+    ASSERT_EQ(mrd_count(dict), 64);
+    mrd_destroy(dict);                    // Clean up
+}
+#pragma endregion
+
+#pragma region Process-Shared Dictionary Tests
+// Tests for m_SharedDict, one table in POSIX shared memory used by several processes
+
+static Str shared_name(Str buffer, CStr name) {
+    sprintf(buffer, "/%s_%d", name, (int)getpid());
+    return buffer;
+}
+
+UTEST(SharedDict, Basics) {
+    char name[64];
+    shared_name(name, "mg_shared_basics");
+    m_SharedDict* dict = mshd_create(name, sizeof(I32), sizeof(I64), 100, NULL, NULL);
+    ASSERT_NE(dict, NULL);
+    ASSERT_EQ(mshd_create(name, sizeof(I32), sizeof(I64), 100, NULL, NULL), NULL); // Names are exclusive
+    m_SharedDict* other = mshd_open(name, NULL, NULL);
+    ASSERT_NE(other, NULL);               // A second mapping, at another address
+    ASSERT_NE(other->segment, dict->segment);
+
+    I32 key = 7;
+    I64 value = 70, out = 0;
+    ASSERT_EQ(mshd_put(dict, &key, &value), 0);
+    ASSERT_TRUE(mshd_get(other, &key, &out));
+    ASSERT_EQ(out, 70);
+    ASSERT_EQ(mshd_count(other), 1);
+    ASSERT_EQ(mshd_remove(other, &key), 0);
+    ASSERT_FALSE(mshd_has(dict, &key));
+    ASSERT_EQ(mshd_remove(dict, &key), 0);  // Missing keys are still success
+    ASSERT_EQ(mshd_put(dict, &key, NULL), 0);
+    ASSERT_TRUE(mshd_get(other, &key, &out));
+    ASSERT_EQ(out, 0);                    // A new key without a value reads as zeroes
+    ASSERT_EQ(mshd_remove(dict, &key), 0);
+
+    I32 puts = 0;
+    for (I32 i = 0; i < 1000 && mshd_put(dict, &i, &value) == 0; ++i) {
+        puts++;
+    }
+    ASSERT_GE(puts, 100);
+    ASSERT_LT(puts, 1000);                // The segment has a fixed size
+    mshd_destroy(other);
+    mshd_destroy(dict);                   // Clean up
+    ASSERT_EQ(mshd_unlink(name), 0);
+    ASSERT_EQ(mshd_open(name, NULL, NULL), NULL);
+}
+
+UTEST(SharedDict, RemovalKeepsProbeRuns) {
+    char name[64];
+    shared_name(name, "mg_shared_runs");
+    m_SharedDict* dict = mshd_create(name, sizeof(I32), sizeof(I32), 200, NULL, NULL);
+    ASSERT_NE(dict, NULL);
+    Bool present[256] = {0};
+    U32 state = 12345;
+    for (I32 step = 0; step < 50000; ++step) {
+        state = state * 1103515245u + 12345u;
+        I32 key = (I32)((state >> 8) % 256);
+        if ((state >> 20) & 1) {
+            if (present[key] || mshd_count(dict) < 200) {
+                ASSERT_EQ(mshd_put(dict, &key, &key), 0);
+                present[key] = true;
+            }
+        } else {
+            I32 before = mshd_count(dict);
+            ASSERT_EQ(mshd_remove(dict, &key), 0);
+            ASSERT_EQ(before - mshd_count(dict), (I32)present[key]);
+            present[key] = false;
+        }
+    }
+    I32 count = 0;
+    for (I32 key = 0; key < 256; ++key) {
+        I32 out = -1;
+        ASSERT_EQ(mshd_get(dict, &key, &out), present[key]); // Backward shifts never strand a key
+        if (present[key]) {
+            ASSERT_EQ(out, key);
+            count++;
+        }
+    }
+    ASSERT_EQ(mshd_count(dict), count);
+    mshd_destroy(dict);                   // Clean up
+    mshd_unlink(name);
+}
+
+UTEST(SharedDict, ProcessesShareOneTable) {
+    char name[64];
+    shared_name(name, "mg_shared_procs");
+    m_SharedDict* dict = mshd_create(name, sizeof(I32), sizeof(I32), 4000, NULL, NULL);
+    ASSERT_NE(dict, NULL);
+    pid_t children[3];
+    for (I32 c = 0; c < 3; ++c) {
+        children[c] = fork();
+        ASSERT_GE(children[c], 0);
+        if (children[c] == 0) {
+            m_SharedDict* mine = mshd_open(name, NULL, NULL);
+            I32 failures = mine ? 0 : 1;
+            for (I32 key = c * 1000; mine && key < (c + 1) * 1000; ++key) {
+                I32 value = key * 2;
+                failures += mshd_put(mine, &key, &value) != 0;
+                I32 other = ((c + 1) % 3) * 1000 + key % 1000, out = 0;
+                if (mshd_get(mine, &other, &out) && out != other * 2) {
+                    failures++;           // Another process's entry, read while it writes
+                }
+            }
+            for (I32 key = c * 1000; mine && key < (c + 1) * 1000; key += 2) {
+                failures += mshd_remove(mine, &key) != 0;
+            }
+            mshd_destroy(mine);
+            _exit(failures ? 1 : 0);
+        }
+    }
+    for (I32 c = 0; c < 3; ++c) {
+        int status = 0;
+        waitpid(children[c], &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+    ASSERT_EQ(mshd_count(dict), 1500);
+    for (I32 key = 0; key < 3000; ++key) {
+        I32 out = 0;
+        ASSERT_EQ(mshd_get(dict, &key, &out), key % 2 == 1);
+        if (key % 2 == 1) {
+            ASSERT_EQ(out, key * 2);
+        }
+    }
+    mshd_destroy(dict);                   // Clean up
+    mshd_unlink(name);
+}
+#pragma endregion
+
+#pragma region Hash Tests
+// Tests for the built-in key hashers
+
+UTEST(Hash, FixedWidthMatchesBytes) {
+    U8 bytes[16];
+    for (I32 i = 0; i < 16; ++i) {
+        bytes[i] = (U8)(i * 37 + 11);
+    }
+    ASSERT_EQ(m_hash_u32(bytes, 4, 7), m_hash_bytes(bytes, 4, 7));     // Specialised paths agree
+    ASSERT_EQ(m_hash_u64(bytes, 8, 7), m_hash_bytes(bytes, 8, 7));
+    ASSERT_EQ(m_hash_u128(bytes, 16, 7), m_hash_bytes(bytes, 16, 7));
+    ASSERT_NE(m_hash_u64(bytes, 8, 1), m_hash_u64(bytes, 8, 2));      // Seed changes the hash
+}
+
+UTEST(Hash, StrKeys) {
+    Str a = "content-type";
+    char buf[] = "content-type";
+    Str b = buf;
+    ASSERT_EQ(m_hash_str(&a, sizeof(Str), 0), m_hash_str(&b, sizeof(Str), 0)); // Hashes contents, not pointers
+
+    m_Dict* dict = md_create_hashed(sizeof(Str), sizeof(I32), 0, m_hash_str, m_compare_str);
+    I32 value = 5;
+    md_put(dict, &a, &value);
+    ASSERT_NE(md_get(dict, &b), NULL);    // Found through a different pointer
+    ASSERT_EQ(md_setseed(dict, 99), 0);   // Reseeding keeps entries reachable
+    ASSERT_EQ(*(I32*)md_get(dict, &b), 5);
+    md_destroy(dict);                     // Clean up
+}
+#pragma endregion
+
 #pragma region String Buffer Tests
 // Tests for m_StrBuffer, a specialized string handling structure
 